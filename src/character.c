@@ -197,7 +197,7 @@ void draw_fiend_char(BITMAP *dest,CHARACTER_INFO *temp,int x, int y,int action,i
 {
 	int num = temp->animation[action].frame[frame];
 	
-	pivot_sprite(dest, temp->pic[num].data,x,y,temp->pic[num].center_x,temp->pic[num].center_y,degree_to_fixed(angle));
+	pivot_cached_sprite(dest, temp->pic[num].data,x,y,temp->pic[num].center_x,temp->pic[num].center_y,angle);
 	//pivot_fiend_sprite(dest, temp->pic[num].data,x,y,temp->pic[num].center_x,temp->pic[num].center_y,angle,FIEND_DRAW_MODE_TRANS);
 	//rotate_fiend_sprite(dest, temp->pic[num].data,x,y,angle,FIEND_DRAW_MODE_TRANS);
 }
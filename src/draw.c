@@ -1,52 +1,33 @@
 ////////////////////////////////////////////////////
-// This file conatins gfx functions like draw_lightsprite
-// and draw additive sprite
+// This file conatins gfx functions like draw_lightsprite,
+// draw additive sprite and draw blend rle sprite
 //
 // code by Thomas Grip and Miro Karjalainen 
 ///////////////////////////////////////////////////
 
 
 
+#include <string.h>
+
 #include <allegro.h>
 
 #include "fiend.h"
 #include "console.h"
+#include "draw.h"
+#include "draw_simd.h"
+#include "thread.h"
 
-unsigned short light_table[32][65536];
-COLOR_MAP greyscale_map;
-
-#define RED_MASK16 63488
-#define GREEN_MASK16 2016
-#define BLUE_MASK16 31
-
-#define RED_MASK15 31744
-#define GREEN_MASK15 992
-#define BLUE_MASK15 31
+int light_mask_threads=0;
 
+COLOR_MAP greyscale_map;
 
 //Initialize draw_lightsprite
 void init_draw(void)
 {
 	int c;
-	int r,g,b;
 	int i,j;
-	fixed mul;
  
-	if(color_depth==16)
-	{
-	 for(i=0;i<32;i++)
-	 {
-		mul = itofix(i)/31;
-		for(j=0;j<65536;j++)
-		{
-			r = fixtoi(getr(j)*mul);
-			g = fixtoi(getg(j)*mul);
-			b = fixtoi(getb(j)*mul);
-		
-			light_table[i][j]=makecol(r,g,b);
-		}
-	}
-}
+	init_draw_simd();
 	
 
   for(i=0;i<256;i++)
@@ -67,217 +48,300 @@ void init_draw(void)
 
 
 
+//Find the part of src that is inside the clip rect of dest and between
+//the rows top and bottom (bottom not included). x and y becomes where to
+//start drawing in dest and src_x, src_y where to start reading in src.
+//returns 0 if nothing is visible.
+static int clip_sprite(BITMAP *dest, BITMAP *src, int top, int bottom, int *x, int *y, int *src_x, int *src_y, int *w, int *h)
+{
+ int x2 = *x+src->w;
+ int y2 = *y+src->h;
+
+ if(top<dest->ct) top = dest->ct;
+ if(bottom>dest->cb) bottom = dest->cb;
+
+ *src_x=0;
+ *src_y=0;
+
+ if(*x<dest->cl)
+  {
+   *src_x = dest->cl-*x;
+   *x = dest->cl;
+  }
+ if(*y<top)
+  {
+   *src_y = top-*y;
+   *y = top;
+  }
+
+ if(x2>dest->cr) x2 = dest->cr;
+ if(y2>bottom) y2 = bottom;
+
+ *w = x2-*x;
+ *h = y2-*y;
+
+ return (*w>0 && *h>0);
+}
+
+
+
+//shade the rows top to bottom of dest with a light mask
+static void lightsprite_rows(BITMAP *dest, BITMAP *src, int x, int y, int top, int bottom)
+{
+ int i;
+ int src_x, src_y, w, h;
+ void (*light_row)(unsigned short *dest, unsigned char *light, int len);
+
+ if(!clip_sprite(dest, src, top, bottom, &x, &y, &src_x, &src_y, &w, &h)) return;
+
+ if(bitmap_color_depth(dest)==32)
+ {
+  for(i=0;i<h;i++)
+   light_row32((unsigned int*)dest->line[y+i]+x, (unsigned char*)src->line[src_y+i]+src_x, w);
+  return;
+ }
+
+ if(bitmap_color_depth(dest)==15)
+  light_row = light_row15;
+ else
+  light_row = light_row16;
+
+ for(i=0;i<h;i++)
+  light_row((unsigned short*)dest->line[y+i]+x, (unsigned char*)src->line[src_y+i]+src_x, w);
+}
+
+
+//add a light map to the rows top to bottom of a light mask
+static void lightmap2_rows(BITMAP *dest, BITMAP *src, int x, int y, int top, int bottom)
+{
+ int i;
+ int src_x, src_y, w, h;
+
+ if(!clip_sprite(dest, src, top, bottom, &x, &y, &src_x, &src_y, &w, &h)) return;
+
+ for(i=0;i<h;i++)
+  lightmap_row((unsigned char*)dest->line[y+i]+x, (unsigned char*)src->line[src_y+i]+src_x, w);
+}
+
+
+
 //draw a light sprite
 void draw_lightsprite(BITMAP *dest, BITMAP *src,int x, int y)
 {
- int i, j;
- short x_start=0;
- short x_length=src->w;
- short y_start=0;
- short y_length=src->h;
- register short *dest_buffer;
- register char *src_buffer;
- short dest_add=dest->w-x_length;
- short src_add= 0;
+ lightsprite_rows(dest, src, x, y, dest->ct, dest->cb);
+}
 
 
+//draw a light sprite
+void draw_additive_sprite(BITMAP *dest, BITMAP *src,int x, int y)
+{
+ int i;
+ int src_x, src_y, w, h;
+ void (*additive_row)(unsigned short *dest, unsigned short *src, int len);
+
+ if(!clip_sprite(dest, src, dest->ct, dest->cb, &x, &y, &src_x, &src_y, &w, &h)) return;
 
-//Do some stuff so the we only draw the part of the bitmap that is visable
+ if(bitmap_color_depth(dest)==32)
+ {
+  for(i=0;i<h;i++)
+   additive_row32((unsigned int*)dest->line[y+i]+x, (unsigned int*)src->line[src_y+i]+src_x, w);
+  return;
+ }
 
- src_buffer = (char*)src->line[0];
+ if(bitmap_color_depth(dest)==16)
+  additive_row = additive_row16;
+ else if(bitmap_color_depth(dest)==15)
+  additive_row = additive_row15;
+ else
+  return;
+
+ for(i=0;i<h;i++)
+  additive_row((unsigned short*)dest->line[y+i]+x, (unsigned short*)src->line[src_y+i]+src_x, w);
+}
 
-  if(x<dest->cl || y<dest->ct || x+src->w>dest->cr || y+src->h>dest->cb)
+
+//blend the runs of a 16 or 15 bit rle sprite, lines end with eol
+static void blend_rle_rows16(BITMAP *dest, RLE_SPRITE *src, int x, int y, int n, unsigned short eol,
+							 void (*blend_row)(unsigned short *dest, unsigned short *src, int len, int n))
+{
+ signed short *s = (signed short*)src->dat;
+ int top = MAX(dest->ct-y, 0);
+ int bottom = MIN(dest->cb-y, src->h);
+ int left = dest->cl-x;
+ int right = dest->cr-x;
+ int i, c, pos, from, to;
+
+ for(i=0;i<bottom;i++)
+ {
+  pos=0;
+
+  while((unsigned short)(c = *s++)!=eol)
+  {
+   //a skip
+   if(c<0)
    {
-    if(x<dest->cl)
-     {
-      x_length-=-(x-dest->cl);
-      src_buffer+=-(x-dest->cl);
-      x_start=-(x-dest->cl);
-     }
-    if(x>dest->cr-src->w)
-     {
-      x_length-= (x-(dest->cr-src->w));
-     }
-
-    if(y<dest->ct)
-     {
-      src_buffer+=src->w*(-(y-dest->ct));
-      y_length=src->h+(y-dest->ct);
-     }
-    if(y>dest->cb-src->h)
-     {
-      y_length=src->h-(y-(dest->cb-src->h));
-     }
-
-    src_add = src->w-x_length;
-    dest_add = dest->w-x_length;
+    pos-=c;
+    continue;
    }
 
- if(x_length<=0 || y_length<=0) return;
+   if(i>=top)
+   {
+    from = MAX(pos, left);
+    to = MIN(pos+c, right);
+    if(from<to)
+     blend_row((unsigned short*)dest->line[y+i]+x+from, (unsigned short*)s+from-pos, to-from, n);
+   }
 
- dest_buffer = (short*)dest->line[0];
+   s+=c;
+   pos+=c;
+  }
+ }
+}
 
- if(y>dest->ct)
-  dest_buffer+= y*dest->w+x+x_start;
- else
-  dest_buffer+= dest->ct*dest->w+x+x_start;
 
- //draw the sprite
- i = y_length;
- while(i)
+static void blend_rle_rows32(BITMAP *dest, RLE_SPRITE *src, int x, int y, int n)
+{
+ signed int *s = (signed int*)src->dat;
+ int top = MAX(dest->ct-y, 0);
+ int bottom = MIN(dest->cb-y, src->h);
+ int left = dest->cl-x;
+ int right = dest->cr-x;
+ int i, c, pos, from, to;
+
+ for(i=0;i<bottom;i++)
  {
-  j= x_length;
-   while(j)
-    {
-     *dest_buffer = light_table[*src_buffer][*dest_buffer];
-     dest_buffer++;
-     src_buffer++;
-     j--;
-    }
-  dest_buffer+=dest_add;
-  src_buffer+=src_add;
-  i--;
+  pos=0;
+
+  while((unsigned int)(c = *s++)!=MASK_COLOR_32)
+  {
+   if(c<0)
+   {
+    pos-=c;
+    continue;
+   }
+
+   if(i>=top)
+   {
+    from = MAX(pos, left);
+    to = MIN(pos+c, right);
+    if(from<to)
+     blend_row32((unsigned int*)dest->line[y+i]+x+from, (unsigned int*)s+from-pos, to-from, n);
+   }
 
+   s+=c;
+   pos+=c;
+  }
  }
+}
+
 
+//draw a rle sprite blended like draw_trans_rle_sprite with
+//set_trans_blender(0,0,0,alpha), but without a call for every pixel.
+void draw_blend_rle_sprite(BITMAP *dest, RLE_SPRITE *src, int x, int y, int alpha)
+{
+ int depth = bitmap_color_depth(dest);
+
+ if(x+src->w<=dest->cl || x>=dest->cr || y+src->h<=dest->ct || y>=dest->cb) return;
 
+ //only memory bitmaps can be written to a line at a time
+ if(!is_memory_bitmap(dest) || src->color_depth!=depth || (depth!=15 && depth!=16 && depth!=32))
+ {
+  set_trans_blender(0,0,0,alpha);
+  draw_trans_rle_sprite(dest, src, x, y);
+  return;
+ }
+
+ //allegro uses 32 levels in 15 and 16 bit and 256 in 32 bit
+ if(depth==32)
+  blend_rle_rows32(dest, src, x, y, alpha ? alpha+1 : 0);
+ else if(depth==16)
+  blend_rle_rows16(dest, src, x, y, alpha ? (alpha+1)/8 : 0, MASK_COLOR_16, blend_row16);
+ else
+  blend_rle_rows16(dest, src, x, y, alpha ? (alpha+1)/8 : 0, MASK_COLOR_15, blend_row15);
 }
 
 
-//draw a light sprite
-void draw_additive_sprite(BITMAP *dest, BITMAP *src,int x, int y)
+//blend the runs of pixels that are not the mask color in each line
+//of a 16 or 15 bit bitmap
+static void blend_bitmap_rows16(BITMAP *dest, BITMAP *src, int x, int y, int n, unsigned short mask,
+								void (*blend_row)(unsigned short *dest, unsigned short *src, int len, int n))
 {
-	int i, j;
-	short x_start=0;
-	short x_length=src->w;
-	short y_start=0;
-	short y_length=src->h;
-	register short *dest_buffer;
-	register short *src_buffer;
-	short dest_add=dest->w-x_length;
-	short src_add= 0;
-	register unsigned int d_pix;
-	register unsigned int temp_pix;
-	
+ unsigned short *s;
+ int top = MAX(dest->ct-y, 0);
+ int bottom = MIN(dest->cb-y, src->h);
+ int left = MAX(dest->cl-x, 0);
+ int right = MIN(dest->cr-x, src->w);
+ int i, from, to;
+
+ for(i=top;i<bottom;i++)
+ {
+  s = (unsigned short*)src->line[i];
+  from = left;
 
-	//Do some stuff so the we only draw the part of the bitmap that is visable
-
-	src_buffer = (short*)src->line[0];
-
-	if(x<dest->cl || y<dest->ct || x+src->w>dest->cr || y+src->h>dest->cb)
-	{
-		if(x<dest->cl)
-		{
-			x_length-=-(x-dest->cl);
-			src_buffer+=-(x-dest->cl);
-			x_start=-(x-dest->cl);
-		}
-		if(x>dest->cr-src->w)
-		{
-			x_length-= (x-(dest->cr-src->w));
-		}
-
-		if(y<dest->ct)
-		{
-			src_buffer+=src->w*(-(y-dest->ct));
-			y_length=src->h+(y-dest->ct);
-		}
-		if(y>dest->cb-src->h)
-		{
-			y_length=src->h-(y-(dest->cb-src->h));
-		}
-
-		src_add = src->w-x_length;
-		dest_add = dest->w-x_length;
-	}
-
-	if(x_length<=0 || y_length<=0) return;
-
-	dest_buffer = (short*)dest->line[0];
-
-	if(y>dest->ct)
-		dest_buffer+= y*dest->w+x+x_start;
-	else
-		dest_buffer+= dest->ct*dest->w+x+x_start;
+  while(from<right)
+  {
+   //skip the masked pixels, then find where the run ends
+   while(from<right && s[from]==mask) from++;
+   for(to=from;to<right && s[to]!=mask;to++);
 
- 
-	//draw the sprite
-	if(bitmap_color_depth(dest)==16)
-	{
-		i = y_length;
-		while(i)
-		{
-			j= x_length;
-			while(j)
-			{
-				d_pix=0;
-
-				temp_pix = (*src_buffer & RED_MASK16) + (*dest_buffer & RED_MASK16);
-				if(temp_pix > RED_MASK16) temp_pix = RED_MASK16;
-				d_pix |= temp_pix;
-			
-				temp_pix = (*src_buffer & GREEN_MASK16) + (*dest_buffer & GREEN_MASK16);
-				if(temp_pix > GREEN_MASK16)temp_pix = GREEN_MASK16;
-				d_pix |= temp_pix;
-			
-				temp_pix = (*src_buffer & BLUE_MASK16) + (*dest_buffer & BLUE_MASK16);
-				if(temp_pix > BLUE_MASK16) temp_pix = BLUE_MASK16;
-				d_pix |= temp_pix;
-			
-				*dest_buffer = (unsigned short)d_pix;
-	
+   if(from<to)
+    blend_row((unsigned short*)dest->line[y+i]+x+from, s+from, to-from, n);
+
+   from = to;
+  }
+ }
+}
+
+
+static void blend_bitmap_rows32(BITMAP *dest, BITMAP *src, int x, int y, int n)
+{
+ unsigned int *s;
+ int top = MAX(dest->ct-y, 0);
+ int bottom = MIN(dest->cb-y, src->h);
+ int left = MAX(dest->cl-x, 0);
+ int right = MIN(dest->cr-x, src->w);
+ int i, from, to;
+
+ for(i=top;i<bottom;i++)
+ {
+  s = (unsigned int*)src->line[i];
+  from = left;
 
-				dest_buffer++;
-				src_buffer++;
-				j--;
-			}
-		
-			dest_buffer+=dest_add;
-			src_buffer+=src_add;
-			i--;
-		}
-	}
-	else if(bitmap_color_depth(dest)==15)
-	{
-		i = y_length;
-		while(i)
-		{
-			j= x_length;
-			while(j)
-			{
-				if(*src_buffer!=0)
-				{
-					d_pix=0;
-
-					temp_pix = (*src_buffer & RED_MASK15) + (*dest_buffer & RED_MASK15);
-					if(temp_pix > RED_MASK15) temp_pix = RED_MASK15;
-					d_pix |= temp_pix;
-			
-					temp_pix = (*src_buffer & GREEN_MASK15) + (*dest_buffer & GREEN_MASK15);
-					if(temp_pix > GREEN_MASK15)temp_pix = GREEN_MASK15;
-					d_pix |= temp_pix;
-			
-					temp_pix = (*src_buffer & BLUE_MASK15) + (*dest_buffer & BLUE_MASK15);
-					if(temp_pix > BLUE_MASK15) temp_pix = BLUE_MASK15;
-					d_pix |= temp_pix;
-			
-					*dest_buffer = (unsigned short)d_pix;
-
-				}
-
-				dest_buffer++;
-				src_buffer++;
-				j--;
-			}
-		
-			dest_buffer+=dest_add;
-			src_buffer+=src_add;
-			i--;
-		}
-
-	}
+  while(from<right)
+  {
+   while(from<right && s[from]==MASK_COLOR_32) from++;
+   for(to=from;to<right && s[to]!=MASK_COLOR_32;to++);
 
+   if(from<to)
+    blend_row32((unsigned int*)dest->line[y+i]+x+from, s+from, to-from, n);
 
+   from = to;
+  }
+ }
+}
+
+
+//draw a bitmap blended like draw_trans_sprite with
+//set_trans_blender(0,0,0,alpha), the masked pixels are left out.
+void draw_blend_sprite(BITMAP *dest, BITMAP *src, int x, int y, int alpha)
+{
+ int depth = bitmap_color_depth(dest);
+
+ if(x+src->w<=dest->cl || x>=dest->cr || y+src->h<=dest->ct || y>=dest->cb) return;
+
+ if(!is_memory_bitmap(dest) || !is_memory_bitmap(src) || bitmap_color_depth(src)!=depth || (depth!=15 && depth!=16 && depth!=32))
+ {
+  set_trans_blender(0,0,0,alpha);
+  draw_trans_sprite(dest, src, x, y);
+  return;
+ }
+
+ if(depth==32)
+  blend_bitmap_rows32(dest, src, x, y, alpha ? alpha+1 : 0);
+ else if(depth==16)
+  blend_bitmap_rows16(dest, src, x, y, alpha ? (alpha+1)/8 : 0, MASK_COLOR_16, blend_row16);
+ else
+  blend_bitmap_rows16(dest, src, x, y, alpha ? (alpha+1)/8 : 0, MASK_COLOR_15, blend_row15);
 }
 
 
@@ -294,106 +358,102 @@ void draw_lightmap(BITMAP *dest, BITMAP *src,int x, int y)
 //this is for_the game....
 void draw_lightmap2(BITMAP *dest, BITMAP *src,int x, int y)
 {
- int x_start=0;
- int x_length=src->w;
- int y_start=0;
- int y_length=src->h;
- register char *dest_buffer;
- register char *src_buffer;
- int dest_add=dest->w-x_length;
- int src_add= 0;
- int i, j;
+ lightmap2_rows(dest, src, x, y, dest->ct, dest->cb);
+}
 
-//Do some stuff so the we only draw the part of the bitmap that is visable
 
- src_buffer = (char*)src->line[0];
 
-  if(x<dest->cl || y<dest->ct || x+src->w>dest->cr || y+src->h>dest->cb)
-   {
-    if(x<dest->cl)
-     {
-      x_length-=-(x-dest->cl);
-      src_buffer+=-(x-dest->cl);
-      x_start=-(x-dest->cl);
-     }
-    if(x>dest->cr-src->w)
-     {
-      x_length-= (x-(dest->cr-src->w));
-     }
-
-    if(y<dest->ct)
-     {
-      src_buffer+=src->w*(-(y-dest->ct));
-      y_length=src->h+(y-dest->ct);
-     }
-    if(y>dest->cb-src->h)
-     {
-      y_length=src->h-(y-(dest->cb-src->h));
-     }
-
-    src_add = src->w-x_length;
-    dest_add = dest->w-x_length;
-   }
+//////////////////////////////////////////////////
+// The light mask. The mask is split into bands of
+// rows and every band is cleared, lit and put on
+// dest by its own worker. Each pixel gets the same
+// adds in the same order as when drawn with
+// draw_lightmap2 and draw_lightsprite, so the
+// result does not depend on the number of threads.
+//////////////////////////////////////////////////
 
- if(x_length<=0 || y_length<=0) return;
+typedef struct
+{
+	BITMAP *dest;
+	BITMAP *mask;
+	int light_level;
+	LIGHT_MASK_LIGHT *light;
+	int num_of_lights;
+	int band_h;
+}LIGHT_MASK_JOB;
 
- dest_buffer = (char*)dest->line[0];
+static FIEND_WORKER_POOL *light_pool=NULL;
+static int light_pool_threads=0;
 
- if(y>dest->ct)
-  dest_buffer+= y*dest->w+x+x_start;
- else
-  dest_buffer+= dest->ct*dest->w+x+x_start;
 
- 
- //draw the sprite
-/*	// Assembly code reworked into C code below.
-__asm
-{ 
-mov esi, src_buffer
-mov edi, dest_buffer
-
-mov edx, y_length
-zoop: 
-
-mov ecx, x_length 
-zool: 
-lodsb
-add al, [edi]
-
-cmp al, 32 
-jb nook
-mov al, 31
-nook: 
-mov [edi], al
-
-inc edi 
-dec ecx 
-
-jnz zool
- 
-add esi, src_add
-add edi, dest_add
+static void draw_light_band(void *arg, int band)
+{
+ LIGHT_MASK_JOB *job = arg;
+ BITMAP *mask = job->mask;
+ int top = band*job->band_h;
+ int bottom = MIN(top+job->band_h, mask->h);
+ int i;
 
-dec edx 
-jnz zoop 
+ for(i=MAX(top, mask->ct);i<MIN(bottom, mask->cb);i++)
+  memset((unsigned char*)mask->line[i]+mask->cl, job->light_level, mask->cr-mask->cl);
+
+ for(i=0;i<job->num_of_lights;i++)
+  lightmap2_rows(mask, job->light[i].pic, job->light[i].x, job->light[i].y, top, bottom);
+
+ lightsprite_rows(job->dest, mask, 0, 0, top, bottom);
 }
-*/
-
-for (i=0; i<y_length; i++) {
-	for (j=0; j<x_length; j++) {
-		*dest_buffer = *src_buffer + *dest_buffer;
-		
-		if (*dest_buffer > 31) *dest_buffer = 31;
-		
-		dest_buffer++;
-		src_buffer++;
-	}
-	
-	src_buffer += src_add;
-	dest_buffer += dest_add;
+
+
+//the number of threads to use, 0 means one per cpu
+static int get_light_threads(void)
+{
+ int num = light_mask_threads;
+
+ if(num<=0)
+  num = get_num_of_cpus();
+
+ return MID(1, num, LIGHT_MASK_MAX_THREADS);
 }
 
+
+//clear mask to light_level, add the lights to it and shade dest
+//with it.
+void draw_light_mask(BITMAP *dest, BITMAP *mask, int light_level, LIGHT_MASK_LIGHT *light, int num_of_lights)
+{
+ LIGHT_MASK_JOB job;
+ int threads = get_light_threads();
+
+ if(threads>1 && light_pool_threads!=threads)
+ {
+  release_light_mask();
+
+  light_pool = create_worker_pool(threads-1);
+  if(light_pool)
+   light_pool_threads = threads;
+ }
+ if(light_pool==NULL)
+  threads = 1;
+
+ job.dest = dest;
+ job.mask = mask;
+ job.light_level = light_level;
+ job.light = light;
+ job.num_of_lights = num_of_lights;
+ job.band_h = (mask->h + threads-1)/threads;
+
+ if(threads>1)
+  run_worker_jobs(light_pool, draw_light_band, &job, threads);
+ else
+  draw_light_band(&job, 0);
 }
 
 
+//stop the light mask workers
+void release_light_mask(void)
+{
+ if(light_pool)
+  destroy_worker_pool(light_pool);
 
+ light_pool=NULL;
+ light_pool_threads=0;
+}
@@ -1,5 +1,20 @@
 #include <allegro.h>
 
+#ifndef DRAW_H
+#define DRAW_H
+
+#define LIGHT_MASK_MAX_THREADS 8
+
+//a light map to add to the light mask
+typedef struct
+{
+	BITMAP *pic;
+	int x;
+	int y;
+}LIGHT_MASK_LIGHT;
+
+extern int light_mask_threads;
+
 
 
 void init_draw(void);
@@ -8,7 +23,16 @@ void draw_lightsprite(BITMAP *dest, BITMAP *src,int x, int y);
 
 void draw_additive_sprite(BITMAP *dest, BITMAP *src,int x, int y);
 
+void draw_blend_rle_sprite(BITMAP *dest, RLE_SPRITE *src, int x, int y, int alpha);
+
+void draw_blend_sprite(BITMAP *dest, BITMAP *src, int x, int y, int alpha);
+
 void draw_lightmap(BITMAP *dest, BITMAP *src,int x, int y);
 
 void draw_lightmap2(BITMAP *dest, BITMAP *src,int x, int y);
 
+void draw_light_mask(BITMAP *dest, BITMAP *mask, int light_level, LIGHT_MASK_LIGHT *light, int num_of_lights);
+
+void release_light_mask(void);
+
+#endif
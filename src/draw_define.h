@@ -181,7 +181,104 @@
 																		\
 		if(i<max_y)														\
 			dest_buffer +=(dest->w - max_x)+fixtoi(min_x_buffer[i+1]);	\
-}	
+}
+
+#define ROTATE_DRAW_LOOP_TRANS32				\
+	for(i=min_y;i<max_y;i++)					\
+	{											\
+		max_x = fixtoi(max_x_buffer[i]);		\
+		min_x = fixtoi(min_x_buffer[i]);		\
+												\
+		u = min_u_buffer[i];							\
+		v = min_v_buffer[i];							\
+														\
+		j = max_x - min_x;								\
+														\
+		src_buffer32 = (unsigned int*)src->line[0];				\
+		src_buffer32 += fixtoi(v)*src->w + fixtoi(u);			\
+		src_add_buffer = src_add;								\
+																\
+		while(j){						\
+			if(*src_buffer32!= MASK_COLOR_32)								\
+				*dest_buffer32 = *src_buffer32;								\
+																	\
+			src_buffer32+=*src_add_buffer;							\
+																	\
+			dest_buffer32++;												\
+			src_add_buffer++;											\
+			j--;}						\
+																		\
+		if(i+1<max_y)														\
+			dest_buffer32 +=(dest->w - max_x)+fixtoi(min_x_buffer[i+1]);	\
+}
+
+#define ROTATE_DRAW_LOOP_FLAT32				\
+	for(i=min_y;i<max_y;i++)					\
+	{											\
+		max_x = fixtoi(max_x_buffer[i]);		\
+		min_x = fixtoi(min_x_buffer[i]);		\
+												\
+		u = min_u_buffer[i];							\
+		v = min_v_buffer[i];							\
+														\
+		j = max_x - min_x;								\
+														\
+		src_buffer32 = (unsigned int*)src->line[0];				\
+		src_buffer32 += fixtoi(v)*src->w + fixtoi(u);			\
+		src_add_buffer = src_add;								\
+																\
+		while(j){						\
+																\
+			*dest_buffer32 = *src_buffer32;								\
+																	\
+			src_buffer32+=*src_add_buffer;							\
+																	\
+			dest_buffer32++;												\
+			src_add_buffer++;											\
+			j--;}						\
+																		\
+		if(i+1<max_y)														\
+			dest_buffer32 +=(dest->w - max_x)+fixtoi(min_x_buffer[i+1]);	\
+}
+
+//the 8 bit channels are added and maxed at 255
+#define ROTATE_DRAW_LOOP_ADDITIVE32				\
+	for(i=min_y;i<max_y;i++)					\
+	{											\
+		max_x = fixtoi(max_x_buffer[i]);		\
+		min_x = fixtoi(min_x_buffer[i]);		\
+												\
+		u = min_u_buffer[i];							\
+		v = min_v_buffer[i];							\
+														\
+		j = max_x - min_x;								\
+														\
+		src_buffer32 = (unsigned int*)src->line[0];				\
+		src_buffer32 += fixtoi(v)*src->w + fixtoi(u);			\
+		src_add_buffer = src_add;								\
+																\
+		while(j){								\
+			d_pix=0;							\
+			temp_pix = (*src_buffer32 & RED_MASK32) + (*dest_buffer32 & RED_MASK32);	\
+			if(temp_pix > RED_MASK32) temp_pix = RED_MASK32;							\
+			d_pix |= temp_pix;															\
+			temp_pix = (*src_buffer32 & GREEN_MASK32) + (*dest_buffer32 & GREEN_MASK32);	\
+			if(temp_pix > GREEN_MASK32)temp_pix = GREEN_MASK32;							\
+			d_pix |= temp_pix;															\
+			temp_pix = (*src_buffer32 & BLUE_MASK32) + (*dest_buffer32 & BLUE_MASK32);		\
+			if(temp_pix > BLUE_MASK32) temp_pix = BLUE_MASK32;							\
+			d_pix |= temp_pix;											\
+			*dest_buffer32 = d_pix;					\
+														\
+			src_buffer32+=*src_add_buffer;							\
+																	\
+			dest_buffer32++;												\
+			src_add_buffer++;											\
+			j--;}						\
+																		\
+		if(i+1<max_y)														\
+			dest_buffer32 +=(dest->w - max_x)+fixtoi(min_x_buffer[i+1]);	\
+}
 
 
 #endif	
\ No newline at end of file
@@ -0,0 +1,559 @@
+////////////////////////////////////////////////////
+// This file contains the draw list. Between dl_begin
+// and dl_end the dl_ drawing functions are not drawn
+// but saved in a list, so that the list can be drawn
+// later by the render thread while the game logic
+// goes on. Outside of that they draw at once.
+///////////////////////////////////////////////////
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <allegro.h>
+
+#include "draw.h"
+#include "draw_list.h"
+#include "rotate_sprite.h"
+#include "tile_atlas.h"
+
+
+//set when a draw list can be in use by the render thread, then sprites
+//are not destroyed until the list that can show them has been drawn.
+int dl_defer_destroy=0;
+
+//allegro keeps polygon edges and the rle sprite being made in the
+//same scratch memory, so the render thread and the game must take
+//turns using it.
+void (*dl_lock_scratch)(void)=NULL;
+void (*dl_unlock_scratch)(void)=NULL;
+
+
+static DRAW_LIST *current_list=NULL;
+
+//destroyed sprites not yet given to a list
+static DRAW_LIST_GARBAGE *pending_garbage=NULL;
+static int num_of_pending=0;
+static int max_pending=0;
+
+
+
+static DRAW_LIST_CMD *add_cmd(int type, BITMAP *dest, void *src, int x, int y)
+{
+	DRAW_LIST_CMD *temp;
+
+	if(current_list->num_of_cmds >= current_list->max_cmds)
+	{
+		current_list->max_cmds = current_list->max_cmds ? current_list->max_cmds*2 : 1024;
+		current_list->cmd = realloc(current_list->cmd, sizeof(DRAW_LIST_CMD)*current_list->max_cmds);
+	}
+
+	temp = &current_list->cmd[current_list->num_of_cmds];
+	current_list->num_of_cmds++;
+
+	memset(temp, 0, sizeof(DRAW_LIST_CMD));
+	temp->type = type;
+	temp->dest = dest;
+	temp->src = src;
+	temp->x = x;
+	temp->y = y;
+
+	return temp;
+}
+
+
+static void add_garbage(DRAW_LIST_GARBAGE **garbage, int *num, int *max, DRAW_LIST_GARBAGE pic)
+{
+	if(*num >= *max)
+	{
+		*max = *max ? *max*2 : 64;
+		*garbage = realloc(*garbage, sizeof(DRAW_LIST_GARBAGE)*(*max));
+	}
+
+	(*garbage)[*num] = pic;
+	(*num)++;
+}
+
+
+static void destroy_garbage(DRAW_LIST_GARBAGE *pic)
+{
+	if(pic->sprite)
+		destroy_rle_sprite(pic->sprite);
+	if(pic->bmp)
+		destroy_bitmap(pic->bmp);
+}
+
+
+
+/////////////////////////////////////////////////
+////////// THE LIST /////////////////////////////
+/////////////////////////////////////////////////
+
+
+//start saving the dl_ drawing in the list
+void dl_begin(DRAW_LIST *list)
+{
+	current_list = list;
+}
+
+
+//stop saving, the list gets the sprites destroyed since the last list
+void dl_end(void)
+{
+	int i;
+
+	if(current_list==NULL)
+		return;
+
+	for(i=0;i<num_of_pending;i++)
+		add_garbage(&current_list->garbage, &current_list->num_of_garbage, &current_list->max_garbage, pending_garbage[i]);
+	num_of_pending=0;
+
+	current_list = NULL;
+}
+
+
+//draw all the commands in the list
+void dl_replay(DRAW_LIST *list)
+{
+	int i;
+	DRAW_LIST_CMD *temp;
+
+	for(i=0;i<list->num_of_cmds;i++)
+	{
+		temp = &list->cmd[i];
+
+		switch(temp->type)
+		{
+		case DL_RLE_SPRITE:
+			draw_rle_sprite(temp->dest, temp->src, temp->x, temp->y);
+			break;
+		case DL_TRANS_RLE_SPRITE:
+			draw_trans_rle_sprite(temp->dest, temp->src, temp->x, temp->y);
+			break;
+		case DL_LIT_RLE_SPRITE:
+			draw_lit_rle_sprite(temp->dest, temp->src, temp->x, temp->y, temp->arg[0]);
+			break;
+		case DL_SPRITE:
+			draw_sprite(temp->dest, temp->src, temp->x, temp->y);
+			break;
+		case DL_TRANS_SPRITE:
+			draw_trans_sprite(temp->dest, temp->src, temp->x, temp->y);
+			break;
+		case DL_ROTATE_SPRITE:
+			rotate_sprite(temp->dest, temp->src, temp->x, temp->y, temp->arg[0]);
+			break;
+		case DL_ROTATE_SCALED_SPRITE:
+			rotate_scaled_sprite(temp->dest, temp->src, temp->x, temp->y, temp->arg[0], temp->arg[1]);
+			break;
+		case DL_PIVOT_SPRITE:
+			pivot_sprite(temp->dest, temp->src, temp->x, temp->y, temp->arg[1], temp->arg[2], temp->arg[0]);
+			break;
+		case DL_ROTATE_FIEND_SPRITE:
+			rotate_fiend_sprite(temp->dest, temp->src, temp->x, temp->y, temp->angle, temp->arg[0]);
+			break;
+		case DL_PUTPIXEL:
+			putpixel(temp->dest, temp->x, temp->y, temp->arg[0]);
+			break;
+		case DL_CIRCLE:
+			circle(temp->dest, temp->x, temp->y, temp->arg[1], temp->arg[0]);
+			break;
+		case DL_CIRCLEFILL:
+			circlefill(temp->dest, temp->x, temp->y, temp->arg[1], temp->arg[0]);
+			break;
+		case DL_CLEAR_TO_COLOR:
+			clear_to_color(temp->dest, temp->arg[0]);
+			break;
+		case DL_DRAWING_MODE:
+			drawing_mode(temp->arg[0], temp->src, temp->x, temp->y);
+			break;
+		case DL_TRANS_BLENDER:
+			set_trans_blender(temp->arg[0], temp->arg[1], temp->arg[2], temp->arg[3]);
+			break;
+		case DL_LIGHTSPRITE:
+			draw_lightsprite(temp->dest, temp->src, temp->x, temp->y);
+			break;
+		case DL_ADDITIVE_SPRITE:
+			draw_additive_sprite(temp->dest, temp->src, temp->x, temp->y);
+			break;
+		case DL_BLEND_RLE_SPRITE:
+			draw_blend_rle_sprite(temp->dest, temp->src, temp->x, temp->y, temp->arg[0]);
+			break;
+		case DL_BLEND_SPRITE:
+			draw_blend_sprite(temp->dest, temp->src, temp->x, temp->y, temp->arg[0]);
+			break;
+		case DL_TILE:
+			draw_tile(temp->dest, temp->arg[0], temp->arg[1], temp->x, temp->y);
+			break;
+		case DL_LIGHTMAP2:
+			draw_lightmap2(temp->dest, temp->src, temp->x, temp->y);
+			break;
+		case DL_QUAD3D_F:
+			if(dl_lock_scratch)dl_lock_scratch();
+			quad3d_f(temp->dest, temp->arg[0], temp->src, &list->vertex[temp->arg[1]], &list->vertex[temp->arg[1]+1],
+				&list->vertex[temp->arg[1]+2], &list->vertex[temp->arg[1]+3]);
+			if(dl_unlock_scratch)dl_unlock_scratch();
+			break;
+		case DL_LIGHT_MASK:
+			draw_light_mask(temp->dest, temp->src, temp->arg[0], &list->light[temp->arg[1]], temp->arg[2]);
+			break;
+		}
+	}
+}
+
+
+//empty the list and destroy its garbage. the list must not be in use.
+void dl_clear(DRAW_LIST *list)
+{
+	int i;
+
+	for(i=0;i<list->num_of_garbage;i++)
+		destroy_garbage(&list->garbage[i]);
+
+	list->num_of_cmds=0;
+	list->num_of_vertices=0;
+	list->num_of_lights=0;
+	list->num_of_garbage=0;
+}
+
+
+void dl_release(DRAW_LIST *list)
+{
+	dl_clear(list);
+
+	free(list->cmd);
+	free(list->vertex);
+	free(list->light);
+	free(list->garbage);
+
+	memset(list, 0, sizeof(DRAW_LIST));
+}
+
+
+
+/////////////////////////////////////////////////
+////////// SPRITES THAT CAN BE IN USE ///////////
+/////////////////////////////////////////////////
+
+
+//destroy a sprite that might be saved in a list
+void dl_destroy_rle_sprite(RLE_SPRITE *pic)
+{
+	DRAW_LIST_GARBAGE temp = {pic, NULL};
+
+	if(dl_defer_destroy)
+		add_garbage(&pending_garbage, &num_of_pending, &max_pending, temp);
+	else
+		destroy_rle_sprite(pic);
+}
+
+
+//destroy a bitmap that might be saved in a list
+void dl_destroy_bitmap(BITMAP *bmp)
+{
+	DRAW_LIST_GARBAGE temp = {NULL, bmp};
+
+	if(dl_defer_destroy)
+		add_garbage(&pending_garbage, &num_of_pending, &max_pending, temp);
+	else
+		destroy_bitmap(bmp);
+}
+
+
+//destroy the sprites that no list has got. only when no list is in use.
+void dl_flush_garbage(void)
+{
+	int i;
+
+	for(i=0;i<num_of_pending;i++)
+		destroy_garbage(&pending_garbage[i]);
+	num_of_pending=0;
+}
+
+
+RLE_SPRITE *dl_get_rle_sprite(BITMAP *bmp)
+{
+	RLE_SPRITE *pic;
+
+	if(dl_lock_scratch)dl_lock_scratch();
+	pic = get_rle_sprite(bmp);
+	if(dl_unlock_scratch)dl_unlock_scratch();
+
+	return pic;
+}
+
+
+
+/////////////////////////////////////////////////
+////////// DRAWING //////////////////////////////
+/////////////////////////////////////////////////
+
+
+void dl_draw_rle_sprite(BITMAP *dest, RLE_SPRITE *src, int x, int y)
+{
+	if(current_list)
+		add_cmd(DL_RLE_SPRITE, dest, src, x, y);
+	else
+		draw_rle_sprite(dest, src, x, y);
+}
+
+void dl_draw_trans_rle_sprite(BITMAP *dest, RLE_SPRITE *src, int x, int y)
+{
+	if(current_list)
+		add_cmd(DL_TRANS_RLE_SPRITE, dest, src, x, y);
+	else
+		draw_trans_rle_sprite(dest, src, x, y);
+}
+
+void dl_draw_lit_rle_sprite(BITMAP *dest, RLE_SPRITE *src, int x, int y, int color)
+{
+	if(current_list)
+		add_cmd(DL_LIT_RLE_SPRITE, dest, src, x, y)->arg[0] = color;
+	else
+		draw_lit_rle_sprite(dest, src, x, y, color);
+}
+
+void dl_draw_sprite(BITMAP *dest, BITMAP *src, int x, int y)
+{
+	if(current_list)
+		add_cmd(DL_SPRITE, dest, src, x, y);
+	else
+		draw_sprite(dest, src, x, y);
+}
+
+void dl_draw_trans_sprite(BITMAP *dest, BITMAP *src, int x, int y)
+{
+	if(current_list)
+		add_cmd(DL_TRANS_SPRITE, dest, src, x, y);
+	else
+		draw_trans_sprite(dest, src, x, y);
+}
+
+void dl_rotate_sprite(BITMAP *dest, BITMAP *src, int x, int y, fixed angle)
+{
+	if(current_list)
+		add_cmd(DL_ROTATE_SPRITE, dest, src, x, y)->arg[0] = angle;
+	else
+		rotate_sprite(dest, src, x, y, angle);
+}
+
+void dl_rotate_scaled_sprite(BITMAP *dest, BITMAP *src, int x, int y, fixed angle, fixed scale)
+{
+	DRAW_LIST_CMD *temp;
+
+	if(current_list)
+	{
+		temp = add_cmd(DL_ROTATE_SCALED_SPRITE, dest, src, x, y);
+		temp->arg[0] = angle;
+		temp->arg[1] = scale;
+	}
+	else
+		rotate_scaled_sprite(dest, src, x, y, angle, scale);
+}
+
+void dl_pivot_sprite(BITMAP *dest, BITMAP *src, int x, int y, int cx, int cy, fixed angle)
+{
+	DRAW_LIST_CMD *temp;
+
+	if(current_list)
+	{
+		temp = add_cmd(DL_PIVOT_SPRITE, dest, src, x, y);
+		temp->arg[0] = angle;
+		temp->arg[1] = cx;
+		temp->arg[2] = cy;
+	}
+	else
+		pivot_sprite(dest, src, x, y, cx, cy, angle);
+}
+
+void dl_rotate_fiend_sprite(BITMAP *dest, BITMAP *src, int x, int y, float angle, int draw_mode)
+{
+	DRAW_LIST_CMD *temp;
+
+	if(current_list)
+	{
+		temp = add_cmd(DL_ROTATE_FIEND_SPRITE, dest, src, x, y);
+		temp->angle = angle;
+		temp->arg[0] = draw_mode;
+	}
+	else
+		rotate_fiend_sprite(dest, src, x, y, angle, draw_mode);
+}
+
+
+void dl_putpixel(BITMAP *dest, int x, int y, int color)
+{
+	if(current_list)
+		add_cmd(DL_PUTPIXEL, dest, NULL, x, y)->arg[0] = color;
+	else
+		putpixel(dest, x, y, color);
+}
+
+void dl_circle(BITMAP *dest, int x, int y, int r, int color)
+{
+	DRAW_LIST_CMD *temp;
+
+	if(current_list)
+	{
+		temp = add_cmd(DL_CIRCLE, dest, NULL, x, y);
+		temp->arg[0] = color;
+		temp->arg[1] = r;
+	}
+	else
+		circle(dest, x, y, r, color);
+}
+
+void dl_circlefill(BITMAP *dest, int x, int y, int r, int color)
+{
+	DRAW_LIST_CMD *temp;
+
+	if(current_list)
+	{
+		temp = add_cmd(DL_CIRCLEFILL, dest, NULL, x, y);
+		temp->arg[0] = color;
+		temp->arg[1] = r;
+	}
+	else
+		circlefill(dest, x, y, r, color);
+}
+
+void dl_clear_to_color(BITMAP *dest, int color)
+{
+	if(current_list)
+		add_cmd(DL_CLEAR_TO_COLOR, dest, NULL, 0, 0)->arg[0] = color;
+	else
+		clear_to_color(dest, color);
+}
+
+
+void dl_drawing_mode(int mode, BITMAP *pattern, int x_anchor, int y_anchor)
+{
+	if(current_list)
+		add_cmd(DL_DRAWING_MODE, NULL, pattern, x_anchor, y_anchor)->arg[0] = mode;
+	else
+		drawing_mode(mode, pattern, x_anchor, y_anchor);
+}
+
+void dl_set_trans_blender(int r, int g, int b, int a)
+{
+	DRAW_LIST_CMD *temp;
+
+	if(current_list)
+	{
+		temp = add_cmd(DL_TRANS_BLENDER, NULL, NULL, 0, 0);
+		temp->arg[0] = r;
+		temp->arg[1] = g;
+		temp->arg[2] = b;
+		temp->arg[3] = a;
+	}
+	else
+		set_trans_blender(r, g, b, a);
+}
+
+
+void dl_draw_lightsprite(BITMAP *dest, BITMAP *src, int x, int y)
+{
+	if(current_list)
+		add_cmd(DL_LIGHTSPRITE, dest, src, x, y);
+	else
+		draw_lightsprite(dest, src, x, y);
+}
+
+void dl_draw_additive_sprite(BITMAP *dest, BITMAP *src, int x, int y)
+{
+	if(current_list)
+		add_cmd(DL_ADDITIVE_SPRITE, dest, src, x, y);
+	else
+		draw_additive_sprite(dest, src, x, y);
+}
+
+void dl_draw_blend_rle_sprite(BITMAP *dest, RLE_SPRITE *src, int x, int y, int alpha)
+{
+	if(current_list)
+		add_cmd(DL_BLEND_RLE_SPRITE, dest, src, x, y)->arg[0] = alpha;
+	else
+		draw_blend_rle_sprite(dest, src, x, y, alpha);
+}
+
+void dl_draw_blend_sprite(BITMAP *dest, BITMAP *src, int x, int y, int alpha)
+{
+	if(current_list)
+		add_cmd(DL_BLEND_SPRITE, dest, src, x, y)->arg[0] = alpha;
+	else
+		draw_blend_sprite(dest, src, x, y, alpha);
+}
+
+void dl_draw_tile(BITMAP *dest, int tile_set, int tile_num, int x, int y)
+{
+	DRAW_LIST_CMD *temp;
+
+	if(current_list)
+	{
+		temp = add_cmd(DL_TILE, dest, NULL, x, y);
+		temp->arg[0] = tile_set;
+		temp->arg[1] = tile_num;
+	}
+	else
+		draw_tile(dest, tile_set, tile_num, x, y);
+}
+
+void dl_draw_lightmap2(BITMAP *dest, BITMAP *src, int x, int y)
+{
+	if(current_list)
+		add_cmd(DL_LIGHTMAP2, dest, src, x, y);
+	else
+		draw_lightmap2(dest, src, x, y);
+}
+
+
+void dl_quad3d_f(BITMAP *dest, int type, BITMAP *texture, V3D_f *v1, V3D_f *v2, V3D_f *v3, V3D_f *v4)
+{
+	DRAW_LIST_CMD *temp;
+
+	if(current_list==NULL)
+	{
+		quad3d_f(dest, type, texture, v1, v2, v3, v4);
+		return;
+	}
+
+	if(current_list->num_of_vertices+4 > current_list->max_vertices)
+	{
+		current_list->max_vertices = current_list->max_vertices ? current_list->max_vertices*2 : 64;
+		current_list->vertex = realloc(current_list->vertex, sizeof(V3D_f)*current_list->max_vertices);
+	}
+
+	temp = add_cmd(DL_QUAD3D_F, dest, texture, 0, 0);
+	temp->arg[0] = type;
+	temp->arg[1] = current_list->num_of_vertices;
+
+	current_list->vertex[current_list->num_of_vertices++] = *v1;
+	current_list->vertex[current_list->num_of_vertices++] = *v2;
+	current_list->vertex[current_list->num_of_vertices++] = *v3;
+	current_list->vertex[current_list->num_of_vertices++] = *v4;
+}
+
+
+void dl_draw_light_mask(BITMAP *dest, BITMAP *mask, int light_level, LIGHT_MASK_LIGHT *light, int num_of_lights)
+{
+	DRAW_LIST_CMD *temp;
+
+	if(current_list==NULL)
+	{
+		draw_light_mask(dest, mask, light_level, light, num_of_lights);
+		return;
+	}
+
+	if(current_list->num_of_lights+num_of_lights > current_list->max_lights)
+	{
+		current_list->max_lights = MAX(current_list->max_lights*2, current_list->num_of_lights+num_of_lights);
+		current_list->light = realloc(current_list->light, sizeof(LIGHT_MASK_LIGHT)*current_list->max_lights);
+	}
+
+	temp = add_cmd(DL_LIGHT_MASK, dest, mask, 0, 0);
+	temp->arg[0] = light_level;
+	temp->arg[1] = current_list->num_of_lights;
+	temp->arg[2] = num_of_lights;
+
+	memcpy(&current_list->light[current_list->num_of_lights], light, sizeof(LIGHT_MASK_LIGHT)*num_of_lights);
+	current_list->num_of_lights += num_of_lights;
+}
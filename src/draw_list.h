@@ -0,0 +1,122 @@
+#include <allegro.h>
+
+#include "draw.h"
+
+
+#ifndef DRAW_LIST_H
+#define DRAW_LIST_H
+
+//the commands that can be recorded
+#define DL_RLE_SPRITE 0
+#define DL_TRANS_RLE_SPRITE 1
+#define DL_LIT_RLE_SPRITE 2
+#define DL_SPRITE 3
+#define DL_TRANS_SPRITE 4
+#define DL_ROTATE_SPRITE 5
+#define DL_ROTATE_SCALED_SPRITE 6
+#define DL_PIVOT_SPRITE 7
+#define DL_ROTATE_FIEND_SPRITE 8
+#define DL_PUTPIXEL 9
+#define DL_CIRCLE 10
+#define DL_CIRCLEFILL 11
+#define DL_CLEAR_TO_COLOR 12
+#define DL_DRAWING_MODE 13
+#define DL_TRANS_BLENDER 14
+#define DL_LIGHTSPRITE 15
+#define DL_ADDITIVE_SPRITE 16
+#define DL_LIGHTMAP2 17
+#define DL_QUAD3D_F 18
+#define DL_LIGHT_MASK 19
+#define DL_BLEND_RLE_SPRITE 20
+#define DL_TILE 21
+#define DL_BLEND_SPRITE 22
+
+
+typedef struct
+{
+	int type;
+	BITMAP *dest;
+	void *src;//a BITMAP or an RLE_SPRITE
+	int x;
+	int y;
+	int arg[4];//color, angle, pivot and such. depends on the type
+	float angle;
+}DRAW_LIST_CMD;
+
+
+//a sprite or bitmap to destroy when no list can show it
+typedef struct
+{
+	RLE_SPRITE *sprite;
+	BITMAP *bmp;
+}DRAW_LIST_GARBAGE;
+
+
+typedef struct
+{
+	DRAW_LIST_CMD *cmd;
+	int num_of_cmds;
+	int max_cmds;
+
+	V3D_f *vertex;//the corners of the DL_QUAD3D_F commands
+	int num_of_vertices;
+	int max_vertices;
+
+	LIGHT_MASK_LIGHT *light;//the lights of the DL_LIGHT_MASK commands
+	int num_of_lights;
+	int max_lights;
+
+	DRAW_LIST_GARBAGE *garbage;//sprites that can be destroyed when the list is drawn
+	int num_of_garbage;
+	int max_garbage;
+}DRAW_LIST;
+
+
+extern int dl_defer_destroy;
+
+extern void (*dl_lock_scratch)(void);
+extern void (*dl_unlock_scratch)(void);
+
+
+void dl_begin(DRAW_LIST *list);
+void dl_end(void);
+void dl_replay(DRAW_LIST *list);
+void dl_clear(DRAW_LIST *list);
+void dl_release(DRAW_LIST *list);
+
+void dl_destroy_rle_sprite(RLE_SPRITE *pic);
+void dl_destroy_bitmap(BITMAP *bmp);
+void dl_flush_garbage(void);
+RLE_SPRITE *dl_get_rle_sprite(BITMAP *bmp);
+
+
+void dl_draw_rle_sprite(BITMAP *dest, RLE_SPRITE *src, int x, int y);
+void dl_draw_trans_rle_sprite(BITMAP *dest, RLE_SPRITE *src, int x, int y);
+void dl_draw_lit_rle_sprite(BITMAP *dest, RLE_SPRITE *src, int x, int y, int color);
+void dl_draw_sprite(BITMAP *dest, BITMAP *src, int x, int y);
+void dl_draw_trans_sprite(BITMAP *dest, BITMAP *src, int x, int y);
+void dl_rotate_sprite(BITMAP *dest, BITMAP *src, int x, int y, fixed angle);
+void dl_rotate_scaled_sprite(BITMAP *dest, BITMAP *src, int x, int y, fixed angle, fixed scale);
+void dl_pivot_sprite(BITMAP *dest, BITMAP *src, int x, int y, int cx, int cy, fixed angle);
+void dl_rotate_fiend_sprite(BITMAP *dest, BITMAP *src, int x, int y, float angle, int draw_mode);
+
+void dl_putpixel(BITMAP *dest, int x, int y, int color);
+void dl_circle(BITMAP *dest, int x, int y, int r, int color);
+void dl_circlefill(BITMAP *dest, int x, int y, int r, int color);
+void dl_clear_to_color(BITMAP *dest, int color);
+
+void dl_drawing_mode(int mode, BITMAP *pattern, int x_anchor, int y_anchor);
+void dl_set_trans_blender(int r, int g, int b, int a);
+
+void dl_draw_lightsprite(BITMAP *dest, BITMAP *src, int x, int y);
+void dl_draw_additive_sprite(BITMAP *dest, BITMAP *src, int x, int y);
+void dl_draw_blend_rle_sprite(BITMAP *dest, RLE_SPRITE *src, int x, int y, int alpha);
+void dl_draw_blend_sprite(BITMAP *dest, BITMAP *src, int x, int y, int alpha);
+void dl_draw_tile(BITMAP *dest, int tile_set, int tile_num, int x, int y);
+void dl_draw_lightmap2(BITMAP *dest, BITMAP *src, int x, int y);
+
+void dl_quad3d_f(BITMAP *dest, int type, BITMAP *texture, V3D_f *v1, V3D_f *v2, V3D_f *v3, V3D_f *v4);
+
+void dl_draw_light_mask(BITMAP *dest, BITMAP *mask, int light_level, LIGHT_MASK_LIGHT *light, int num_of_lights);
+
+#endif
@@ -35,6 +35,10 @@
 #define GREEN_MASK15 992
 #define BLUE_MASK15 31
 
+#define RED_MASK32 0xff0000
+#define GREEN_MASK32 0xff00
+#define BLUE_MASK32 0xff
+
 
 typedef struct HLINE_FILL_INFO
 {
@@ -43,7 +47,7 @@ typedef struct HLINE_FILL_INFO
     long vstart, vend;
 } HLINE_FILL_INFO;
 
-static HLINE_FILL_INFO infos[480];
+static HLINE_FILL_INFO infos[MAX_VIEW_H];
 
 //===========================================================================
 //    IMPLEMENTATION PRIVATE STRUCTURES
@@ -91,7 +95,7 @@ static __inline void draw_hline_list_##name(BITMAP *bmp, HLINE_FILL_INFO *infos,
             xend = bmp->cr - 1;             \
         }                                   \
         \
-        dest = ((unsigned short*)bmp->line[ystart])+xstart; \
+        dest = ((type*)bmp->line[ystart])+xstart; \
         \
         while(xstart <= xend)        {      \
             WRITE_PIXEL;                    \
@@ -225,6 +229,65 @@ DRAW_HLINE_LIST(unsigned short,atex_15)
 #undef INCX
 #undef INCDEST
 
+// ATEX 32 bit color
+#define DECLARE_VARS        \
+    long ustart, uend;      \
+    long udelta;            \
+    long vstart, vend;      \
+    long vdelta;            \
+    long puv;				\
+	unsigned int d_pix;		\
+	unsigned int temp_pix;	\
+	unsigned int col;
+
+#define GET_HLINE_VARS                  \
+    ustart = infos[i].ustart;           \
+    uend = infos[i].uend;               \
+    vstart = infos[i].vstart;           \
+    vend = infos[i].vend;               \
+    puv = xend - xstart;                \
+    if(puv) {                           \
+        udelta = (uend-ustart)/puv;     \
+        vdelta = (vend-vstart)/puv;     \
+    }                                   \
+    else    {                           \
+        udelta = (uend-ustart);         \
+        vdelta = (vend-vstart);         \
+    }
+
+#define CLIPX               \
+    ustart += udelta*gap;   \
+    vstart += vdelta*gap;
+
+#define WRITE_PIXEL \
+	col = ((unsigned int*)tex_data)[(((vstart>>16)&tex_vmask)<<tex_vshift)+((ustart>>16)&tex_umask)]; \
+	d_pix=0;													\
+	temp_pix = (col & RED_MASK32) + (*dest & RED_MASK32);		\
+	if(temp_pix > RED_MASK32) temp_pix = RED_MASK32;			\
+	d_pix |= temp_pix;											\
+	temp_pix = (col & GREEN_MASK32) + (*dest & GREEN_MASK32);	\
+	if(temp_pix > GREEN_MASK32)temp_pix = GREEN_MASK32;			\
+	d_pix |= temp_pix;											\
+	temp_pix = (col & BLUE_MASK32) + (*dest & BLUE_MASK32);		\
+	if(temp_pix > BLUE_MASK32) temp_pix = BLUE_MASK32;			\
+	d_pix |= temp_pix;											\
+	*dest = d_pix;
+
+#define INCX            \
+    ustart += udelta;   \
+    vstart += vdelta;
+
+#define INCDEST dest++
+
+DRAW_HLINE_LIST(unsigned int,atex_32)
+
+#undef DECLARE_VARS
+#undef GET_HLINE_VARS
+#undef CLIPX
+#undef WRITE_PIXEL
+#undef INCX
+#undef INCDEST
+
 static __inline void poly3_atex(BITMAP *bmp, BITMAP *tex, VERTEX *v1, VERTEX *v2, VERTEX *v3)
 {
     VERTEX *temp;
@@ -334,7 +397,7 @@ static __inline void poly3_atex(BITMAP *bmp, BITMAP *tex, VERTEX *v1, VERTEX *v2
     }
     
     // Fill global variables states
-    tex_data = (unsigned short*)tex->line[0];
+    tex_data = tex->line[0];
     tex_umask = tex->w - 1;
     tex_vmask = tex->h - 1;
     
@@ -489,7 +552,9 @@ static __inline void poly3_atex(BITMAP *bmp, BITMAP *tex, VERTEX *v1, VERTEX *v2
             }
         }
     }
-    if(bitmap_color_depth(bmp)==16)
+    if(bitmap_color_depth(bmp)==32)
+		draw_hline_list_atex_32(bmp, infos, starty, endy);
+    else if(bitmap_color_depth(bmp)==16)
 		draw_hline_list_atex_16(bmp, infos, starty, endy);
 	else
 		draw_hline_list_atex_15(bmp, infos, starty, endy);
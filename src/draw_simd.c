@@ -0,0 +1,1244 @@
+////////////////////////////////////////////////////
+// This file contains the pixel loops used by draw.c,
+// as plain C and as SSE2/AVX2 versions. The fastest
+// version the cpu supports is picked at startup.
+//
+// The light shading gives the same result as the old
+// light_table: each channel is expanded to 8 bits
+// like getr() does, multiplied with itofix(light)/31,
+// rounded like fixtoi() and cut back like makecol().
+// The 32 bit versions work on the 8 bit channels as
+// they are and are not cut back.
+///////////////////////////////////////////////////
+
+
+#include <stdio.h>
+
+#include "draw_simd.h"
+#include "logger.h"
+
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define USE_X86_SIMD
+#include <immintrin.h>
+
+//windows only keeps the stack 4 byte aligned on 32 bit
+#ifdef __i386__
+#define SIMD_FUNC(x) __attribute__((target(x), force_align_arg_pointer))
+#else
+#define SIMD_FUNC(x) __attribute__((target(x)))
+#endif
+
+#endif
+
+
+int draw_simd_level=DRAW_SIMD_NONE;
+
+void (*light_row16)(unsigned short *dest, unsigned char *light, int len);
+void (*light_row15)(unsigned short *dest, unsigned char *light, int len);
+void (*light_row32)(unsigned int *dest, unsigned char *light, int len);
+void (*lightmap_row)(unsigned char *dest, unsigned char *src, int len);
+void (*additive_row16)(unsigned short *dest, unsigned short *src, int len);
+void (*additive_row15)(unsigned short *dest, unsigned short *src, int len);
+void (*additive_row32)(unsigned int *dest, unsigned int *src, int len);
+void (*blend_row16)(unsigned short *dest, unsigned short *src, int len, int n);
+void (*blend_row15)(unsigned short *dest, unsigned short *src, int len, int n);
+void (*blend_row32)(unsigned int *dest, unsigned int *src, int len, int n);
+void (*convert_row16)(unsigned int *dest, unsigned short *src, int len);
+void (*convert_row15)(unsigned int *dest, unsigned short *src, int len);
+void (*scale_row32)(unsigned int *dest, unsigned int *src, int len, int scale);
+
+//itofix(light)/31
+static int light_mul[32];
+
+
+
+/////////////////////////////////////////////////
+////////// PLAIN C //////////////////////////////
+/////////////////////////////////////////////////
+
+//c8 is a 0-255 channel, returns it shaded and still 0-255
+#define LIGHT_CHANNEL(c8, l) (((c8)*light_mul[l] + 0x8000) >> 16)
+
+//shaded 5 and 6 bit channels for every light level, so the plain C
+//loops don't need any multiplies
+static unsigned char light_scale5[32][32];
+static unsigned char light_scale6[32][64];
+
+
+static void light_row16_c(unsigned short *dest, unsigned char *light, int len)
+{
+	while(len--)
+	{
+		*dest = (light_scale5[*light][*dest >> 11] << 11) |
+				(light_scale6[*light][(*dest >> 5) & 63] << 5) |
+				light_scale5[*light][*dest & 31];
+
+		dest++;
+		light++;
+	}
+}
+
+
+static void light_row15_c(unsigned short *dest, unsigned char *light, int len)
+{
+	while(len--)
+	{
+		*dest = (light_scale5[*light][(*dest >> 10) & 31] << 10) |
+				(light_scale5[*light][(*dest >> 5) & 31] << 5) |
+				light_scale5[*light][*dest & 31];
+
+		dest++;
+		light++;
+	}
+}
+
+
+static void light_row32_c(unsigned int *dest, unsigned char *light, int len)
+{
+	while(len--)
+	{
+		*dest = (LIGHT_CHANNEL((*dest >> 16) & 255, *light) << 16) |
+				(LIGHT_CHANNEL((*dest >> 8) & 255, *light) << 8) |
+				LIGHT_CHANNEL(*dest & 255, *light);
+
+		dest++;
+		light++;
+	}
+}
+
+
+//add light to the light mask, 31 is max
+static void lightmap_row_c(unsigned char *dest, unsigned char *src, int len)
+{
+	unsigned int c;
+
+	while(len--)
+	{
+		c = *dest + *src;
+		if(c > 31) c = 31;
+		*dest = c;
+
+		dest++;
+		src++;
+	}
+}
+
+
+#define RED_MASK16 63488
+#define GREEN_MASK16 2016
+#define BLUE_MASK16 31
+
+#define RED_MASK15 31744
+#define GREEN_MASK15 992
+#define BLUE_MASK15 31
+
+#define RED_MASK32 0xff0000
+#define GREEN_MASK32 0xff00
+#define BLUE_MASK32 0xff
+
+//add the colors channel by channel, each channel is maxed at full
+static void additive_row16_c(unsigned short *dest, unsigned short *src, int len)
+{
+	unsigned int d_pix;
+	unsigned int temp_pix;
+
+	while(len--)
+	{
+		d_pix=0;
+
+		temp_pix = (*src & RED_MASK16) + (*dest & RED_MASK16);
+		if(temp_pix > RED_MASK16) temp_pix = RED_MASK16;
+		d_pix |= temp_pix;
+	
+		temp_pix = (*src & GREEN_MASK16) + (*dest & GREEN_MASK16);
+		if(temp_pix > GREEN_MASK16)temp_pix = GREEN_MASK16;
+		d_pix |= temp_pix;
+	
+		temp_pix = (*src & BLUE_MASK16) + (*dest & BLUE_MASK16);
+		if(temp_pix > BLUE_MASK16) temp_pix = BLUE_MASK16;
+		d_pix |= temp_pix;
+	
+		*dest = d_pix;
+
+		dest++;
+		src++;
+	}
+}
+
+
+//in 15 bit black src pixels are skipped
+static void additive_row15_c(unsigned short *dest, unsigned short *src, int len)
+{
+	unsigned int d_pix;
+	unsigned int temp_pix;
+
+	while(len--)
+	{
+		if(*src!=0)
+		{
+			d_pix=0;
+
+			temp_pix = (*src & RED_MASK15) + (*dest & RED_MASK15);
+			if(temp_pix > RED_MASK15) temp_pix = RED_MASK15;
+			d_pix |= temp_pix;
+	
+			temp_pix = (*src & GREEN_MASK15) + (*dest & GREEN_MASK15);
+			if(temp_pix > GREEN_MASK15)temp_pix = GREEN_MASK15;
+			d_pix |= temp_pix;
+	
+			temp_pix = (*src & BLUE_MASK15) + (*dest & BLUE_MASK15);
+			if(temp_pix > BLUE_MASK15) temp_pix = BLUE_MASK15;
+			d_pix |= temp_pix;
+	
+			*dest = d_pix;
+		}
+
+		dest++;
+		src++;
+	}
+}
+
+
+static void additive_row32_c(unsigned int *dest, unsigned int *src, int len)
+{
+	unsigned int d_pix;
+	unsigned int temp_pix;
+
+	while(len--)
+	{
+		d_pix=0;
+
+		temp_pix = (*src & RED_MASK32) + (*dest & RED_MASK32);
+		if(temp_pix > RED_MASK32) temp_pix = RED_MASK32;
+		d_pix |= temp_pix;
+	
+		temp_pix = (*src & GREEN_MASK32) + (*dest & GREEN_MASK32);
+		if(temp_pix > GREEN_MASK32)temp_pix = GREEN_MASK32;
+		d_pix |= temp_pix;
+	
+		temp_pix = (*src & BLUE_MASK32) + (*dest & BLUE_MASK32);
+		if(temp_pix > BLUE_MASK32) temp_pix = BLUE_MASK32;
+		d_pix |= temp_pix;
+	
+		*dest = d_pix;
+
+		dest++;
+		src++;
+	}
+}
+
+
+//The blending is done like _blender_trans16/15/24 in allegro. The
+//channels are spread out in a 32 bit number with room between them, so
+//all three are blended with one multiply.
+#define BLEND_SPREAD16 0x7E0F81F
+#define BLEND_SPREAD15 0x3E07C1F
+
+static void blend_row16_c(unsigned short *dest, unsigned short *src, int len, int n)
+{
+	unsigned int x, y, result;
+
+	while(len--)
+	{
+		x = (*src | (*src << 16)) & BLEND_SPREAD16;
+		y = (*dest | (*dest << 16)) & BLEND_SPREAD16;
+
+		result = ((x - y) * n / 32 + y) & BLEND_SPREAD16;
+		*dest = (result & 0xFFFF) | (result >> 16);
+
+		dest++;
+		src++;
+	}
+}
+
+
+static void blend_row15_c(unsigned short *dest, unsigned short *src, int len, int n)
+{
+	unsigned int x, y, result;
+
+	while(len--)
+	{
+		x = (*src | (*src << 16)) & BLEND_SPREAD15;
+		y = (*dest | (*dest << 16)) & BLEND_SPREAD15;
+
+		result = ((x - y) * n / 32 + y) & BLEND_SPREAD15;
+		*dest = (result & 0xFFFF) | (result >> 16);
+
+		dest++;
+		src++;
+	}
+}
+
+
+//red and blue are blended together and green on its own
+static void blend_row32_c(unsigned int *dest, unsigned int *src, int len, int n)
+{
+	unsigned int rb, g;
+
+	while(len--)
+	{
+		rb = ((*src & 0xFF00FF) - (*dest & 0xFF00FF)) * n / 256 + *dest;
+		g = ((*src & 0xFF00) - (*dest & 0xFF00)) * n / 256 + (*dest & 0xFF00);
+
+		*dest = (rb & 0xFF00FF) | (g & 0xFF00);
+
+		dest++;
+		src++;
+	}
+}
+
+
+//the channels are expanded to 8 bits like getr() does
+#define EXPAND5(c) (((c)<<3) | ((c)>>2))
+#define EXPAND6(c) (((c)<<2) | ((c)>>4))
+
+static void convert_row16_c(unsigned int *dest, unsigned short *src, int len)
+{
+	while(len--)
+	{
+		*dest = (EXPAND5(*src >> 11) << 16) | (EXPAND6((*src >> 5) & 63) << 8) | EXPAND5(*src & 31);
+
+		dest++;
+		src++;
+	}
+}
+
+
+static void convert_row15_c(unsigned int *dest, unsigned short *src, int len)
+{
+	while(len--)
+	{
+		*dest = (EXPAND5((*src >> 10) & 31) << 16) | (EXPAND5((*src >> 5) & 31) << 8) | EXPAND5(*src & 31);
+
+		dest++;
+		src++;
+	}
+}
+
+
+static void scale_row32_c(unsigned int *dest, unsigned int *src, int len, int scale)
+{
+	int i;
+
+	while(len--)
+	{
+		for(i=0;i<scale;i++)
+			dest[i] = *src;
+
+		dest+=scale;
+		src++;
+	}
+}
+
+
+
+#ifdef USE_X86_SIMD
+
+/////////////////////////////////////////////////
+////////// SSE2 /////////////////////////////////
+/////////////////////////////////////////////////
+
+//Shades 8 channels. c8 is the channel as 0-255, l the light level and
+//d is (l*65536)%31 spread out (0,1 or 2), since itofix(l)/31 = l*2114+d.
+//The 32 bit product is made from two 16 bit halves.
+SIMD_FUNC("sse2") static inline __m128i light_channel_sse2(__m128i c8, __m128i l, __m128i d)
+{
+	const __m128i k = _mm_set1_epi16(2114);
+	const __m128i sign = _mm_set1_epi16((short)0x8000);
+	__m128i q, lo, hi, sum;
+
+	q = _mm_mullo_epi16(c8, l);
+	lo = _mm_mullo_epi16(q, k);
+	hi = _mm_mulhi_epu16(q, k);
+
+	sum = _mm_add_epi16(lo, _mm_mullo_epi16(c8, d));
+
+	//carry out of the low half, then the rounding of fixtoi
+	hi = _mm_sub_epi16(hi, _mm_cmplt_epi16(_mm_xor_si128(sum, sign), _mm_xor_si128(lo, sign)));
+	hi = _mm_add_epi16(hi, _mm_srli_epi16(sum, 15));
+
+	return hi;
+}
+
+SIMD_FUNC("sse2") static inline __m128i light_8_pixels_sse2(__m128i pix, __m128i l, int depth)
+{
+	const __m128i mask5 = _mm_set1_epi16(31);
+	const __m128i mask6 = _mm_set1_epi16(63);
+	__m128i d, r, g, b;
+
+	d = _mm_sub_epi16(_mm_srli_epi16(l, 4), _mm_cmpeq_epi16(l, _mm_set1_epi16(31)));
+
+	if(depth==16)
+	{
+		r = _mm_srli_epi16(pix, 11);
+		g = _mm_and_si128(_mm_srli_epi16(pix, 5), mask6);
+		g = _mm_or_si128(_mm_slli_epi16(g, 2), _mm_srli_epi16(g, 4));
+	}
+	else
+	{
+		r = _mm_and_si128(_mm_srli_epi16(pix, 10), mask5);
+		g = _mm_and_si128(_mm_srli_epi16(pix, 5), mask5);
+		g = _mm_or_si128(_mm_slli_epi16(g, 3), _mm_srli_epi16(g, 2));
+	}
+	b = _mm_and_si128(pix, mask5);
+
+	r = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+	b = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+
+	r = _mm_srli_epi16(light_channel_sse2(r, l, d), 3);
+	b = _mm_srli_epi16(light_channel_sse2(b, l, d), 3);
+
+	if(depth==16)
+	{
+		g = _mm_srli_epi16(light_channel_sse2(g, l, d), 2);
+		return _mm_or_si128(_mm_or_si128(_mm_slli_epi16(r, 11), _mm_slli_epi16(g, 5)), b);
+	}
+	else
+	{
+		g = _mm_srli_epi16(light_channel_sse2(g, l, d), 3);
+		return _mm_or_si128(_mm_or_si128(_mm_slli_epi16(r, 10), _mm_slli_epi16(g, 5)), b);
+	}
+}
+
+SIMD_FUNC("sse2") static void light_row16_sse2(unsigned short *dest, unsigned char *light, int len)
+{
+	__m128i pix, l;
+
+	for(;len>=8;len-=8)
+	{
+		pix = _mm_loadu_si128((__m128i*)dest);
+		l = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)light), _mm_setzero_si128());
+
+		_mm_storeu_si128((__m128i*)dest, light_8_pixels_sse2(pix, l, 16));
+
+		dest+=8;
+		light+=8;
+	}
+
+	light_row16_c(dest, light, len);
+}
+
+SIMD_FUNC("sse2") static void light_row15_sse2(unsigned short *dest, unsigned char *light, int len)
+{
+	__m128i pix, l;
+
+	for(;len>=8;len-=8)
+	{
+		pix = _mm_loadu_si128((__m128i*)dest);
+		l = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)light), _mm_setzero_si128());
+
+		_mm_storeu_si128((__m128i*)dest, light_8_pixels_sse2(pix, l, 15));
+
+		dest+=8;
+		light+=8;
+	}
+
+	light_row15_c(dest, light, len);
+}
+
+//4 pixels, the channels are spread out to 16 bits and each gets the
+//light of its pixel
+SIMD_FUNC("sse2") static void light_row32_sse2(unsigned int *dest, unsigned char *light, int len)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i rgb = _mm_set1_epi32(0xffffff);
+	__m128i pix, l, l_lo, l_hi, d_lo, d_hi, lo, hi;
+
+	for(;len>=4;len-=4)
+	{
+		pix = _mm_loadu_si128((__m128i*)dest);
+
+		l = _mm_cvtsi32_si128(*(int*)light);
+		l = _mm_unpacklo_epi8(l, l);
+		l = _mm_unpacklo_epi16(l, l);
+		l_lo = _mm_unpacklo_epi8(l, zero);
+		l_hi = _mm_unpackhi_epi8(l, zero);
+
+		d_lo = _mm_sub_epi16(_mm_srli_epi16(l_lo, 4), _mm_cmpeq_epi16(l_lo, _mm_set1_epi16(31)));
+		d_hi = _mm_sub_epi16(_mm_srli_epi16(l_hi, 4), _mm_cmpeq_epi16(l_hi, _mm_set1_epi16(31)));
+
+		lo = light_channel_sse2(_mm_unpacklo_epi8(pix, zero), l_lo, d_lo);
+		hi = light_channel_sse2(_mm_unpackhi_epi8(pix, zero), l_hi, d_hi);
+
+		_mm_storeu_si128((__m128i*)dest, _mm_and_si128(_mm_packus_epi16(lo, hi), rgb));
+
+		dest+=4;
+		light+=4;
+	}
+
+	light_row32_c(dest, light, len);
+}
+
+
+SIMD_FUNC("sse2") static void lightmap_row_sse2(unsigned char *dest, unsigned char *src, int len)
+{
+	const __m128i max = _mm_set1_epi8(31);
+	__m128i d;
+
+	for(;len>=16;len-=16)
+	{
+		d = _mm_adds_epu8(_mm_loadu_si128((__m128i*)dest), _mm_loadu_si128((__m128i*)src));
+		_mm_storeu_si128((__m128i*)dest, _mm_min_epu8(d, max));
+
+		dest+=16;
+		src+=16;
+	}
+
+	lightmap_row_c(dest, src, len);
+}
+
+
+//the channels are added as 16 bit numbers so they can't overflow
+SIMD_FUNC("sse2") static inline __m128i additive_8_pixels_sse2(__m128i s, __m128i d, int depth)
+{
+	const __m128i mask5 = _mm_set1_epi16(31);
+	const __m128i mask6 = _mm_set1_epi16(63);
+	__m128i r, g, b;
+
+	if(depth==16)
+	{
+		r = _mm_add_epi16(_mm_srli_epi16(s, 11), _mm_srli_epi16(d, 11));
+		g = _mm_add_epi16(_mm_and_si128(_mm_srli_epi16(s, 5), mask6), _mm_and_si128(_mm_srli_epi16(d, 5), mask6));
+		g = _mm_min_epi16(g, mask6);
+	}
+	else
+	{
+		r = _mm_add_epi16(_mm_and_si128(_mm_srli_epi16(s, 10), mask5), _mm_and_si128(_mm_srli_epi16(d, 10), mask5));
+		g = _mm_add_epi16(_mm_and_si128(_mm_srli_epi16(s, 5), mask5), _mm_and_si128(_mm_srli_epi16(d, 5), mask5));
+		g = _mm_min_epi16(g, mask5);
+	}
+	b = _mm_add_epi16(_mm_and_si128(s, mask5), _mm_and_si128(d, mask5));
+
+	r = _mm_min_epi16(r, mask5);
+	b = _mm_min_epi16(b, mask5);
+
+	if(depth==16)
+		return _mm_or_si128(_mm_or_si128(_mm_slli_epi16(r, 11), _mm_slli_epi16(g, 5)), b);
+	else
+		return _mm_or_si128(_mm_or_si128(_mm_slli_epi16(r, 10), _mm_slli_epi16(g, 5)), b);
+}
+
+SIMD_FUNC("sse2") static void additive_row16_sse2(unsigned short *dest, unsigned short *src, int len)
+{
+	__m128i s, d;
+
+	for(;len>=8;len-=8)
+	{
+		s = _mm_loadu_si128((__m128i*)src);
+		d = _mm_loadu_si128((__m128i*)dest);
+
+		_mm_storeu_si128((__m128i*)dest, additive_8_pixels_sse2(s, d, 16));
+
+		dest+=8;
+		src+=8;
+	}
+
+	additive_row16_c(dest, src, len);
+}
+
+SIMD_FUNC("sse2") static void additive_row32_sse2(unsigned int *dest, unsigned int *src, int len)
+{
+	const __m128i rgb = _mm_set1_epi32(0xffffff);
+	__m128i d;
+
+	for(;len>=4;len-=4)
+	{
+		d = _mm_adds_epu8(_mm_loadu_si128((__m128i*)dest), _mm_loadu_si128((__m128i*)src));
+		_mm_storeu_si128((__m128i*)dest, _mm_and_si128(d, rgb));
+
+		dest+=4;
+		src+=4;
+	}
+
+	additive_row32_c(dest, src, len);
+}
+
+SIMD_FUNC("sse2") static void additive_row15_sse2(unsigned short *dest, unsigned short *src, int len)
+{
+	__m128i s, d, skip;
+
+	for(;len>=8;len-=8)
+	{
+		s = _mm_loadu_si128((__m128i*)src);
+		d = _mm_loadu_si128((__m128i*)dest);
+		skip = _mm_cmpeq_epi16(s, _mm_setzero_si128());
+
+		_mm_storeu_si128((__m128i*)dest, _mm_or_si128(_mm_and_si128(skip, d), _mm_andnot_si128(skip, additive_8_pixels_sse2(s, d, 15))));
+
+		dest+=8;
+		src+=8;
+	}
+
+	additive_row15_c(dest, src, len);
+}
+
+
+
+//sse2 has no 32 bit multiply that keeps the low half, so the even and
+//odd lanes are multiplied as 64 bit and put back together
+SIMD_FUNC("sse2") static inline __m128i mullo_epi32_sse2(__m128i a, __m128i b)
+{
+	__m128i even = _mm_mul_epu32(a, b);
+	__m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0,0,2,0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0,0,2,0)));
+}
+
+//4 spread out pixels in 32 bit lanes, blended and put back in 16 bits
+SIMD_FUNC("sse2") static inline __m128i blend_4_pixels_sse2(__m128i x, __m128i y, __m128i n, __m128i spread)
+{
+	__m128i result;
+
+	x = _mm_and_si128(x, spread);
+	y = _mm_and_si128(y, spread);
+
+	result = _mm_srli_epi32(mullo_epi32_sse2(_mm_sub_epi32(x, y), n), 5);
+	result = _mm_and_si128(_mm_add_epi32(result, y), spread);
+	result = _mm_or_si128(result, _mm_srli_epi32(result, 16));
+
+	//keep the low 16 bits as a signed number, so that packs doesn't cut it
+	return _mm_srai_epi32(_mm_slli_epi32(result, 16), 16);
+}
+
+SIMD_FUNC("sse2") static inline __m128i blend_8_pixels_sse2(__m128i s, __m128i d, __m128i n, __m128i spread)
+{
+	__m128i lo, hi;
+
+	lo = blend_4_pixels_sse2(_mm_unpacklo_epi16(s, s), _mm_unpacklo_epi16(d, d), n, spread);
+	hi = blend_4_pixels_sse2(_mm_unpackhi_epi16(s, s), _mm_unpackhi_epi16(d, d), n, spread);
+
+	return _mm_packs_epi32(lo, hi);
+}
+
+SIMD_FUNC("sse2") static void blend_row16_sse2(unsigned short *dest, unsigned short *src, int len, int n)
+{
+	const __m128i spread = _mm_set1_epi32(BLEND_SPREAD16);
+	const __m128i n4 = _mm_set1_epi32(n);
+
+	for(;len>=8;len-=8)
+	{
+		_mm_storeu_si128((__m128i*)dest, blend_8_pixels_sse2(_mm_loadu_si128((__m128i*)src), _mm_loadu_si128((__m128i*)dest), n4, spread));
+
+		dest+=8;
+		src+=8;
+	}
+
+	blend_row16_c(dest, src, len, n);
+}
+
+SIMD_FUNC("sse2") static void blend_row15_sse2(unsigned short *dest, unsigned short *src, int len, int n)
+{
+	const __m128i spread = _mm_set1_epi32(BLEND_SPREAD15);
+	const __m128i n4 = _mm_set1_epi32(n);
+
+	for(;len>=8;len-=8)
+	{
+		_mm_storeu_si128((__m128i*)dest, blend_8_pixels_sse2(_mm_loadu_si128((__m128i*)src), _mm_loadu_si128((__m128i*)dest), n4, spread));
+
+		dest+=8;
+		src+=8;
+	}
+
+	blend_row15_c(dest, src, len, n);
+}
+
+SIMD_FUNC("sse2") static void blend_row32_sse2(unsigned int *dest, unsigned int *src, int len, int n)
+{
+	const __m128i rb_mask = _mm_set1_epi32(0xFF00FF);
+	const __m128i g_mask = _mm_set1_epi32(0xFF00);
+	const __m128i n4 = _mm_set1_epi32(n);
+	__m128i s, d, rb, g;
+
+	for(;len>=4;len-=4)
+	{
+		s = _mm_loadu_si128((__m128i*)src);
+		d = _mm_loadu_si128((__m128i*)dest);
+
+		rb = _mm_sub_epi32(_mm_and_si128(s, rb_mask), _mm_and_si128(d, rb_mask));
+		rb = _mm_add_epi32(_mm_srli_epi32(mullo_epi32_sse2(rb, n4), 8), d);
+
+		g = _mm_sub_epi32(_mm_and_si128(s, g_mask), _mm_and_si128(d, g_mask));
+		g = _mm_add_epi32(_mm_srli_epi32(mullo_epi32_sse2(g, n4), 8), _mm_and_si128(d, g_mask));
+
+		_mm_storeu_si128((__m128i*)dest, _mm_or_si128(_mm_and_si128(rb, rb_mask), _mm_and_si128(g, g_mask)));
+
+		dest+=4;
+		src+=4;
+	}
+
+	blend_row32_c(dest, src, len, n);
+}
+
+
+
+//8 pixels to 0RGB, the 8 bit channels are made in 16 bit lanes and
+//then woven together as blue+green and red.
+SIMD_FUNC("sse2") static inline void convert_8_pixels_sse2(unsigned int *dest, __m128i pix, int depth)
+{
+	const __m128i mask5 = _mm_set1_epi16(31);
+	const __m128i mask6 = _mm_set1_epi16(63);
+	__m128i r, g, b, gb;
+
+	if(depth==16)
+	{
+		r = _mm_srli_epi16(pix, 11);
+		g = _mm_and_si128(_mm_srli_epi16(pix, 5), mask6);
+		g = _mm_or_si128(_mm_slli_epi16(g, 2), _mm_srli_epi16(g, 4));
+	}
+	else
+	{
+		r = _mm_and_si128(_mm_srli_epi16(pix, 10), mask5);
+		g = _mm_and_si128(_mm_srli_epi16(pix, 5), mask5);
+		g = _mm_or_si128(_mm_slli_epi16(g, 3), _mm_srli_epi16(g, 2));
+	}
+	b = _mm_and_si128(pix, mask5);
+
+	r = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+	b = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+
+	gb = _mm_or_si128(b, _mm_slli_epi16(g, 8));
+
+	_mm_storeu_si128((__m128i*)dest, _mm_unpacklo_epi16(gb, r));
+	_mm_storeu_si128((__m128i*)(dest+4), _mm_unpackhi_epi16(gb, r));
+}
+
+
+SIMD_FUNC("sse2") static void convert_row16_sse2(unsigned int *dest, unsigned short *src, int len)
+{
+	for(;len>=8;len-=8)
+	{
+		convert_8_pixels_sse2(dest, _mm_loadu_si128((__m128i*)src), 16);
+
+		dest+=8;
+		src+=8;
+	}
+
+	convert_row16_c(dest, src, len);
+}
+
+
+SIMD_FUNC("sse2") static void convert_row15_sse2(unsigned int *dest, unsigned short *src, int len)
+{
+	for(;len>=8;len-=8)
+	{
+		convert_8_pixels_sse2(dest, _mm_loadu_si128((__m128i*)src), 15);
+
+		dest+=8;
+		src+=8;
+	}
+
+	convert_row15_c(dest, src, len);
+}
+
+
+//4 pixels at a time are shuffled into 2, 3 or 4 vectors. other scales
+//are done by the plain C loop.
+SIMD_FUNC("sse2") static void scale_row32_sse2(unsigned int *dest, unsigned int *src, int len, int scale)
+{
+	__m128i s;
+
+	if(scale==2)
+	{
+		for(;len>=4;len-=4)
+		{
+			s = _mm_loadu_si128((__m128i*)src);
+			_mm_storeu_si128((__m128i*)dest, _mm_unpacklo_epi32(s, s));
+			_mm_storeu_si128((__m128i*)(dest+4), _mm_unpackhi_epi32(s, s));
+
+			dest+=8;
+			src+=4;
+		}
+	}
+	else if(scale==3)
+	{
+		for(;len>=4;len-=4)
+		{
+			s = _mm_loadu_si128((__m128i*)src);
+			_mm_storeu_si128((__m128i*)dest, _mm_shuffle_epi32(s, _MM_SHUFFLE(1,0,0,0)));
+			_mm_storeu_si128((__m128i*)(dest+4), _mm_shuffle_epi32(s, _MM_SHUFFLE(2,2,1,1)));
+			_mm_storeu_si128((__m128i*)(dest+8), _mm_shuffle_epi32(s, _MM_SHUFFLE(3,3,3,2)));
+
+			dest+=12;
+			src+=4;
+		}
+	}
+	else if(scale==4)
+	{
+		for(;len>=4;len-=4)
+		{
+			s = _mm_loadu_si128((__m128i*)src);
+			_mm_storeu_si128((__m128i*)dest, _mm_shuffle_epi32(s, _MM_SHUFFLE(0,0,0,0)));
+			_mm_storeu_si128((__m128i*)(dest+4), _mm_shuffle_epi32(s, _MM_SHUFFLE(1,1,1,1)));
+			_mm_storeu_si128((__m128i*)(dest+8), _mm_shuffle_epi32(s, _MM_SHUFFLE(2,2,2,2)));
+			_mm_storeu_si128((__m128i*)(dest+12), _mm_shuffle_epi32(s, _MM_SHUFFLE(3,3,3,3)));
+
+			dest+=16;
+			src+=4;
+		}
+	}
+
+	scale_row32_c(dest, src, len, scale);
+}
+
+
+
+/////////////////////////////////////////////////
+////////// AVX2 /////////////////////////////////
+/////////////////////////////////////////////////
+
+//same as the sse2 version but 16 pixels at a time
+
+SIMD_FUNC("avx2") static inline __m256i light_channel_avx2(__m256i c8, __m256i l, __m256i d)
+{
+	const __m256i k = _mm256_set1_epi16(2114);
+	const __m256i sign = _mm256_set1_epi16((short)0x8000);
+	__m256i q, lo, hi, sum;
+
+	q = _mm256_mullo_epi16(c8, l);
+	lo = _mm256_mullo_epi16(q, k);
+	hi = _mm256_mulhi_epu16(q, k);
+
+	sum = _mm256_add_epi16(lo, _mm256_mullo_epi16(c8, d));
+
+	hi = _mm256_sub_epi16(hi, _mm256_cmpgt_epi16(_mm256_xor_si256(lo, sign), _mm256_xor_si256(sum, sign)));
+	hi = _mm256_add_epi16(hi, _mm256_srli_epi16(sum, 15));
+
+	return hi;
+}
+
+SIMD_FUNC("avx2") static inline __m256i light_16_pixels_avx2(__m256i pix, __m256i l, int depth)
+{
+	const __m256i mask5 = _mm256_set1_epi16(31);
+	const __m256i mask6 = _mm256_set1_epi16(63);
+	__m256i d, r, g, b;
+
+	d = _mm256_sub_epi16(_mm256_srli_epi16(l, 4), _mm256_cmpeq_epi16(l, _mm256_set1_epi16(31)));
+
+	if(depth==16)
+	{
+		r = _mm256_srli_epi16(pix, 11);
+		g = _mm256_and_si256(_mm256_srli_epi16(pix, 5), mask6);
+		g = _mm256_or_si256(_mm256_slli_epi16(g, 2), _mm256_srli_epi16(g, 4));
+	}
+	else
+	{
+		r = _mm256_and_si256(_mm256_srli_epi16(pix, 10), mask5);
+		g = _mm256_and_si256(_mm256_srli_epi16(pix, 5), mask5);
+		g = _mm256_or_si256(_mm256_slli_epi16(g, 3), _mm256_srli_epi16(g, 2));
+	}
+	b = _mm256_and_si256(pix, mask5);
+
+	r = _mm256_or_si256(_mm256_slli_epi16(r, 3), _mm256_srli_epi16(r, 2));
+	b = _mm256_or_si256(_mm256_slli_epi16(b, 3), _mm256_srli_epi16(b, 2));
+
+	r = _mm256_srli_epi16(light_channel_avx2(r, l, d), 3);
+	b = _mm256_srli_epi16(light_channel_avx2(b, l, d), 3);
+
+	if(depth==16)
+	{
+		g = _mm256_srli_epi16(light_channel_avx2(g, l, d), 2);
+		return _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi16(r, 11), _mm256_slli_epi16(g, 5)), b);
+	}
+	else
+	{
+		g = _mm256_srli_epi16(light_channel_avx2(g, l, d), 3);
+		return _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi16(r, 10), _mm256_slli_epi16(g, 5)), b);
+	}
+}
+
+SIMD_FUNC("avx2") static void light_row16_avx2(unsigned short *dest, unsigned char *light, int len)
+{
+	__m256i pix, l;
+
+	for(;len>=16;len-=16)
+	{
+		pix = _mm256_loadu_si256((__m256i*)dest);
+		l = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i*)light));
+
+		_mm256_storeu_si256((__m256i*)dest, light_16_pixels_avx2(pix, l, 16));
+
+		dest+=16;
+		light+=16;
+	}
+
+	light_row16_sse2(dest, light, len);
+}
+
+SIMD_FUNC("avx2") static void light_row15_avx2(unsigned short *dest, unsigned char *light, int len)
+{
+	__m256i pix, l;
+
+	for(;len>=16;len-=16)
+	{
+		pix = _mm256_loadu_si256((__m256i*)dest);
+		l = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i*)light));
+
+		_mm256_storeu_si256((__m256i*)dest, light_16_pixels_avx2(pix, l, 15));
+
+		dest+=16;
+		light+=16;
+	}
+
+	light_row15_sse2(dest, light, len);
+}
+
+//the unpacks work on each 128 bit half, so the lights of pixels 0-3 and
+//4-7 are put in the low and high half before they are spread out.
+SIMD_FUNC("avx2") static void light_row32_avx2(unsigned int *dest, unsigned char *light, int len)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i rgb = _mm256_set1_epi32(0xffffff);
+	__m256i pix, l, l_lo, l_hi, d_lo, d_hi, lo, hi;
+
+	for(;len>=8;len-=8)
+	{
+		pix = _mm256_loadu_si256((__m256i*)dest);
+
+		l = _mm256_setr_epi32(*(int*)light, 0, 0, 0, *(int*)(light+4), 0, 0, 0);
+		l = _mm256_unpacklo_epi8(l, l);
+		l = _mm256_unpacklo_epi16(l, l);
+		l_lo = _mm256_unpacklo_epi8(l, zero);
+		l_hi = _mm256_unpackhi_epi8(l, zero);
+
+		d_lo = _mm256_sub_epi16(_mm256_srli_epi16(l_lo, 4), _mm256_cmpeq_epi16(l_lo, _mm256_set1_epi16(31)));
+		d_hi = _mm256_sub_epi16(_mm256_srli_epi16(l_hi, 4), _mm256_cmpeq_epi16(l_hi, _mm256_set1_epi16(31)));
+
+		lo = light_channel_avx2(_mm256_unpacklo_epi8(pix, zero), l_lo, d_lo);
+		hi = light_channel_avx2(_mm256_unpackhi_epi8(pix, zero), l_hi, d_hi);
+
+		_mm256_storeu_si256((__m256i*)dest, _mm256_and_si256(_mm256_packus_epi16(lo, hi), rgb));
+
+		dest+=8;
+		light+=8;
+	}
+
+	light_row32_sse2(dest, light, len);
+}
+
+
+SIMD_FUNC("avx2") static void lightmap_row_avx2(unsigned char *dest, unsigned char *src, int len)
+{
+	const __m256i max = _mm256_set1_epi8(31);
+	__m256i d;
+
+	for(;len>=32;len-=32)
+	{
+		d = _mm256_adds_epu8(_mm256_loadu_si256((__m256i*)dest), _mm256_loadu_si256((__m256i*)src));
+		_mm256_storeu_si256((__m256i*)dest, _mm256_min_epu8(d, max));
+
+		dest+=32;
+		src+=32;
+	}
+
+	lightmap_row_sse2(dest, src, len);
+}
+
+
+SIMD_FUNC("avx2") static inline __m256i additive_16_pixels_avx2(__m256i s, __m256i d, int depth)
+{
+	const __m256i mask5 = _mm256_set1_epi16(31);
+	const __m256i mask6 = _mm256_set1_epi16(63);
+	__m256i r, g, b;
+
+	if(depth==16)
+	{
+		r = _mm256_add_epi16(_mm256_srli_epi16(s, 11), _mm256_srli_epi16(d, 11));
+		g = _mm256_add_epi16(_mm256_and_si256(_mm256_srli_epi16(s, 5), mask6), _mm256_and_si256(_mm256_srli_epi16(d, 5), mask6));
+		g = _mm256_min_epi16(g, mask6);
+	}
+	else
+	{
+		r = _mm256_add_epi16(_mm256_and_si256(_mm256_srli_epi16(s, 10), mask5), _mm256_and_si256(_mm256_srli_epi16(d, 10), mask5));
+		g = _mm256_add_epi16(_mm256_and_si256(_mm256_srli_epi16(s, 5), mask5), _mm256_and_si256(_mm256_srli_epi16(d, 5), mask5));
+		g = _mm256_min_epi16(g, mask5);
+	}
+	b = _mm256_add_epi16(_mm256_and_si256(s, mask5), _mm256_and_si256(d, mask5));
+
+	r = _mm256_min_epi16(r, mask5);
+	b = _mm256_min_epi16(b, mask5);
+
+	if(depth==16)
+		return _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi16(r, 11), _mm256_slli_epi16(g, 5)), b);
+	else
+		return _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi16(r, 10), _mm256_slli_epi16(g, 5)), b);
+}
+
+SIMD_FUNC("avx2") static void additive_row16_avx2(unsigned short *dest, unsigned short *src, int len)
+{
+	__m256i s, d;
+
+	for(;len>=16;len-=16)
+	{
+		s = _mm256_loadu_si256((__m256i*)src);
+		d = _mm256_loadu_si256((__m256i*)dest);
+
+		_mm256_storeu_si256((__m256i*)dest, additive_16_pixels_avx2(s, d, 16));
+
+		dest+=16;
+		src+=16;
+	}
+
+	additive_row16_sse2(dest, src, len);
+}
+
+SIMD_FUNC("avx2") static void additive_row32_avx2(unsigned int *dest, unsigned int *src, int len)
+{
+	const __m256i rgb = _mm256_set1_epi32(0xffffff);
+	__m256i d;
+
+	for(;len>=8;len-=8)
+	{
+		d = _mm256_adds_epu8(_mm256_loadu_si256((__m256i*)dest), _mm256_loadu_si256((__m256i*)src));
+		_mm256_storeu_si256((__m256i*)dest, _mm256_and_si256(d, rgb));
+
+		dest+=8;
+		src+=8;
+	}
+
+	additive_row32_sse2(dest, src, len);
+}
+
+SIMD_FUNC("avx2") static void additive_row15_avx2(unsigned short *dest, unsigned short *src, int len)
+{
+	__m256i s, d, skip;
+
+	for(;len>=16;len-=16)
+	{
+		s = _mm256_loadu_si256((__m256i*)src);
+		d = _mm256_loadu_si256((__m256i*)dest);
+		skip = _mm256_cmpeq_epi16(s, _mm256_setzero_si256());
+
+		_mm256_storeu_si256((__m256i*)dest, _mm256_blendv_epi8(additive_16_pixels_avx2(s, d, 15), d, skip));
+
+		dest+=16;
+		src+=16;
+	}
+
+	additive_row15_sse2(dest, src, len);
+}
+
+
+SIMD_FUNC("avx2") static inline __m256i blend_8_pixels_avx2(__m256i x, __m256i y, __m256i n, __m256i spread)
+{
+	__m256i result;
+
+	x = _mm256_and_si256(x, spread);
+	y = _mm256_and_si256(y, spread);
+
+	result = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_sub_epi32(x, y), n), 5);
+	result = _mm256_and_si256(_mm256_add_epi32(result, y), spread);
+	result = _mm256_or_si256(result, _mm256_srli_epi32(result, 16));
+
+	return _mm256_srai_epi32(_mm256_slli_epi32(result, 16), 16);
+}
+
+//the unpacks and the pack work on each 128 bit half, so the pixels end
+//up in the order they started in
+SIMD_FUNC("avx2") static inline __m256i blend_16_pixels_avx2(__m256i s, __m256i d, __m256i n, __m256i spread)
+{
+	__m256i lo, hi;
+
+	lo = blend_8_pixels_avx2(_mm256_unpacklo_epi16(s, s), _mm256_unpacklo_epi16(d, d), n, spread);
+	hi = blend_8_pixels_avx2(_mm256_unpackhi_epi16(s, s), _mm256_unpackhi_epi16(d, d), n, spread);
+
+	return _mm256_packs_epi32(lo, hi);
+}
+
+SIMD_FUNC("avx2") static void blend_row16_avx2(unsigned short *dest, unsigned short *src, int len, int n)
+{
+	const __m256i spread = _mm256_set1_epi32(BLEND_SPREAD16);
+	const __m256i n8 = _mm256_set1_epi32(n);
+
+	for(;len>=16;len-=16)
+	{
+		_mm256_storeu_si256((__m256i*)dest, blend_16_pixels_avx2(_mm256_loadu_si256((__m256i*)src), _mm256_loadu_si256((__m256i*)dest), n8, spread));
+
+		dest+=16;
+		src+=16;
+	}
+
+	blend_row16_sse2(dest, src, len, n);
+}
+
+SIMD_FUNC("avx2") static void blend_row15_avx2(unsigned short *dest, unsigned short *src, int len, int n)
+{
+	const __m256i spread = _mm256_set1_epi32(BLEND_SPREAD15);
+	const __m256i n8 = _mm256_set1_epi32(n);
+
+	for(;len>=16;len-=16)
+	{
+		_mm256_storeu_si256((__m256i*)dest, blend_16_pixels_avx2(_mm256_loadu_si256((__m256i*)src), _mm256_loadu_si256((__m256i*)dest), n8, spread));
+
+		dest+=16;
+		src+=16;
+	}
+
+	blend_row15_sse2(dest, src, len, n);
+}
+
+SIMD_FUNC("avx2") static void blend_row32_avx2(unsigned int *dest, unsigned int *src, int len, int n)
+{
+	const __m256i rb_mask = _mm256_set1_epi32(0xFF00FF);
+	const __m256i g_mask = _mm256_set1_epi32(0xFF00);
+	const __m256i n8 = _mm256_set1_epi32(n);
+	__m256i s, d, rb, g;
+
+	for(;len>=8;len-=8)
+	{
+		s = _mm256_loadu_si256((__m256i*)src);
+		d = _mm256_loadu_si256((__m256i*)dest);
+
+		rb = _mm256_sub_epi32(_mm256_and_si256(s, rb_mask), _mm256_and_si256(d, rb_mask));
+		rb = _mm256_add_epi32(_mm256_srli_epi32(_mm256_mullo_epi32(rb, n8), 8), d);
+
+		g = _mm256_sub_epi32(_mm256_and_si256(s, g_mask), _mm256_and_si256(d, g_mask));
+		g = _mm256_add_epi32(_mm256_srli_epi32(_mm256_mullo_epi32(g, n8), 8), _mm256_and_si256(d, g_mask));
+
+		_mm256_storeu_si256((__m256i*)dest, _mm256_or_si256(_mm256_and_si256(rb, rb_mask), _mm256_and_si256(g, g_mask)));
+
+		dest+=8;
+		src+=8;
+	}
+
+	blend_row32_sse2(dest, src, len, n);
+}
+
+
+//8 pixels are spread over scale vectors, each made with a permute
+//that picks pixel (v*8+i)/scale for place i of vector v. scales up to
+//8 are done this way.
+SIMD_FUNC("avx2") static void scale_row32_avx2(unsigned int *dest, unsigned int *src, int len, int scale)
+{
+	__m256i index[8];
+	int pick[8];
+	__m256i s;
+	int i, v;
+
+	if(scale<2 || scale>8)
+	{
+		scale_row32_c(dest, src, len, scale);
+		return;
+	}
+
+	for(v=0;v<scale;v++)
+	{
+		for(i=0;i<8;i++)
+			pick[i] = (v*8+i)/scale;
+
+		index[v] = _mm256_loadu_si256((__m256i*)pick);
+	}
+
+	for(;len>=8;len-=8)
+	{
+		s = _mm256_loadu_si256((__m256i*)src);
+
+		for(v=0;v<scale;v++)
+			_mm256_storeu_si256((__m256i*)(dest+v*8), _mm256_permutevar8x32_epi32(s, index[v]));
+
+		dest+=8*scale;
+		src+=8;
+	}
+
+	scale_row32_sse2(dest, src, len, scale);
+}
+
+#endif
+
+
+
+/////////////////////////////////////////////////
+////////// SETUP ////////////////////////////////
+/////////////////////////////////////////////////
+
+//use the given simd level, or the best one below it that the cpu has.
+//returns the level that is used.
+int set_draw_simd_level(int level)
+{
+	int best=DRAW_SIMD_NONE;
+
+#ifdef USE_X86_SIMD
+	__builtin_cpu_init();
+
+	if(__builtin_cpu_supports("sse2"))
+		best = DRAW_SIMD_SSE2;
+	if(__builtin_cpu_supports("avx2"))
+		best = DRAW_SIMD_AVX2;
+#endif
+
+	if(level>best)
+		level = best;
+	if(level<DRAW_SIMD_NONE)
+		level = DRAW_SIMD_NONE;
+
+	light_row16 = light_row16_c;
+	light_row15 = light_row15_c;
+	light_row32 = light_row32_c;
+	lightmap_row = lightmap_row_c;
+	additive_row16 = additive_row16_c;
+	additive_row15 = additive_row15_c;
+	additive_row32 = additive_row32_c;
+	blend_row16 = blend_row16_c;
+	blend_row15 = blend_row15_c;
+	blend_row32 = blend_row32_c;
+	convert_row16 = convert_row16_c;
+	convert_row15 = convert_row15_c;
+	scale_row32 = scale_row32_c;
+
+#ifdef USE_X86_SIMD
+	if(level>=DRAW_SIMD_SSE2)
+	{
+		convert_row16 = convert_row16_sse2;
+		convert_row15 = convert_row15_sse2;
+		scale_row32 = scale_row32_sse2;
+		light_row16 = light_row16_sse2;
+		light_row15 = light_row15_sse2;
+		light_row32 = light_row32_sse2;
+		lightmap_row = lightmap_row_sse2;
+		additive_row16 = additive_row16_sse2;
+		additive_row15 = additive_row15_sse2;
+		additive_row32 = additive_row32_sse2;
+		blend_row16 = blend_row16_sse2;
+		blend_row15 = blend_row15_sse2;
+		blend_row32 = blend_row32_sse2;
+	}
+	if(level>=DRAW_SIMD_AVX2)
+	{
+		light_row16 = light_row16_avx2;
+		light_row15 = light_row15_avx2;
+		light_row32 = light_row32_avx2;
+		lightmap_row = lightmap_row_avx2;
+		additive_row16 = additive_row16_avx2;
+		additive_row15 = additive_row15_avx2;
+		additive_row32 = additive_row32_avx2;
+		blend_row16 = blend_row16_avx2;
+		blend_row15 = blend_row15_avx2;
+		blend_row32 = blend_row32_avx2;
+		scale_row32 = scale_row32_avx2;
+	}
+#endif
+
+	draw_simd_level = level;
+
+	return level;
+}
+
+
+void init_draw_simd(void)
+{
+	int i,j;
+
+	for(i=0;i<32;i++)
+	{
+		light_mul[i] = (i<<16)/31;
+
+		for(j=0;j<32;j++)
+			light_scale5[i][j] = LIGHT_CHANNEL((j<<3)|(j>>2), i) >> 3;
+		for(j=0;j<64;j++)
+			light_scale6[i][j] = LIGHT_CHANNEL((j<<2)|(j>>4), i) >> 2;
+	}
+
+	set_draw_simd_level(DRAW_SIMD_AVX2);
+
+	log_info("Drawing uses %s", draw_simd_level==DRAW_SIMD_AVX2 ? "AVX2" : (draw_simd_level==DRAW_SIMD_SSE2 ? "SSE2" : "plain C"));
+}
@@ -0,0 +1,39 @@
+#ifndef DRAW_SIMD_H
+#define DRAW_SIMD_H
+
+#define DRAW_SIMD_NONE 0
+#define DRAW_SIMD_SSE2 1
+#define DRAW_SIMD_AVX2 2
+
+extern int draw_simd_level;
+
+
+//row kernels, dest pixels are shaded by a light level 0-31 per pixel
+extern void (*light_row16)(unsigned short *dest, unsigned char *light, int len);
+extern void (*light_row15)(unsigned short *dest, unsigned char *light, int len);
+extern void (*light_row32)(unsigned int *dest, unsigned char *light, int len);
+
+//adds light levels to a light mask, maxed at 31
+extern void (*lightmap_row)(unsigned char *dest, unsigned char *src, int len);
+
+//adds colors channel by channel, each channel maxed at full
+extern void (*additive_row16)(unsigned short *dest, unsigned short *src, int len);
+extern void (*additive_row15)(unsigned short *dest, unsigned short *src, int len);
+extern void (*additive_row32)(unsigned int *dest, unsigned int *src, int len);
+
+//blends src over dest like allegro's trans blender. n is the blend
+//level, 0-32 for 16 and 15 bit and 0-256 for 32 bit
+extern void (*blend_row16)(unsigned short *dest, unsigned short *src, int len, int n);
+extern void (*blend_row15)(unsigned short *dest, unsigned short *src, int len, int n);
+extern void (*blend_row32)(unsigned int *dest, unsigned int *src, int len, int n);
+
+//16 or 15 bit pixels to 32 bit 0RGB, and 32 bit pixels made scale times as wide
+extern void (*convert_row16)(unsigned int *dest, unsigned short *src, int len);
+extern void (*convert_row15)(unsigned int *dest, unsigned short *src, int len);
+extern void (*scale_row32)(unsigned int *dest, unsigned int *src, int len, int scale);
+
+
+void init_draw_simd(void);
+int set_draw_simd_level(int level);
+
+#endif
@@ -288,7 +288,7 @@ void draw_fiend_enemy(BITMAP *dest,ENEMY_INFO *temp,int x, int y,int action,int
 	int num = temp->animation[action].frame[frame];
 		
 	//pivot_fiend_sprite(dest, temp->pic[num].data,x,y,temp->pic[num].center_x,temp->pic[num].center_y,angle,FIEND_DRAW_MODE_TRANS);
-	pivot_sprite(dest, temp->pic[num].data,x,y,temp->pic[num].center_x,temp->pic[num].center_y,degree_to_fixed(angle));
+	pivot_cached_sprite(dest, temp->pic[num].data,x,y,temp->pic[num].center_x,temp->pic[num].center_y,angle);
 	//rotate_sprite(dest, temp->pic[num].data,x-temp->pic[num].data->w/2,y-temp->pic[num].data->h/2,f_angle);
 	
 
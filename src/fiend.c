@@ -9,6 +9,11 @@
 #include "audio.h"
 #include "fiend.h"
 #include "draw.h"
+#include "tile_cache.h"
+#include "tile_plan.h"
+#include "present.h"
+#include "light_bake.h"
+#include "rotate_sprite.h"
 #include "grafik4.h"
 #include "console.h"
 #include "console_funcs.h"
@@ -30,6 +35,14 @@ int debug_is_on=0;
 int lightning_is_on=1;
 int cache_lights_is_on=0;
 
+int headless_is_on=0;//no display, everything is drawn to memory
+int benchmark_frames=0;//frames to draw and time in headless mode
+
+int view_w=480;//the size of the playfield
+int view_h=480;
+int view_x=80;//where the playfield is on the screen
+int view_y=0;
+
 int fiend_log_level=-1;  // -1 means not set via command line
 
 int fiend_sound_volume=256;
@@ -65,26 +78,42 @@ DATAFILE *font_avalon,*font_arial,*font_avalon2,*font_small1,*font_small2;
 //the error code shown when exiting the program with failure!
 char fiend_errorcode[60]="Unknown error";
 
+//where the 640x480 loading screen is, in the middle of the screen
+static int load_x=0;
+static int load_y=0;
+
+//fill the loading bar to x
+static void show_load_progress(int x)
+{
+	rectfill(screen,load_x+30+80,load_y+420,load_x+x+80,load_y+460,makecol(160,20,10));
+	present_screen();
+}
+
+
 int init_fiend2(void)
 {
 	BITMAP *bmp;
 
 	clear(screen);
 
+	load_x = (screen->w-640)/2;
+	load_y = (screen->h-480)/2;
+
 	bmp = load_bitmap("graphic/menu/menu_back.pcx",NULL);
 	
-	stretch_sprite(screen, bmp,80,60,480,200);
+	stretch_sprite(screen, bmp,load_x+80,load_y+60,480,200);
 
 	destroy_bitmap(bmp);
 
 
-	rect(screen,29+80,419,441+80,461,makecol(40,40,40));
-	rect(screen,28+80,418,442+80,462,makecol(40,40,40));
+	rect(screen,load_x+29+80,load_y+419,load_x+441+80,load_y+461,makecol(40,40,40));
+	rect(screen,load_x+28+80,load_y+418,load_x+442+80,load_y+462,makecol(40,40,40));
+	present_screen();
 	
 	
 	//init light drawing
     //csl_textout(2,"Init lightdrawing...");
-	rectfill(screen,30+80,420,65+80,460,makecol(160,20,10));
+	show_load_progress(65);
 	init_draw();
 
 	//init the gfx lib...
@@ -93,31 +122,31 @@ int init_fiend2(void)
 	
 	//Load the graphics....
 	//csl_textout(2,"Loading tile data...");
-	rectfill(screen,30+80,420,100+80,460,makecol(160,20,10));
+	show_load_progress(100);
 	if(load_tiles())return CSLMSG_QUIT;
 	//csl_textout(2,"Loading npc data...");
-	rectfill(screen,30+80,420,135+80,460,makecol(160,20,10));
+	show_load_progress(135);
 	if(load_characters())return CSLMSG_QUIT;
 	//csl_textout(2,"Loading enemy data...");
-	rectfill(screen,30+80,420,170+80,460,makecol(160,20,10));
+	show_load_progress(170);
 	if(load_enemys())return CSLMSG_QUIT;
 	//csl_textout(2,"Loading object data...");
-	rectfill(screen,30+80,420,205+80,460,makecol(160,20,10));
+	show_load_progress(205);
 	if(load_objects())return CSLMSG_QUIT;
 	//csl_textout(2,"Loading item data...");
-	rectfill(screen,30+80,420,240+80,460,makecol(160,20,10));
+	show_load_progress(240);
 	if(load_items())return CSLMSG_QUIT;
 	
 	if(sound_is_on)
 	{
 		//csl_textout(2,"Loading sound data...");
-		rectfill(screen,30+80,420,275+80,460,makecol(160,20,10));
+		show_load_progress(275);
 		if(load_sounds())return CSLMSG_QUIT;
 	}
 
 	
 	//csl_textout(2,"Loading minor data...");
-	rectfill(screen,30+80,420,310+80,460,makecol(160,20,10));
+	show_load_progress(310);
 	//Load some minor data
 	if(load_weapons())return CSLMSG_QUIT;
 	if(load_particles())return CSLMSG_QUIT;
@@ -127,7 +156,7 @@ int init_fiend2(void)
 	
 	log_info("About to draw progress bar after face loading...");
 	//csl_textout(2,"Intializing data...");
-	rectfill(screen,30+80,420,345+80,460,makecol(160,20,10));
+	show_load_progress(345);
 	log_info("Progress bar drawn successfully");
 	//Init some data...
 	init_npc_data();
@@ -139,7 +168,7 @@ int init_fiend2(void)
 	
 	
 	//csl_textout(2,"Creating effect data...");
-	rectfill(screen,30+80,420,380+80,460,makecol(160,20,10));
+	show_load_progress(380);
 	//some effect calcs
 	create_normal_lightmaps();
 	create_shadows();
@@ -147,7 +176,7 @@ int init_fiend2(void)
 	make_los_borders();
 	
 	//csl_textout(2,"Loading font data...");
-	rectfill(screen,30+80,420,415+80,460,makecol(160,20,10));
+	show_load_progress(415);
 	//Load the fonts
 	font_avalon = load_datafile("graphic/fonts/avalon.dat");
 	if(font_avalon==NULL){ 
@@ -175,7 +204,7 @@ int init_fiend2(void)
 	
 
 	//csl_textout(2,"Making map...");
-    rectfill(screen,30+80,420,440+80,460,makecol(160,20,10));
+    show_load_progress(440);
 	
 	//Make a map...
 	map = calloc(sizeof(MAP_DATA),1);
@@ -187,6 +216,8 @@ int init_fiend2(void)
 
 int init_fiend(void)
 {
+  int screen_w, screen_h;
+
   // FIXME: Why doesn't it work without this line?
   fiend_gfx_driver = GFX_AUTODETECT_WINDOWED;
   
@@ -194,27 +225,56 @@ int init_fiend(void)
   log_debug("Graphics driver: %d", fiend_gfx_driver);
   log_debug("Color depth: %d", color_depth);
   
+    //the screen is at least 640x480 with the playfield in the middle
+	view_w = MID(TILE_SIZE*4, view_w, MAX_VIEW_W);
+	view_h = MID(TILE_SIZE*4, view_h, MAX_VIEW_H);
+	screen_w = MAX(640, view_w);
+	screen_h = MAX(480, view_h);
+	view_x = (screen_w - view_w)/2;
+	view_y = (screen_h - view_h)/2;
+
     //init the graphic mode
 
-	if(color_depth==16)
+	if(headless_is_on)
 	{
-		set_color_depth(16);
-		
-		if(set_gfx_mode(fiend_gfx_driver,640,480,0,0)!=0)
+		//no display, the screen is a memory bitmap like the rest
+		set_color_depth(color_depth==32 ? 32 : 16);
+		screen = create_bitmap(screen_w,screen_h);
+		vsync_is_on = 0;
+	}
+	else if((color_depth==16 || color_depth==32) && !init_present(fiend_gfx_driver,screen_w,screen_h,color_depth))
+	{
+		//32 bit is only for newer cards, older ones get the 16 bit mode
+		if(color_depth==32)
+		{
+			set_color_depth(32);
+			if(set_gfx_mode(fiend_gfx_driver,screen_w,screen_h,0,0)!=0)
+			{
+				log_warning("Couldn't set a 32 bit mode, using 16 bit");
+				color_depth = 16;
+			}
+		}
+
+		if(color_depth==16)
 		{
-			set_color_depth(15);
-			if(set_gfx_mode(fiend_gfx_driver,640,480,0,0)!=0){
-				strcpy(fiend_errorcode,"couldn't enter graphics mode");
-				log_error("Failed to initialize graphics mode");
-				return 1;
+			set_color_depth(16);
+			
+			if(set_gfx_mode(fiend_gfx_driver,screen_w,screen_h,0,0)!=0)
+			{
+				set_color_depth(15);
+				if(set_gfx_mode(fiend_gfx_driver,screen_w,screen_h,0,0)!=0){
+					strcpy(fiend_errorcode,"couldn't enter graphics mode");
+					log_error("Failed to initialize graphics mode");
+					return 1;
+				}
 			}
 		}
 	}
 	
-	log_info("Graphics initialized: 640x480 at %d-bit color", get_color_depth());
+	log_info("Graphics initialized: %dx%d at %d-bit color, playfield %dx%d", screen_w, screen_h, get_color_depth(), view_w, view_h);
 	
 	/* Initialize audio system (miniaudio) */
-	sound_is_on = 1;
+	sound_is_on = !headless_is_on;
 	if(sound_is_on)
 	{
 		if (audio_init() != 0)
@@ -248,7 +308,7 @@ int init_fiend(void)
 	log_info("Font loaded successfully");
 	
 	//make the virtual screen
-	virt = create_bitmap(480,480);
+	virt = create_bitmap(view_w,view_h);
 	clear(virt);
 
 	//make a temp bitmap...
@@ -256,7 +316,7 @@ int init_fiend(void)
 	clear(temp_bitmap);
 
 	//make the light mask
-	mask = create_bitmap_ex(8,480,480);
+	mask = create_bitmap_ex(8,view_w,view_h);
 	clear(mask);
 
     // Initialise the console
@@ -318,7 +378,13 @@ void exit_fiend(void)
 	release_message_faces();
 		
 	free_sounds();
+	tile_cache_release();
+	tile_plan_release();
+	light_bake_release();
 	release_tiles();
+	release_rotation_cache();
+	release_light_mask();
+	release_render_queue();
 	release_characters();
 	release_items();
 	release_objects();
@@ -331,6 +397,15 @@ void exit_fiend(void)
 
 	audio_shutdown();
 
+	release_present();
+
+	//allegro did not make the headless screen
+	if(headless_is_on && screen)
+	{
+		destroy_bitmap(screen);
+		screen = NULL;
+	}
+
 	allegro_exit();
 }
 
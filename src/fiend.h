@@ -23,11 +23,17 @@
 #include "fiend/ai.h"
 #include "fiend/effect.h"
 #include "fiend/los.h"
+#include "fiend/visibility.h"
+#include "fiend/spatial_grid.h"
+#include "fiend/interpolate.h"
+#include "fiend/replay.h"
+#include "fiend/profiler.h"
 #include "fiend/astar.h"
 #include "fiend/savegame.h"
 #include "fiend/menu.h"
 #include "fiend/notes.h"
 #include "fiend/intro.h"
+#include "fiend/render_thread.h"
 
 
 //-----Some defines------
@@ -51,6 +57,14 @@
 //the game
 #define TILE_SIZE 32
 
+//the biggest playfield, the buffers that go along the view are this big
+#define MAX_VIEW_W 1920
+#define MAX_VIEW_H 1200
+
+//the los grid has the tiles of the view and one more on each side
+#define LOS_MAX_W (MAX_VIEW_W/TILE_SIZE+3)
+#define LOS_MAX_H (MAX_VIEW_H/TILE_SIZE+3)
+
 
 #define MAX_LIGHT_NUM 70
 #define MAX_SCRIPT_NUM 30
@@ -124,13 +138,13 @@ extern int num_of_soundemitors;
 extern int num_of_areas;
 
 extern volatile int speed_counter;
+extern int max_frame_rate;
 
 extern int map_x;
 extern int map_y;
 
 extern MAP_DATA *map;
 extern BITMAP *lightmap_data[MAX_LIGHT_NUM];
-extern BITMAP *lightmap_cache;
 
 extern char map_file[80];
 extern char global_var_filename[80];
@@ -151,7 +165,7 @@ extern int message_active;
 
 extern char fiend_errorcode[];
 
-extern int los_buffer[18][18];
+extern int los_buffer[LOS_MAX_W][LOS_MAX_H];
 
 
 //confidg stuff
@@ -161,6 +175,14 @@ extern int debug_is_on;
 extern int lightning_is_on;
 extern int cache_lights_is_on;
 
+extern int headless_is_on;
+extern int benchmark_frames;
+
+extern int view_w;
+extern int view_h;
+extern int view_x;
+extern int view_y;
+
 extern int fiend_log_level;  // Log level from command line (or -1 if not set)
 
 extern int fiend_sound_volume;
@@ -348,6 +370,7 @@ void draw_flames(void);
 
 //Draw level routines
 void draw_level(void);
+void release_render_queue(void);
 
 //Player routines
 void update_player(void);
@@ -361,6 +384,7 @@ void update_auto_move(void);
 //lightmap
 void create_light_map(BITMAP **dest, LIGHT_DATA *light);
 void create_light_map2(BITMAP **dest, LIGHT_DATA *light);
+void create_light_maps2(BITMAP **dest, LIGHT_DATA *light, int num_of_lights);
 
 //Link
 void check_link_collison(void);
@@ -131,6 +131,10 @@ int object_is_in_fov(float eye_x, float eye_y,float eye_angle, float x, float y,
 
 
 static char tile_object_solidity[MAX_LAYER_H*MAX_LAYER_W];
+static char last_tile_object_solidity[MAX_LAYER_H*MAX_LAYER_W];
+
+//changed when the solidity of a tile has changed
+int tile_object_solidity_version=0;
 
 
 
@@ -227,6 +231,11 @@ void update_tile_object_height(void)
 	}*/
 
 
+	if(memcmp(tile_object_solidity, last_tile_object_solidity, MAX_LAYER_H*MAX_LAYER_W)!=0)
+	{
+		memcpy(last_tile_object_solidity, tile_object_solidity, MAX_LAYER_H*MAX_LAYER_W);
+		tile_object_solidity_version++;
+	}
 }
 
 
@@ -259,6 +268,13 @@ static int tile_is_not_clear(int x,int y,int solidity,int check_player)
 
 
 
+//does the tile block the sight, used by the visibility sweep
+int tile_blocks_sight(int x, int y)
+{
+	return tile_is_not_clear(x, y, 3, 0);
+}
+
+
 //Function used by object_is_in_fov (amongst other).
 //check if the line between eye_x,y and x,y has any obejcts tiles.
 //with solidity. IF check_player is 1 then it also checks for the player.
@@ -7,6 +7,14 @@
 
 #include "../fiend.h"
 #include "../console_funcs.h"
+#include "../tile_cache.h"
+#include "../tile_plan.h"
+#include "../tile_atlas.h"
+#include "../light_bake.h"
+#include "../draw_simd.h"
+#include "../rotate_sprite.h"
+#include "../draw.h"
+#include "../present.h"
 
 //===========================================================================
 //    IMPLEMENTATION PRIVATE DEFINITIONS / ENUMERATIONS / SIMPLE TYPEDEFS
@@ -127,6 +135,288 @@ static int csl_lightning(void)
 	}
 
 		
+	return CSLMSG_O_K;
+}
+//---------------------------------------------------------------------------
+// Name: tile_cache 
+// Desc: Turns the prerendered tile chunks on or off.
+//---------------------------------------------------------------------------
+static int csl_tile_cache(void)
+{
+    int argc = csl_argc()+1;
+	    
+	    
+	if(argc==1)
+	{
+		csl_textoutf(1, "Tile_cache is set to \"%d\" (budget %d kb).", tile_cache_is_on, tile_cache_budget);
+	}
+	else
+	{
+		tile_cache_is_on = atoi(csl_argv(1));
+		csl_textoutf(1, "Tile_cache is set to \"%d\".", tile_cache_is_on);
+	}
+
+		
+	return CSLMSG_O_K;
+}
+//---------------------------------------------------------------------------
+// Name: tile_plan 
+// Desc: Sets if the tiles are drawn from the plan made when the map is loaded.
+//---------------------------------------------------------------------------
+static int csl_tile_plan(void)
+{
+    int argc = csl_argc()+1;
+	    
+	    
+	if(argc==1)
+	{
+		csl_textoutf(1, "Tile_plan is set to \"%d\".", tile_plan_is_on);
+	}
+	else
+	{
+		tile_plan_is_on = atoi(csl_argv(1));
+		csl_textoutf(1, "Tile_plan is set to \"%d\".", tile_plan_is_on);
+	}
+
+		
+	return CSLMSG_O_K;
+}
+//---------------------------------------------------------------------------
+// Name: tile_atlas 
+// Desc: Sets if the opaque tiles are copied from the tile atlas.
+//---------------------------------------------------------------------------
+static int csl_tile_atlas(void)
+{
+    int argc = csl_argc()+1;
+	    
+	    
+	if(argc==1)
+	{
+		csl_textoutf(1, "Tile_atlas is set to \"%d\".", tile_atlas_is_on);
+	}
+	else
+	{
+		tile_atlas_is_on = atoi(csl_argv(1));
+		csl_textoutf(1, "Tile_atlas is set to \"%d\".", tile_atlas_is_on);
+	}
+
+		
+	return CSLMSG_O_K;
+}
+//---------------------------------------------------------------------------
+// Name: light_bake 
+// Desc: Turns adding the static lights together once on or off.
+//---------------------------------------------------------------------------
+static int csl_light_bake(void)
+{
+    int argc = csl_argc()+1;
+	    
+	    
+	if(argc==1)
+	{
+		csl_textoutf(1, "Light_bake is set to \"%d\".", light_bake_is_on);
+	}
+	else
+	{
+		light_bake_is_on = atoi(csl_argv(1));
+		csl_textoutf(1, "Light_bake is set to \"%d\".", light_bake_is_on);
+	}
+
+		
+	return CSLMSG_O_K;
+}
+//---------------------------------------------------------------------------
+// Name: draw_simd 
+// Desc: Sets what simd level the pixel loops use (0=C, 1=SSE2, 2=AVX2).
+//---------------------------------------------------------------------------
+static int csl_draw_simd(void)
+{
+    int argc = csl_argc()+1;
+	    
+	    
+	if(argc==1)
+	{
+		csl_textoutf(1, "Draw_simd is set to \"%d\".", draw_simd_level);
+	}
+	else
+	{
+		set_draw_simd_level(atoi(csl_argv(1)));
+		csl_textoutf(1, "Draw_simd is set to \"%d\".", draw_simd_level);
+	}
+
+		
+	return CSLMSG_O_K;
+}
+//---------------------------------------------------------------------------
+// Name: rotation_cache 
+// Desc: Turns the cache of rotated characters and enemies on or off.
+//---------------------------------------------------------------------------
+static int csl_rotation_cache(void)
+{
+    int argc = csl_argc()+1;
+	    
+	    
+	if(argc==1)
+	{
+		csl_textoutf(1, "Rotation_cache is set to \"%d\" (budget %d kb).", rotation_cache_is_on, rotation_cache_budget);
+	}
+	else
+	{
+		rotation_cache_is_on = atoi(csl_argv(1));
+		if(argc>2)
+			rotation_cache_budget = atoi(csl_argv(2));
+		if(!rotation_cache_is_on)
+			release_rotation_cache();
+		csl_textoutf(1, "Rotation_cache is set to \"%d\" (budget %d kb).", rotation_cache_is_on, rotation_cache_budget);
+	}
+
+		
+	return CSLMSG_O_K;
+}
+//---------------------------------------------------------------------------
+// Name: render_thread 
+// Desc: Turns drawing the world on a second thread on or off.
+//---------------------------------------------------------------------------
+static int csl_render_thread(void)
+{
+    int argc = csl_argc()+1;
+	    
+	    
+	if(argc==1)
+	{
+		csl_textoutf(1, "Render_thread is set to \"%d\".", render_thread_is_running());
+	}
+	else
+	{
+		render_thread_is_on = atoi(csl_argv(1));
+		if(render_thread_is_on)
+			render_thread_is_on = start_render_thread();
+		else
+			stop_render_thread();
+		csl_textoutf(1, "Render_thread is set to \"%d\".", render_thread_is_running());
+	}
+
+		
+	return CSLMSG_O_K;
+}
+//---------------------------------------------------------------------------
+// Name: interpolate 
+// Desc: Turns drawing things between the logic updates on and off.
+//---------------------------------------------------------------------------
+static int csl_interpolate(void)
+{
+    int argc = csl_argc()+1;
+	    
+	    
+	if(argc==1)
+	{
+		csl_textoutf(1, "Interpolate is set to \"%d\".", interpolation_is_on);
+	}
+	else
+	{
+		interpolation_is_on = atoi(csl_argv(1));
+		csl_textoutf(1, "Interpolate is set to \"%d\".", interpolation_is_on);
+	}
+
+		
+	return CSLMSG_O_K;
+}
+//---------------------------------------------------------------------------
+// Name: max_fps 
+// Desc: Sets how many frames are drawn a second at most, 0 is the refresh rate.
+//---------------------------------------------------------------------------
+static int csl_max_fps(void)
+{
+    int argc = csl_argc()+1;
+	    
+	    
+	if(argc==1)
+	{
+		csl_textoutf(1, "Max_fps is set to \"%d\".", max_frame_rate);
+	}
+	else
+	{
+		max_frame_rate = MAX(0, atoi(csl_argv(1)));
+		csl_textoutf(1, "Max_fps is set to \"%d\".", max_frame_rate);
+	}
+
+		
+	return CSLMSG_O_K;
+}
+//---------------------------------------------------------------------------
+// Name: profiler 
+// Desc: Shows the times of the parts of a frame on the screen.
+//---------------------------------------------------------------------------
+static int csl_profiler(void)
+{
+    int argc = csl_argc()+1;
+	    
+	    
+	if(argc==1)
+	{
+		csl_textoutf(1, "Profiler is set to \"%d\".", profiler_is_on);
+	}
+	else
+	{
+		if(!profiler_is_on)reset_profiler();
+		profiler_is_on = atoi(csl_argv(1));
+		csl_textoutf(1, "Profiler is set to \"%d\".", profiler_is_on);
+	}
+
+		
+	return CSLMSG_O_K;
+}
+//---------------------------------------------------------------------------
+// Name: profile_trace [filename]
+// Desc: Saves the last times of the profiler for chrome://tracing.
+//---------------------------------------------------------------------------
+static int csl_profile_trace(void)
+{
+    int argc = csl_argc()+1;
+	char path[256];
+
+	    
+	if(argc==1)
+		strcpy(path, "profile.json");
+	else
+		sprintf(path, "%.255s", csl_argv(1));
+
+	if(!profiler_is_on)
+	{
+		csl_textout(1, "the profiler is off, turn it on with \"profiler 1\"");
+		return CSLMSG_O_K;
+	}
+
+	if(!save_profile_trace(path))
+	{
+		csl_textoutf(1, "couldn't save trace to %s", path);
+		return CSLMSG_ERROR;
+	}
+
+	csl_textoutf(1, "saved trace to %s", path);
+		
+	return CSLMSG_O_K;
+}
+//---------------------------------------------------------------------------
+// Name: light_threads 
+// Desc: Sets the number of threads drawing the light mask, 0 is one per cpu.
+//---------------------------------------------------------------------------
+static int csl_light_threads(void)
+{
+    int argc = csl_argc()+1;
+	    
+	    
+	if(argc==1)
+	{
+		csl_textoutf(1, "Light_threads is set to \"%d\".", light_mask_threads);
+	}
+	else
+	{
+		light_mask_threads = MID(0, atoi(csl_argv(1)), LIGHT_MASK_MAX_THREADS);
+		csl_textoutf(1, "Light_threads is set to \"%d\".", light_mask_threads);
+	}
+
+		
 	return CSLMSG_O_K;
 }
 //---------------------------------------------------------------------------
@@ -252,11 +542,11 @@ void draw_csl_dbuff(BITMAP *csl_dbuff, int csl_y)
     {
         draw_level();
         blit(csl_dbuff, virt, 0, csl_dbuff->h-csl_y, 0, 0, csl_dbuff->w, csl_y);
-        blit(virt, screen, 0,0,80,0,480,480);
+        present_blit(virt, 0, 0, view_x, view_y, view_w, view_h);
     }
     else
     {
-        blit(csl_dbuff, screen, 0, csl_dbuff->h-csl_y, 80, 0, csl_dbuff->w, csl_y);
+        present_blit(csl_dbuff, 0, csl_dbuff->h-csl_y, view_x, view_y, csl_dbuff->w, csl_y);
     }
     release_screen();
 }
@@ -276,6 +566,18 @@ void register_console_funcs_and_vars(void)
 	csl_add_func("sound_volume", csl_sound_volume);
 	csl_add_func("music_volume", csl_music_volume);
 	csl_add_func("vsync", csl_vsync);
+	csl_add_func("tile_cache", csl_tile_cache);
+	csl_add_func("light_bake", csl_light_bake);
+	csl_add_func("draw_simd", csl_draw_simd);
+	csl_add_func("rotation_cache", csl_rotation_cache);
+	csl_add_func("render_thread", csl_render_thread);
+	csl_add_func("light_threads", csl_light_threads);
+	csl_add_func("interpolate", csl_interpolate);
+	csl_add_func("max_fps", csl_max_fps);
+	csl_add_func("profiler", csl_profiler);
+	csl_add_func("profile_trace", csl_profile_trace);
+	csl_add_func("tile_plan", csl_tile_plan);
+	csl_add_func("tile_atlas", csl_tile_atlas);
 	
 }
 
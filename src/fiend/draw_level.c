@@ -6,55 +6,90 @@
 
 
 
+#include <stdlib.h>
+
 #include <allegro.h>
 
 #include "../fiend.h"
 #include "../draw.h"
+#include "../draw_list.h"
+#include "../light_bake.h"
 #include "../grafik4.h"
 #include "../console.h"
 #include "../logger.h"
+#include "../present.h"
 
 
 #define ITEM_LIGHT_DIST 80
 
 extern int lights_flashes;
 
+//the lights added to the light mask this frame
+static LIGHT_MASK_LIGHT *mask_light=NULL;
+static int num_of_mask_lights=0;
+static int max_mask_lights=0;
+
 
 //////////////////////////////////////////////////////////
 ///////  Draw The light maps and and the light mask //////
 ///////////////////////////////////////////////////////////
 
+//add a light to the list of lights on the mask
+static void add_mask_light(BITMAP *pic, int x, int y)
+{
+	if(num_of_mask_lights>=max_mask_lights)
+	{
+		max_mask_lights = max_mask_lights ? max_mask_lights*2 : 64;
+		mask_light = realloc(mask_light, sizeof(LIGHT_MASK_LIGHT)*max_mask_lights);
+	}
+
+	mask_light[num_of_mask_lights].pic = pic;
+	mask_light[num_of_mask_lights].x = x;
+	mask_light[num_of_mask_lights].y = y;
+	num_of_mask_lights++;
+}
+
+
 void draw_the_lights(void)
 {
  int i;	
- clear_to_color(mask, map->light_level);
+ int size;
+ int num_of_chunks;
+ LIGHT_MASK_LIGHT *chunk;
+
+ num_of_mask_lights=0;
  
- //---The light maps-------//
+ //---The baked static lights-------//
+ num_of_chunks = light_bake_get_chunks(map_x, map_y, virt->w, virt->h, &chunk);
+ for(i=0;i<num_of_chunks;i++)
+	add_mask_light(chunk[i].pic, chunk[i].x, chunk[i].y);
+
+ //---The light maps that flash or move-------//
  for(i=0;i<map->num_of_lights;i++)
  {
-	 if(map->light[i].active)
+	 if(map->light[i].active && !light_is_baked(i))
 	 {
 		 //if(check_collision(map_x, map_y, 480,480, map->light[i].world_x-lightmap_data[i]->w/2, map->light[i].world_y-lightmap_data[i]->h/2, lightmap_data[i]->w, lightmap_data[i]->h))
 			 if(object_is_in_player_los(map->light[i].world_x,map->light[i].world_y,map->light[i].strech_w,map->light[i].strech_h,0,0)) 
-				if(map->light[i].flash)
-				{
-					if(lights_flashes)	
-						draw_lightmap2(mask, lightmap_data[i], map->light[i].world_x - (map_x) - map->light[i].strech_w/2, map->light[i].world_y - (map_y)- map->light[i].strech_h/2); 
-				}
-				else 	
-					draw_lightmap2(mask, lightmap_data[i], map->light[i].world_x - (map_x) - map->light[i].strech_w/2, map->light[i].world_y - (map_y)- map->light[i].strech_h/2); 
+				if(!map->light[i].flash || lights_flashes)
+					add_mask_light(lightmap_data[i], map->light[i].world_x - (map_x) - map->light[i].strech_w/2, map->light[i].world_y - (map_y)- map->light[i].strech_h/2); 
 	 }
 
  }
 
 
- //---�The Normal Lights----//
+ //---The Normal Lights----//
  for(i=0;i<NORMAL_LIGHT_NUM;i++)
-	draw_normal_light(mask, i);
+	if(normal_light_data[i].used)
+	{
+		size = normal_lightmap[normal_light_data[i].c][normal_light_data[i].r]->w/2;
+
+		add_mask_light(normal_lightmap[normal_light_data[i].c][normal_light_data[i].r], normal_light_data[i].x - map_x -size, normal_light_data[i].y - map_y -size);
+	}
 
 	
- //---The light mask-------//
- draw_lightsprite(virt, mask,0,0);
+ //---The light mask, drawn in bands by the light workers-------//
+ dl_draw_light_mask(virt, mask, map->light_level, mask_light, num_of_mask_lights);
 }
 
 
@@ -66,17 +101,236 @@ void draw_the_lights(void)
 ///////////////////////////////////////////////////////////
 
 
-void draw_the_objects(void)
+//the buckets of the render queue, in the order they are drawn
+#define RQ_LOW_OBJECTS 0 //solid==0
+#define RQ_UNDER_TILE_OBJECTS 1 //solid==1 and energy<0
+#define RQ_ITEMS_UNDER 2 //angle<0
+#define RQ_OBJECTS 3 //solid==1 and energy>=0
+#define RQ_DEAD_ENEMIES 4
+#define RQ_DEAD_NPCS 5
+#define RQ_ITEMS_OVER 6 //angle>-1
+#define RQ_ENEMIES_UNDER_PLAYER 7
+#define RQ_ENEMIES 8
+#define RQ_NPCS 9
+#define RQ_HIGH_OBJECTS 10 //solid>1
+#define RQ_ADDITIVE_OBJECTS 11 //solid>1 and additive
+#define RQ_BUCKET_NUM 12
+
+typedef struct
+{
+	int *num;//index in object, enemy, npc or item data
+	int num_of_entries;
+	int max_entries;
+}RENDER_BUCKET;
+
+static RENDER_BUCKET render_queue[RQ_BUCKET_NUM];
+
+
+static void add_to_bucket(int bucket, int num)
+{
+	RENDER_BUCKET *temp = &render_queue[bucket];
+
+	if(temp->num_of_entries>=temp->max_entries)
+	{
+		temp->max_entries = temp->max_entries ? temp->max_entries*2 : 64;
+		temp->num = realloc(temp->num, sizeof(int)*temp->max_entries);
+	}
+
+	temp->num[temp->num_of_entries] = num;
+	temp->num_of_entries++;
+}
+
+
+//is something that reaches reach pixels from x,y on the screen?
+static int is_in_view(int x, int y, int reach)
 {
-	int j,i,x,y;
+	return x+reach >= map_x && x-reach < map_x+virt->w && y+reach >= map_y && y-reach < map_y+virt->h;
+}
+
+
+//put the things close to the screen in the buckets, those that are
+//off the screen are left out.
+static void build_render_queue(void)
+{
+	int i,j;
+	int bucket;
+	int num_found;
+	int *found;
+	OBJECT_INFO *o_info;
+	ENEMY_INFO *e_info;
+	CHARACTER_INFO *c_info;
+	RLE_SPRITE *pic;
+	int pad;
+
+	for(i=0;i<RQ_BUCKET_NUM;i++)
+		render_queue[i].num_of_entries=0;
+
+	//the grid has where the enemies and npcs are after the update, but
+	//they are drawn up to INTERPOLATION_SNAP_DIST behind that.
+	pad = interpolation_is_on ? INTERPOLATION_SNAP_DIST : 0;
+
+	//--- The objects ---//
+	num_found = spatial_grid_get(GRID_OBJECT, map_x, map_y, virt->w, virt->h, &found);
+	for(j=0;j<num_found;j++)
+	{
+		i = found[j];
+		if(!map->object[i].active)continue;
+
+		o_info = &object_info[map->object[i].type];
+
+		if(o_info->solid==0)
+			bucket = RQ_LOW_OBJECTS;
+		else if(o_info->solid==1)
+			bucket = map->object[i].energy<0 ? RQ_UNDER_TILE_OBJECTS : RQ_OBJECTS;
+		else
+			bucket = o_info->additive ? RQ_ADDITIVE_OBJECTS : RQ_HIGH_OBJECTS;
+
+		if(is_in_view(map->object[i].x, map->object[i].y, object_frame_reach(o_info, o_info->animation[map->object[i].action].frame[map->object[i].frame])))
+			add_to_bucket(bucket, i);
+	}
+
+	//--- The items ---//
+	num_found = spatial_grid_get(GRID_ITEM, map_x, map_y, virt->w, virt->h, &found);
+	for(j=0;j<num_found;j++)
+	{
+		i = found[j];
+		if(item_data[i].picked_up || !item_data[i].active || !item_data[i].used)continue;
+
+		pic = item_pic[item_data[i].type].dat;
+
+		if(is_in_view(item_data[i].x, item_data[i].y, pic->w + pic->h))
+			add_to_bucket(item_data[i].angle<0 ? RQ_ITEMS_UNDER : RQ_ITEMS_OVER, i);
+	}
+
+	//--- The enemies ---//
+	num_found = spatial_grid_get(GRID_ENEMY, map_x-pad, map_y-pad, virt->w+2*pad, virt->h+2*pad, &found);
+	for(j=0;j<num_found;j++)
+	{
+		i = found[j];
+		if(!enemy_data[i].active || !enemy_data[i].used)continue;
+
+		e_info = &enemy_info[enemy_data[i].type];
+
+		if(enemy_data[i].dead)
+			bucket = RQ_DEAD_ENEMIES;
+		else
+			bucket = e_info->under_player ? RQ_ENEMIES_UNDER_PLAYER : RQ_ENEMIES;
+
+		//the shadow is drawn too
+		if(is_in_view(enemy_data[i].x, enemy_data[i].y, MAX(pic_data_reach(&e_info->pic[e_info->animation[enemy_data[i].action].frame[enemy_data[i].frame]]),
+			enemy_shadow[enemy_data[i].type]->w + enemy_shadow[enemy_data[i].type]->h)))
+			add_to_bucket(bucket, i);
+	}
+
+	//--- The npcs ---//
+	num_found = spatial_grid_get(GRID_NPC, map_x-pad, map_y-pad, virt->w+2*pad, virt->h+2*pad, &found);
+	for(j=0;j<num_found;j++)
+	{
+		i = found[j];
+		if(!npc_data[i].active || !npc_data[i].used)continue;
+
+		c_info = &char_info[npc_data[i].type];
+
+		if(is_in_view(npc_data[i].x, npc_data[i].y, MAX(pic_data_reach(&c_info->pic[c_info->animation[npc_data[i].action].frame[npc_data[i].frame]]),
+			char_shadow[npc_data[i].type]->w + char_shadow[npc_data[i].type]->h)))
+			add_to_bucket(npc_data[i].dead ? RQ_DEAD_NPCS : RQ_NPCS, i);
+	}
+}
+
+
+static void draw_object_bucket(int bucket)
+{
+	int i,j;
+
+	for(j=0;j<render_queue[bucket].num_of_entries;j++)
+	{
+		i = render_queue[bucket].num[j];
+		draw_fiend_object(virt, &object_info[map->object[i].type], map->object[i].x-map_x, map->object[i].y-map_y, map->object[i].action, map->object[i].frame, map->object[i].angle);
+	}
+}
+
+
+//the items next to the player are lit
+static void draw_item_bucket(int bucket)
+{
+	int i,j,x,y;
 	float temp_x, temp_y;
+
+	xyplus(PLAYER_USE_LENGTH, player.angle, &temp_x, &temp_y);
+	x = player.x +temp_x;
+	y = player.y +temp_y;
+
+	for(j=0;j<render_queue[bucket].num_of_entries;j++)
+	{
+		i = render_queue[bucket].num[j];
+		
+		if(object_is_in_player_los(item_data[i].x,item_data[i].y,item_info[item_data[i].type].w,item_info[item_data[i].type].h,0,0)) 
+		{
+			if(check_collision(x-PLAYER_PICKUP_W/2,y-PLAYER_PICKUP_H/2,PLAYER_PICKUP_W,PLAYER_PICKUP_H,item_data[i].x-item_info[item_data[i].type].w/2,item_data[i].y-item_info[item_data[i].type].h/2,item_info[item_data[i].type].w,item_info[item_data[i].type].h))
+			{
+				draw_fiend_item(virt, item_data[i].type, item_data[i].x-map_x, item_data[i].y-map_y,item_data[i].angle,1);
+			}
+			else
+			{
+				draw_fiend_item(virt, item_data[i].type, item_data[i].x-map_x, item_data[i].y-map_y,item_data[i].angle,0);
+			}
+		}
+	}
+}
+
+
+static void draw_enemy_bucket(int bucket, int with_shadow)
+{
+	int i,j;
+
+	for(j=0;j<render_queue[bucket].num_of_entries;j++)
+	{
+		i = render_queue[bucket].num[j];
+		
+		if(with_shadow)
+			dl_draw_lightsprite(virt,enemy_shadow[enemy_data[i].type], enemy_data[i].x-enemy_shadow[enemy_data[i].type]->w/2-map_x, enemy_data[i].y - enemy_shadow[enemy_data[i].type]->h/2 -map_y);
+		draw_fiend_enemy(virt, &enemy_info[enemy_data[i].type], enemy_data[i].x-map_x, enemy_data[i].y-map_y, enemy_data[i].action, enemy_data[i].frame, enemy_data[i].angle);
+	}
+}
+
+
+static void draw_npc_bucket(int bucket, int with_shadow)
+{
+	int i,j;
+
+	for(j=0;j<render_queue[bucket].num_of_entries;j++)
+	{
+		i = render_queue[bucket].num[j];
+		
+		if(with_shadow)
+			dl_draw_lightsprite(virt,char_shadow[npc_data[i].type], npc_data[i].x-char_shadow[npc_data[i].type]->w/2-map_x, npc_data[i].y - char_shadow[npc_data[i].type]->h/2 -map_y);
+		draw_fiend_char(virt, &char_info[npc_data[i].type], npc_data[i].x-map_x, npc_data[i].y-map_y, npc_data[i].action, npc_data[i].frame, npc_data[i].angle);
+	}
+}
+
+
+void release_render_queue(void)
+{
+	int i;
+
+	for(i=0;i<RQ_BUCKET_NUM;i++)
+	{
+		if(render_queue[i].num)
+			free(render_queue[i].num);
+		
+		render_queue[i].num = NULL;
+		render_queue[i].num_of_entries = 0;
+		render_queue[i].max_entries = 0;
+	}
+}
+
+
+void draw_the_objects(void)
+{
+	build_render_queue();
 	
 	//--- The low objects thats is objects with solid<1 ---//
-	for(i=0;i<map->num_of_objects;i++)
-		if(object_info[map->object[i].type].solid==0)
-			if(map->object[i].active)
-					draw_fiend_object(virt, &object_info[map->object[i].type], map->object[i].x-map_x, map->object[i].y-map_y, map->object[i].action, map->object[i].frame, map->object[i].angle);
-			
+	draw_object_bucket(RQ_LOW_OBJECTS);
 	
 	draw_particles(0);
 
@@ -87,74 +341,21 @@ void draw_the_objects(void)
 	draw_wall_shadows(virt,map_x, map_y);
 	
 	//--- The low objects thats is objects with solid==1 ---//
-	for(i=0;i<map->num_of_objects;i++)
-		if(object_info[map->object[i].type].solid==1 && map->object[i].energy<0)
-			if(map->object[i].active)
-					draw_fiend_object(virt, &object_info[map->object[i].type], map->object[i].x-map_x, map->object[i].y-map_y, map->object[i].action, map->object[i].frame, map->object[i].angle);
+	draw_object_bucket(RQ_UNDER_TILE_OBJECTS);
 	
 	draw_tile_layer(virt, 2,1,  map_x, map_y);
 
-	xyplus(PLAYER_USE_LENGTH, player.angle, &temp_x, &temp_y);
-	x = player.x +temp_x;
-	y = player.y +temp_y;
-
 	// Items under obejcts (angle<0)
-
-	for(j=0;j<current_map_item_num;j++)
-	{
-		i = current_map_item[j];
-		if(!item_data[i].picked_up && item_data[i].active && item_data[i].used && item_data[i].angle<0)
-		{
-			if(object_is_in_player_los(item_data[i].x,item_data[i].y,item_info[item_data[i].type].w,item_info[item_data[i].type].h,0,0)) 
-			{
-				if(check_collision(x-PLAYER_PICKUP_W/2,y-PLAYER_PICKUP_H/2,PLAYER_PICKUP_W,PLAYER_PICKUP_H,item_data[i].x-item_info[item_data[i].type].w/2,item_data[i].y-item_info[item_data[i].type].h/2,item_info[item_data[i].type].w,item_info[item_data[i].type].h))
-				{
-					draw_fiend_item(virt, item_data[i].type, item_data[i].x-map_x, item_data[i].y-map_y,item_data[i].angle,1);
-				}
-				else
-				{
-					draw_fiend_item(virt, item_data[i].type, item_data[i].x-map_x, item_data[i].y-map_y,item_data[i].angle,0);
-				}
-			}
-		}
-	}
-	
+	draw_item_bucket(RQ_ITEMS_UNDER);
 	
 	//--- The low objects thats is objects with solid==1 ---//
-	for(i=0;i<map->num_of_objects;i++)
-		if(object_info[map->object[i].type].solid==1 && map->object[i].energy>=0)
-			if(map->object[i].active)
-					draw_fiend_object(virt, &object_info[map->object[i].type], map->object[i].x-map_x, map->object[i].y-map_y, map->object[i].action, map->object[i].frame, map->object[i].angle);
-	
-	
+	draw_object_bucket(RQ_OBJECTS);
 	
 	//--- The dead enemies ---//
-	for(j=0;j<current_map_enemy_num;j++)
-	{
-		i = current_map_enemy[j];
-		if(enemy_data[i].dead && enemy_data[i].active && enemy_data[i].used)
-		{
-			if(1)//object_is_in_player_los(enemy_data[i].x,enemy_data[i].y,enemy_info[enemy_data[i].type].w,enemy_info[enemy_data[i].type].h,0,0)) 
-			{
-				draw_fiend_enemy(virt, &enemy_info[enemy_data[i].type], enemy_data[i].x-map_x, enemy_data[i].y-map_y, enemy_data[i].action, enemy_data[i].frame, enemy_data[i].angle);
-			}
-		}
-	}
-	
-	
+	draw_enemy_bucket(RQ_DEAD_ENEMIES, 0);
 	
 	//----The dead npcs ---//
-	for(j=0;j<current_map_npc_num;j++)
-	{
-		i = current_map_npc[j];
-		if(npc_data[i].dead && npc_data[i].active && npc_data[i].used)
-		{
-			if(1)//object_is_in_player_los(npc_data[i].x,npc_data[i].y,char_info[npc_data[i].type].w,char_info[npc_data[i].type].h,0,0)) 
-			{
-				draw_fiend_char(virt, &char_info[npc_data[i].type], npc_data[i].x-map_x, npc_data[i].y-map_y, npc_data[i].action, npc_data[i].frame, npc_data[i].angle);
-			}
-		}
-	}
+	draw_npc_bucket(RQ_DEAD_NPCS, 0);
 
 	//--- The Player ----//
 	if(player.dead && player.energy>=-char_info[0].energy*2)
@@ -164,25 +365,7 @@ void draw_the_objects(void)
 
 	
 	//--- The items over object (angle>-1) ---//
-	
-	for(j=0;j<current_map_item_num;j++)
-	{
-		i = current_map_item[j];
-		if(!item_data[i].picked_up && item_data[i].active && item_data[i].used && item_data[i].angle>-1)
-		{
-			if(object_is_in_player_los(item_data[i].x,item_data[i].y,item_info[item_data[i].type].w,item_info[item_data[i].type].h,0,0)) 
-			{
-				if(check_collision(x-PLAYER_PICKUP_W/2,y-PLAYER_PICKUP_H/2,PLAYER_PICKUP_W,PLAYER_PICKUP_H,item_data[i].x-item_info[item_data[i].type].w/2,item_data[i].y-item_info[item_data[i].type].h/2,item_info[item_data[i].type].w,item_info[item_data[i].type].h))
-				{
-					draw_fiend_item(virt, item_data[i].type, item_data[i].x-map_x, item_data[i].y-map_y,item_data[i].angle,1);
-				}
-				else
-				{
-					draw_fiend_item(virt, item_data[i].type, item_data[i].x-map_x, item_data[i].y-map_y,item_data[i].angle,0);
-				}
-			}
-		}
-	}
+	draw_item_bucket(RQ_ITEMS_OVER);
 	
 	//--- the shells --//
 	draw_shells();
@@ -190,60 +373,21 @@ void draw_the_objects(void)
 	draw_particles(1);
 	
 	//--- The enemies under the player---//
-	for(j=0;j<current_map_enemy_num;j++)
-	{
-		i = current_map_enemy[j];
-		if(!enemy_data[i].dead && enemy_data[i].active && enemy_data[i].used && enemy_info[enemy_data[i].type].under_player)
-		{
-				
-			if(1)//object_is_in_player_los(enemy_data[i].x,enemy_data[i].y,enemy_info[enemy_data[i].type].w,enemy_info[enemy_data[i].type].h,0,0)) 
-			{
-				draw_lightsprite(virt,enemy_shadow[enemy_data[i].type], enemy_data[i].x-enemy_shadow[enemy_data[i].type]->w/2-map_x, enemy_data[i].y - enemy_shadow[enemy_data[i].type]->h/2 -map_y);
-				draw_fiend_enemy(virt, &enemy_info[enemy_data[i].type], enemy_data[i].x-map_x, enemy_data[i].y-map_y, enemy_data[i].action, enemy_data[i].frame, enemy_data[i].angle);
-			}
-			
-		}
-	}
+	draw_enemy_bucket(RQ_ENEMIES_UNDER_PLAYER, 1);
 	
 	//--- The Player ----//
 	if(!player.dead)
 	{
-		draw_lightsprite(virt,char_shadow[0], player.x -char_shadow[0]->w/2-map_x, player.y - char_shadow[0]->h/2 -map_y);
+		dl_draw_lightsprite(virt,char_shadow[0], player.x -char_shadow[0]->w/2-map_x, player.y - char_shadow[0]->h/2 -map_y);
 		draw_fiend_char(virt, &char_info[0],player.x-map_x,player.y-map_y,player.action,player.frame,player.angle);
 	}
 
 	
 	//--- The enemies ---//
-	for(j=0;j<current_map_enemy_num;j++)
-	{
-		i = current_map_enemy[j];
-		if(!enemy_data[i].dead && enemy_data[i].active && enemy_data[i].used && !enemy_info[enemy_data[i].type].under_player)
-		{
-				
-			if(1)//object_is_in_player_los(enemy_data[i].x,enemy_data[i].y,enemy_info[enemy_data[i].type].w,enemy_info[enemy_data[i].type].h,0,0)) 
-			{
-				draw_lightsprite(virt,enemy_shadow[enemy_data[i].type], enemy_data[i].x-enemy_shadow[enemy_data[i].type]->w/2-map_x, enemy_data[i].y - enemy_shadow[enemy_data[i].type]->h/2 -map_y);
-				draw_fiend_enemy(virt, &enemy_info[enemy_data[i].type], enemy_data[i].x-map_x, enemy_data[i].y-map_y, enemy_data[i].action, enemy_data[i].frame, enemy_data[i].angle);
-			}
-			
-		}
-	}
+	draw_enemy_bucket(RQ_ENEMIES, 1);
 	
 	//----The npcs ---//
-	for(j=0;j<current_map_npc_num;j++)
-	{
-		i = current_map_npc[j];
-		if(npc_data[i].active && npc_data[i].used && !npc_data[i].dead)
-		{
-			if(1)//object_is_in_player_los(npc_data[i].x,npc_data[i].y,char_info[npc_data[i].type].w,char_info[npc_data[i].type].h,0,0)) 
-			{
-				draw_lightsprite(virt,char_shadow[npc_data[i].type], npc_data[i].x-char_shadow[npc_data[i].type]->w/2-map_x, npc_data[i].y - char_shadow[npc_data[i].type]->h/2 -map_y);
-				draw_fiend_char(virt, &char_info[npc_data[i].type], npc_data[i].x-map_x, npc_data[i].y-map_y, npc_data[i].action, npc_data[i].frame, npc_data[i].angle);
-		
-			}
-			
-		}
-	}
+	draw_npc_bucket(RQ_NPCS, 1);
 	
 	
 	//--- The missiles--//
@@ -254,13 +398,7 @@ void draw_the_objects(void)
 
 		
 	//--- The high objects thats is objects with solid>1 ---//
-	for(i=0;i<map->num_of_objects;i++)
-		if(object_info[map->object[i].type].solid>1 && !object_info[map->object[i].type].additive)
-			if(map->object[i].active)
-				if(1)//object_is_in_player_los(map->object[i].x,map->object[i].y,object_info[map->object[i].type].w,object_info[map->object[i].type].h,map->object[i].angle,0)) 
-				{
-					draw_fiend_object(virt, &object_info[map->object[i].type], map->object[i].x-map_x, map->object[i].y-map_y, map->object[i].action, map->object[i].frame, map->object[i].angle);
-				}
+	draw_object_bucket(RQ_HIGH_OBJECTS);
 	
 	draw_tile_layer(virt, 3,0,  map_x, map_y);
 	
@@ -273,18 +411,47 @@ void draw_the_objects(void)
 		draw_the_lights();
 	
 	//--- The high Additive objects thats is objects with solid>1 ---//
-	for(i=0;i<map->num_of_objects;i++)
-		if(object_info[map->object[i].type].solid>1 && object_info[map->object[i].type].additive)
-			if(map->object[i].active)
-				if(1)//object_is_in_player_los(map->object[i].x,map->object[i].y,object_info[map->object[i].type].w,object_info[map->object[i].type].h,map->object[i].angle,0)) 
-				{
-					draw_fiend_object(virt, &object_info[map->object[i].type], map->object[i].x-map_x, map->object[i].y-map_y, map->object[i].action, map->object[i].frame, map->object[i].angle);
-				}
+	draw_object_bucket(RQ_ADDITIVE_OBJECTS);
+		
+}
+
+
+
+//////////////////////////////////////////////////////////
+///////  The world, drawn by the render thread if it is on //////
+///////////////////////////////////////////////////////////
+
+static void draw_the_world(void)
+{
+	profile_begin("tile layers");
+	draw_tile_layer(virt, 1,0,  map_x, map_y);
+	draw_tile_layer(virt, 1,1,  map_x, map_y);
+	draw_tile_layer(virt, 2,0,  map_x, map_y);
+	profile_end();
+		
+	profile_begin("objects");
+	draw_the_objects();
+	profile_end();
 		
+		
+	profile_begin("particles");
+	draw_particles(3);
+	draw_beams();
+	profile_end();
+
+	profile_begin("top tile layer");
+	draw_tile_layer(virt, 3,2,  map_x, map_y);
+	profile_end();
+	
+	
+	profile_begin("los");
+	draw_los_buffer(virt,map_x,map_y);
+	profile_end();
 }
 
 
 
+
 //////////////////////////////////////////////////////////
 ///////  The main function //////
 ///////////////////////////////////////////////////////////
@@ -304,25 +471,24 @@ void draw_level(void)
 		first_call = 0;
 	}
 	
+	profile_begin("draw");
+
+	profile_begin("los buffer");
 	clear_los_buffer();
 	update_los_buffer(map_x,map_y);
+	profile_end();
 
-	draw_tile_layer(virt, 1,0,  map_x, map_y);
-	draw_tile_layer(virt, 1,1,  map_x, map_y);
-	draw_tile_layer(virt, 2,0,  map_x, map_y);
-		
-	draw_the_objects();
-		
-		
-	draw_particles(3);
-	draw_beams();
+	//the console draws the level the normal way
+	if(csl_started)
+		render_thread_sync();
 
-	draw_tile_layer(virt, 3,2,  map_x, map_y);
-	
-	
-	draw_los_buffer(virt,map_x,map_y);
+	profile_begin("world");
+	render_world(draw_the_world);
+	profile_end();
 
+	profile_begin("effects");
 	draw_effects();
+	profile_end();
 
 		
 	draw_pickup_message();
@@ -355,25 +521,36 @@ void draw_level(void)
 		draw_engine_error();
 	}
 
+	profile_end();
+
+	draw_profiler(virt);
+
     //IF we are in the console don't blit it to screen,
 	if(csl_started)
 		return;
 
+	profile_begin("present");
+
     if(screen_is_black)
     { 
-  		vsync();
+  		if(!headless_is_on)vsync();
 		acquire_screen();
 		clear(screen);
 		release_screen();
+		present_screen();
     }
     else
     {
 		//------The main blit-----//
 		if(vsync_is_on)vsync();
 		acquire_screen();
-		blit(virt, screen, 0,0,80,0,480,480);
+		present_blit(virt, 0, 0, view_x, view_y, view_w, view_h);
 		release_screen();
     }
+
+	render_thread_submit();
+
+	profile_end();
 }
 
 
@@ -13,6 +13,7 @@
 
 #include "../fiend.h"
 #include "../grafik4.h"
+#include "../present.h"
 
 
 
@@ -114,15 +115,15 @@ void update_effects(void)
 
 			if(effect_data[i].type==EFFECT_QUAKE)
 			{
-				map_x+= RANDOM(-effect_data[i].z, effect_data[i].z);
-				map_y+= RANDOM(-effect_data[i].z, effect_data[i].z);
+				map_x+= RANDOM_IN(RANDOM_EFFECTS, -effect_data[i].z, effect_data[i].z);
+				map_y+= RANDOM_IN(RANDOM_EFFECTS, -effect_data[i].z, effect_data[i].z);
 			}
 
 			if(effect_data[i].type==EFFECT_RAIN)
 			{
-				if(RANDOM(0,effect_data[i].x)==0)
+				if(RANDOM_IN(RANDOM_EFFECTS, 0,effect_data[i].x)==0)
 				{
-					make_new_particle("rain",RANDOM(map_x-20,map_x+520),RANDOM(map_y-20,map_y+520),0,0,0,30,1,-1);			
+					make_new_particle("rain",RANDOM_IN(RANDOM_EFFECTS, map_x-20,map_x+view_w+40),RANDOM_IN(RANDOM_EFFECTS, map_y-20,map_y+view_h+40),0,0,0,30,1,-1);			
 				}
 			}
 			
@@ -132,7 +133,7 @@ void update_effects(void)
 				
 				//check if the flash comes
 				if(effect_data[i].x>100 && effect_data[i].sp1==0)
-					if(RANDOM(0,400)==1)
+					if(RANDOM_IN(RANDOM_EFFECTS, 0,400)==1)
 					{
 						effect_data[i].sp1 = 1;
 						effect_data[i].sp2 = map->light_level;
@@ -148,14 +149,14 @@ void update_effects(void)
 				}
 
 				//play the sound after about 1 second
-				if(effect_data[i].x>RANDOM(170,190) && effect_data[i].sp1==2)
+				if(effect_data[i].x>RANDOM_IN(RANDOM_EFFECTS, 170,190) && effect_data[i].sp1==2)
 				{
 					play_fiend_sound("thunder",0,0,0,0,220);
 					effect_data[i].sp1 = 3;
 				}
 
 				//after about 5 seconds its time for a new flash..
-				if(effect_data[i].x>RANDOM(490, 600) && effect_data[i].sp1==3)
+				if(effect_data[i].x>RANDOM_IN(RANDOM_EFFECTS, 490, 600) && effect_data[i].sp1==3)
 				{
 					effect_data[i].sp1=0;
 					effect_data[i].x =0;
@@ -288,8 +289,8 @@ void draw_effects(void)
 				{
 					hline(virt,480,j,480-effect_data[i].sp1,0);
 				}*/
-				for(j=0;j<480;j+=3)
-					for(k=0;k<480;k+=3)
+				for(j=0;j<virt->w;j+=3)
+					for(k=0;k<virt->h;k+=3)
 						putpixel(virt,j,k,0);
 
 
@@ -299,13 +300,14 @@ void draw_effects(void)
 			{
 				line_space = ((effect_data[i].sp1/480)*10)+1;
 				
-				for(j=0;j<480;j+=line_space)
+				//sp1 goes to 480, the lines are stretched to the view
+				for(j=0;j<virt->h;j+=line_space)
 				{
-					hline(virt,0,j,480-effect_data[i].sp1,0);
+					hline(virt,0,j,(480-effect_data[i].sp1)*virt->w/480,0);
 				}
-				for(j=1;j<480;j+=line_space)
+				for(j=1;j<virt->h;j+=line_space)
 				{
-					hline(virt,480,j,effect_data[i].sp1,0);
+					hline(virt,virt->w,j,effect_data[i].sp1*virt->w/480,0);
 				}
 
 			}	
@@ -322,17 +324,19 @@ void fiend_fadeout(int speed)
 {
 	BITMAP *bmp;
 	int i;
+
+	render_thread_sync();
 	
-	bmp = create_bitmap(480,480);
+	bmp = create_bitmap(virt->w,virt->h);
 
-	blit(virt,bmp,0,0,0,0,480,480);
+	blit(virt,bmp,0,0,0,0,virt->w,virt->h);
 
 	for(i=0;i<256;i+=speed)
 	{
 		set_trans_blender(0,0,0,0);
 		draw_lit_sprite(virt,bmp,0,0,i);
-		vsync();
-		blit(virt,screen,0,0,80,0,480,480);
+		if(!headless_is_on)vsync();
+		present_blit(virt, 0, 0, view_x, view_y, view_w, view_h);
 	}
 	screen_is_black=1;
 
@@ -345,23 +349,25 @@ void fiend_fadein(int speed)
 {
 	BITMAP *bmp;
 	int i;
+
+	render_thread_sync();
 	
-	bmp = create_bitmap(480,480);
+	bmp = create_bitmap(virt->w,virt->h);
 
 	screen_is_black=1;
 	
-	map_x = player.x - 240;
-	map_y = player.y - 240;
+	map_x = player.x - view_w/2;
+	map_y = player.y - view_h/2;
 	draw_level();
 
-	blit(virt,bmp,0,0,0,0,480,480);
+	blit(virt,bmp,0,0,0,0,virt->w,virt->h);
 	
 	for(i=256;i>0;i-=speed)
 	{
 		set_trans_blender(0,0,0,0);
 		draw_lit_sprite(virt,bmp,0,0,i);
-		vsync();
-		blit(virt,screen,0,0,80,0,480,480);
+		if(!headless_is_on)vsync();
+		present_blit(virt, 0, 0, view_x, view_y, view_w, view_h);
 	}
 	screen_is_black=0;
 
@@ -52,7 +52,7 @@ void total_reset_enemy_ai(void)
 		enemy_ai[i].found_player=0;
 
 		enemy_ai[i].damage_taken=0;
-		enemy_ai[i].damage_count=RANDOM(0,DAMAGE_CHECK);
+		enemy_ai[i].damage_count=RANDOM_IN(RANDOM_AI, 0,DAMAGE_CHECK);
 
 		enemy_ai[i].have_seen_player=0;
 
@@ -83,7 +83,7 @@ void reset_enemy_ai(void)
 		enemy_ai[i].found_player=0;
 
 		enemy_ai[i].damage_taken=0;
-		enemy_ai[i].damage_count=RANDOM(0,DAMAGE_CHECK);
+		enemy_ai[i].damage_count=RANDOM_IN(RANDOM_AI, 0,DAMAGE_CHECK);
 
 		enemy_ai[i].have_seen_player=0;
 
@@ -273,27 +273,27 @@ void update_enemy_angle(int num)
 	{
 		if( (enemy_data[num].current_mission==MISSION_PLAYER || enemy_data[num].current_mission==MISSION_NPC) && !enemy_ai[num].found_player && !enemy_ai[num].running) 
 		{
-			if(RANDOM(0,enemy_info[type].move_random)==1 )
+			if(RANDOM_IN(RANDOM_AI, 0,enemy_info[type].move_random)==1 )
 			{
 				enemy_ai[num].walking_random=1;
 				if(enemy_ai[num].last_dx==0 || enemy_ai[num].last_dy==0)
 				{		
-					enemy_ai[num].wanted_angle = add_angle(enemy_ai[num].wanted_angle,RANDOM(-110, -250));
+					enemy_ai[num].wanted_angle = add_angle(enemy_ai[num].wanted_angle,RANDOM_IN(RANDOM_AI, -110, -250));
 				}
 				else
 				{
-					enemy_ai[num].wanted_angle = RANDOM(0,360);
+					enemy_ai[num].wanted_angle = RANDOM_IN(RANDOM_AI, 0,360);
 				}
 
-				enemy_ai[num].random_count = RANDOM(30,140);
+				enemy_ai[num].random_count = RANDOM_IN(RANDOM_AI, 30,140);
 
 			}
 		}
-		else if(RANDOM(0,enemy_info[type].move_random)==1)
+		else if(RANDOM_IN(RANDOM_AI, 0,enemy_info[type].move_random)==1)
 		{
 			enemy_ai[num].walking_random=1;
-			enemy_ai[num].wanted_angle = add_angle(enemy_ai[num].wanted_angle,RANDOM(-enemy_info[type].move_random_length,enemy_info[type].move_random_length));
-			enemy_ai[num].random_count = RANDOM(30,enemy_info[type].move_random_time);
+			enemy_ai[num].wanted_angle = add_angle(enemy_ai[num].wanted_angle,RANDOM_IN(RANDOM_AI, -enemy_info[type].move_random_length,enemy_info[type].move_random_length));
+			enemy_ai[num].random_count = RANDOM_IN(RANDOM_AI, 30,enemy_info[type].move_random_time);
 		}
 	}
 	
@@ -523,7 +523,7 @@ void update_enemy_data(int num)
 			for(i=0;i<3;i++)
 			{
 				if(strcmp(enemy_info[type].weapon_name[i],"null")!=0)
-					if(distance(enemy_data[num].x, enemy_data[num].y,player.x, player.y)<=enemy_info[type].weapon_range[i] && RANDOM(0,enemy_info[type].weapon_random[i])==0)
+					if(distance(enemy_data[num].x, enemy_data[num].y,player.x, player.y)<=enemy_info[type].weapon_range[i] && RANDOM_IN(RANDOM_AI, 0,enemy_info[type].weapon_random[i])==0)
 					{
 						enemy_ai[num].attacking= enemy_info[type].weapon_length[i];
 						enemy_ai[num].attack_num = i;
@@ -564,7 +564,7 @@ void update_enemy_data(int num)
 					
 					//angle = (weapon_info[w_type].missile_angle/2)-angle;
 
-					angle = RANDOM(-weapon_info[w_type].missile_angle, weapon_info[w_type].missile_angle);
+					angle = RANDOM_IN(RANDOM_AI, -weapon_info[w_type].missile_angle, weapon_info[w_type].missile_angle);
 
 					compute_towerxy( enemy_data[num].angle ,weapon_info[w_type].missile_x,weapon_info[w_type].missile_y,&temp_x, &temp_y);
 					make_new_missile(enemy_data[num].x+temp_x, enemy_data[num].y+temp_y, add_angle(enemy_data[num].angle,angle), w_type);
@@ -582,7 +582,7 @@ void update_enemy_data(int num)
 				//shoot a shell
 				compute_towerxy(enemy_data[num].angle,weapon_info[w_type].shell_x,weapon_info[w_type].shell_y,&temp_x, &temp_y);
 
-				make_shell(weapon_info[w_type].shell_name,enemy_data[num].x+temp_x, enemy_data[num].y+temp_y, (float)(RANDOM(8,12))/10, add_angle(enemy_data[num].angle, 90), 1,(float)(RANDOM(16,19))/10,(float)(RANDOM(14,20))/10,190);
+				make_shell(weapon_info[w_type].shell_name,enemy_data[num].x+temp_x, enemy_data[num].y+temp_y, (float)(RANDOM_IN(RANDOM_AI, 8,12))/10, add_angle(enemy_data[num].angle, 90), 1,(float)(RANDOM_IN(RANDOM_AI, 16,19))/10,(float)(RANDOM_IN(RANDOM_AI, 14,20))/10,190);
 				enemy_ai[num].weapon_was_shot=0;		
 			}
 			else
@@ -594,15 +594,15 @@ void update_enemy_data(int num)
 			enemy_ai[num].attacking--;
 
 			if(enemy_ai[num].attacking<1 && enemy_info[type].attack_from_behind )
-				if(RANDOM(1,enemy_info[type].attack_from_behind)==1)
+				if(RANDOM_IN(RANDOM_AI, 1,enemy_info[type].attack_from_behind)==1)
 				{
 					temp_x = -100;
 				
 					for(i=0;i<map->num_of_path_nodes;i++)
 					{
 						if(distance(map->path_node[i].x,map->path_node[i].y, player.x,player.y)<200)
-							if(object_is_in_fov(map->path_node[i].x, map->path_node[i].y, enemy_data[num].angle, player.x, player.y, 1,1, 360,1) )
-								if(RANDOM(0,1)==1)
+							if(player_is_in_fov(map->path_node[i].x, map->path_node[i].y, enemy_data[num].angle, 360) )
+								if(RANDOM_IN(RANDOM_AI, 0,1)==1)
 									if(find_best_xy(enemy_data[num].x,enemy_data[num].y,map->path_node[i].x, map->path_node[i].y, enemy_info[type].w,enemy_info[type].h, &x, &y,1))
 									{
 										temp_x = map->path_node[i].x;
@@ -687,7 +687,7 @@ void update_enemy_data(int num)
 			{	
 				i = current_map_enemy[j];
 				if(enemy_data[i].used && enemy_data[i].active && enemy_ai[i].found_player)
-				if(object_is_in_fov(enemy_data[i].x, enemy_data[i].y, enemy_data[num].angle, player.x, player.y, char_info[0].w, char_info[0].h, 360,1))
+				if(player_is_in_fov(enemy_data[i].x, enemy_data[i].y, enemy_data[num].angle, 360))
 				{
 				
 					//the enemy is the same sort and you wotk in team then get better info
@@ -720,7 +720,7 @@ void update_enemy_data(int num)
 		else
 			fov = enemy_info[type].fov;
 
-		if(!player.dead && object_is_in_fov(enemy_data[num].x, enemy_data[num].y, enemy_data[num].angle, player.x, player.y, char_info[0].w, char_info[0].h, fov,5))
+		if(!player.dead && player_is_in_fov(enemy_data[num].x, enemy_data[num].y, enemy_data[num].angle, fov))
 		{
 			// if enemy has motionon based seeing check if player has moved...
 			if( (enemy_info[type].eye_type==1 && (player.last_dx!=0 || player.last_dy!=0) ) || enemy_info[type].eye_type==0)
@@ -774,7 +774,7 @@ void update_enemy_data(int num)
 				for(i=0;i<map->num_of_path_nodes;i++)
 				{
 					if(distance(map->path_node[i].x,map->path_node[i].y, enemy_data[num].x,enemy_data[num].y)<400)
-						if(!object_is_in_fov(map->path_node[i].x, map->path_node[i].y, enemy_data[num].angle, player.x, player.y, char_info[0].w, char_info[0].h, 360,1) )
+						if(!player_is_in_fov(map->path_node[i].x, map->path_node[i].y, enemy_data[num].angle, 360) )
 							if(find_best_xy(enemy_data[num].x,enemy_data[num].y,map->path_node[i].x, map->path_node[i].y, enemy_info[type].w,enemy_info[type].h, &x, &y,1))
 							{
 								temp_x = map->path_node[i].x;
@@ -824,7 +824,7 @@ void update_enemy_data(int num)
 		if(!enemy_ai[num].attacking && !enemy_ai[num].found_player && !enemy_ai[num].running)
 		{
 			for(i=0;i<3;i++)
-				if(RANDOM(0,enemy_info[type].sound_ambient_random[i])==1)
+				if(RANDOM_IN(RANDOM_AI, 0,enemy_info[type].sound_ambient_random[i])==1)
 				{
 					play_fiend_sound(enemy_info[type].sound_ambient[i],enemy_data[num].x,enemy_data[num].y, 1,0,180);
 					enemy_ai[num].speaking = SPEAK_LENGTH;
@@ -834,7 +834,7 @@ void update_enemy_data(int num)
 		if(enemy_ai[num].found_player)
 		{
 			for(i=3;i<5;i++)
-				if(strcmp(enemy_info[type].sound_ambient[i],"none")!=0 && RANDOM(0,enemy_info[type].sound_ambient_random[i])==0)
+				if(strcmp(enemy_info[type].sound_ambient[i],"none")!=0 && RANDOM_IN(RANDOM_AI, 0,enemy_info[type].sound_ambient_random[i])==0)
 				{
 					play_fiend_sound(enemy_info[type].sound_ambient[i],enemy_data[num].x,enemy_data[num].y, 1,0,180);
 					enemy_ai[num].speaking = SPEAK_LENGTH;
@@ -0,0 +1,233 @@
+////////////////////////////////////////////////////
+// This file contains the smoothing of the drawing
+// between two logic updates. The positions before an
+// update are kept, and when a frame is drawn part way
+// to the next update the player, enemies, npcs,
+// missiles, particles and the camera are put between
+// where they were and where they are. When the frame
+// is drawn they are put back.
+///////////////////////////////////////////////////
+
+
+#include <math.h>
+
+#include <allegro.h>
+
+#include "../fiend.h"
+#include "../grafik4.h"
+#include "interpolate.h"
+
+
+typedef struct
+{
+	float x;
+	float y;
+	float angle;
+	int used;
+}INTERPOLATION_STATE;
+
+
+int interpolation_is_on=1;
+
+static int last_is_valid=0;
+
+//where things were before the last update
+static INTERPOLATION_STATE last_player;
+static INTERPOLATION_STATE last_enemy[MAX_ENEMY_DATA];
+static INTERPOLATION_STATE last_npc[MAX_NPC_NUM];
+static INTERPOLATION_STATE last_missile[MAX_MISSILES];
+static INTERPOLATION_STATE last_particle[MAX_PARTICLE_DATA];
+static int last_map_x;
+static int last_map_y;
+
+//where things are, while a frame is drawn
+static INTERPOLATION_STATE real_player;
+static INTERPOLATION_STATE real_enemy[MAX_ENEMY_DATA];
+static INTERPOLATION_STATE real_npc[MAX_NPC_NUM];
+static INTERPOLATION_STATE real_missile[MAX_MISSILES];
+static INTERPOLATION_STATE real_particle[MAX_PARTICLE_DATA];
+static int real_map_x;
+static int real_map_y;
+
+static int frame_is_interpolated=0;
+
+
+
+static void get_state(INTERPOLATION_STATE *state, float x, float y, float angle, int used)
+{
+	state->x = x;
+	state->y = y;
+	state->angle = angle;
+	state->used = used;
+}
+
+
+//put something between where it was and where it is
+static void interpolate(INTERPOLATION_STATE *last, float *x, float *y, float *angle, int used, float alpha)
+{
+	float angle_diff;
+
+	if(!last->used || !used)
+		return;
+	if(fabs(*x - last->x) > INTERPOLATION_SNAP_DIST || fabs(*y - last->y) > INTERPOLATION_SNAP_DIST)
+		return;
+
+	*x = last->x + (*x - last->x)*alpha;
+	*y = last->y + (*y - last->y)*alpha;
+
+	if(angle)
+	{
+		//turn the short way
+		angle_diff = *angle - last->angle;
+		if(angle_diff > 180) angle_diff -= 360;
+		if(angle_diff < -180) angle_diff += 360;
+
+		*angle = add_angle(last->angle, angle_diff*alpha);
+	}
+}
+
+
+static void restore(INTERPOLATION_STATE *real, float *x, float *y, float *angle)
+{
+	*x = real->x;
+	*y = real->y;
+	if(angle)
+		*angle = real->angle;
+}
+
+
+
+//forget where things were, after a new map or a loaded game
+void reset_interpolation(void)
+{
+	last_is_valid=0;
+}
+
+
+//forget where the thing in a slot was, when the slot is given to a new
+//one, so it is not smoothed from where the old one was
+void reset_enemy_interpolation(int num)
+{
+	last_enemy[num].used=0;
+}
+
+void reset_npc_interpolation(int num)
+{
+	last_npc[num].used=0;
+}
+
+void reset_missile_interpolation(int num)
+{
+	last_missile[num].used=0;
+}
+
+void reset_particle_interpolation(int num)
+{
+	last_particle[num].used=0;
+}
+
+
+//keep where things are before the logic is updated
+void store_interpolation_state(void)
+{
+	int i;
+
+	get_state(&last_player, player.x, player.y, player.angle, 1);
+
+	for(i=0;i<MAX_ENEMY_DATA;i++)
+		get_state(&last_enemy[i], enemy_data[i].x, enemy_data[i].y, enemy_data[i].angle, enemy_data[i].used && enemy_data[i].active);
+
+	for(i=0;i<MAX_NPC_NUM;i++)
+		get_state(&last_npc[i], npc_data[i].x, npc_data[i].y, npc_data[i].angle, npc_data[i].used && npc_data[i].active);
+
+	for(i=0;i<MAX_MISSILES;i++)
+		get_state(&last_missile[i], missile_data[i].x, missile_data[i].y, missile_data[i].angle, missile_data[i].used);
+
+	for(i=0;i<MAX_PARTICLE_DATA;i++)
+		get_state(&last_particle[i], particle_data[i].x, particle_data[i].y, particle_data[i].angle, particle_data[i].used);
+
+	last_map_x = map_x;
+	last_map_y = map_y;
+
+	last_is_valid=1;
+}
+
+
+//put everything alpha (0-1) of the way from where it was to where it
+//is. end_interpolated_frame must be called when the frame is drawn.
+void begin_interpolated_frame(float alpha)
+{
+	int i;
+
+	if(!interpolation_is_on || !last_is_valid || alpha>=1)
+		return;
+
+	alpha = MAX(alpha, 0);
+
+	get_state(&real_player, player.x, player.y, player.angle, 1);
+	interpolate(&last_player, &player.x, &player.y, &player.angle, 1, alpha);
+
+	for(i=0;i<MAX_ENEMY_DATA;i++)
+	{
+		get_state(&real_enemy[i], enemy_data[i].x, enemy_data[i].y, enemy_data[i].angle, 1);
+		interpolate(&last_enemy[i], &enemy_data[i].x, &enemy_data[i].y, &enemy_data[i].angle, enemy_data[i].used && enemy_data[i].active, alpha);
+	}
+
+	for(i=0;i<MAX_NPC_NUM;i++)
+	{
+		get_state(&real_npc[i], npc_data[i].x, npc_data[i].y, npc_data[i].angle, 1);
+		interpolate(&last_npc[i], &npc_data[i].x, &npc_data[i].y, &npc_data[i].angle, npc_data[i].used && npc_data[i].active, alpha);
+	}
+
+	for(i=0;i<MAX_MISSILES;i++)
+	{
+		get_state(&real_missile[i], missile_data[i].x, missile_data[i].y, missile_data[i].angle, 1);
+		interpolate(&last_missile[i], &missile_data[i].x, &missile_data[i].y, &missile_data[i].angle, missile_data[i].used, alpha);
+	}
+
+	//the particle angle is the way it moves, it is not drawn smoothed
+	for(i=0;i<MAX_PARTICLE_DATA;i++)
+	{
+		get_state(&real_particle[i], particle_data[i].x, particle_data[i].y, 0, 1);
+		interpolate(&last_particle[i], &particle_data[i].x, &particle_data[i].y, NULL, particle_data[i].used, alpha);
+	}
+
+	real_map_x = map_x;
+	real_map_y = map_y;
+	if(abs(map_x - last_map_x) <= INTERPOLATION_SNAP_DIST && abs(map_y - last_map_y) <= INTERPOLATION_SNAP_DIST)
+	{
+		map_x = last_map_x + (int)floor((map_x - last_map_x)*alpha + 0.5);
+		map_y = last_map_y + (int)floor((map_y - last_map_y)*alpha + 0.5);
+	}
+
+	frame_is_interpolated=1;
+}
+
+
+//put everything back where it is
+void end_interpolated_frame(void)
+{
+	int i;
+
+	if(!frame_is_interpolated)
+		return;
+
+	restore(&real_player, &player.x, &player.y, &player.angle);
+
+	for(i=0;i<MAX_ENEMY_DATA;i++)
+		restore(&real_enemy[i], &enemy_data[i].x, &enemy_data[i].y, &enemy_data[i].angle);
+
+	for(i=0;i<MAX_NPC_NUM;i++)
+		restore(&real_npc[i], &npc_data[i].x, &npc_data[i].y, &npc_data[i].angle);
+
+	for(i=0;i<MAX_MISSILES;i++)
+		restore(&real_missile[i], &missile_data[i].x, &missile_data[i].y, &missile_data[i].angle);
+
+	for(i=0;i<MAX_PARTICLE_DATA;i++)
+		restore(&real_particle[i], &particle_data[i].x, &particle_data[i].y, NULL);
+
+	map_x = real_map_x;
+	map_y = real_map_y;
+
+	frame_is_interpolated=0;
+}
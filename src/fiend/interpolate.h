@@ -0,0 +1,20 @@
+#ifndef INTERPOLATE_H
+#define INTERPOLATE_H
+
+#define INTERPOLATION_STEPS 16 //parts of a logic update the timer counts
+#define INTERPOLATION_SNAP_DIST 64 //things moving further than this are not smoothed
+
+extern int interpolation_is_on;
+
+
+void reset_interpolation(void);
+void reset_enemy_interpolation(int num);
+void reset_npc_interpolation(int num);
+void reset_missile_interpolation(int num);
+void reset_particle_interpolation(int num);
+void store_interpolation_state(void);
+
+void begin_interpolated_frame(float alpha);
+void end_interpolated_frame(void);
+
+#endif
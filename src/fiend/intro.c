@@ -12,6 +12,7 @@
 #include "../grafik4.h"
 #include "../fiend.h"
 #include "../logger.h"
+#include "../present.h"
 
 DATAFILE *font_intro;
 
@@ -62,7 +63,7 @@ void show_gripdesign(void)
 		set_trans_blender(0,0,0,0);
 		draw_lit_sprite(virt,bmp,0,0,alpha);
 		vsync();
-		blit(virt,screen,0,0,80,0,480,480);
+		present_blit(virt, 0, 0, view_x, view_y, view_w, view_h);
 	}
 
 	destroy_bitmap(bmp);
@@ -167,7 +168,7 @@ void show_poem(void)
 		textout_ex(virt,font_avalon2->dat,text2, (int)x2,(int)y2,color2, -1);
 		log_debug("Both text lines drawn successfully");
 	
-		blit(virt,screen,0,0,80,0,480,480);
+		present_blit(virt, 0, 0, view_x, view_y, view_w, view_h);
 	}
 
 }
@@ -565,7 +566,7 @@ void show_intro_text(void)
 		set_trans_blender(0,0,0,alpha);
 		draw_trans_sprite(virt,bmp,x,y);
 		vsync();
-		blit(virt,screen,0,0,80,0,480,480);
+		present_blit(virt, 0, 0, view_x, view_y, view_w, view_h);
 	}
 
 
@@ -622,7 +623,7 @@ void show_intro_text(void)
 		// Show skip hint
 		textout_ex(virt,font_avalon2->dat,"[Press SPACE or ENTER to skip]", 0,450,makecol(100,100,100), -1);
 	
-		blit(virt,screen,0,0,80,0,480,480);
+		present_blit(virt, 0, 0, view_x, view_y, view_w, view_h);
 	}
 
 	// Clear keyboard buffer to prevent keys from being carried over
@@ -722,7 +723,7 @@ void show_ending(void)
 			}
 			//textout(virt,font_avalon2->dat,text, x2,y2,makecol(alpha2,alpha2,alpha2));
 	
-			blit(virt,screen,0,0,80,0,480,480);
+			present_blit(virt, 0, 0, view_x, view_y, view_w, view_h);
 		}
 	
 
@@ -769,7 +770,7 @@ void show_ending(void)
 
 		textout_centre_ex(virt,font_arial->dat,"T H E   E N D",240,220,makecol(alpha,alpha,alpha), -1);
 
-		blit(virt,screen,0,0,80,0,480,480);
+		present_blit(virt, 0, 0, view_x, view_y, view_w, view_h);
 	}
 
 
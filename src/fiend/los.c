@@ -12,6 +12,7 @@
 #include <stdio.h>
 
 #include "../draw.h"
+#include "../draw_list.h"
 #include "../fiend.h"
 #include "../grafik4.h"
 
@@ -19,16 +20,64 @@
 static int tile_pos_x;
 static int tile_pos_y;
 
-int los_buffer[18][18];
+int los_buffer[LOS_MAX_W][LOS_MAX_H];
+
+//the part of the los arrays used, the tiles of the view and one more
+//on each side. a view scrolled part of a tile shows one tile more.
+static int los_w=18;
+static int los_h=18;
+
+//the los is made again when the player moves to another tile
+#define LOS_EYE_STEP TILE_SIZE
+
+//what tiles was seen for the last los, -1 if not looked up. they are
+//only looked up again when the player, the solid objects or the map
+//has changed, and moved along when the view scrolls.
+static int los_ray[LOS_MAX_W][LOS_MAX_H];
+static int los_ray_x;//the tile of los_ray[1][1]
+static int los_ray_y;
+static int los_eye_step_x;
+static int los_eye_step_y;
+static int los_solidity_version;
+static int los_rays_are_valid=0;
+
+//the buffer made from the rays
+static int los_result[LOS_MAX_W][LOS_MAX_H];
 
 BITMAP *los_border[3][4]; //0=right 1=down 2=left 3=up
 
+//the bits of the tiles around a tile that are dark
+#define LOS_LEFT 1
+#define LOS_RIGHT 2
+#define LOS_UP 4
+#define LOS_DOWN 8
+#define LOS_UP_LEFT 16
+#define LOS_UP_RIGHT 32
+#define LOS_DOWN_LEFT 64
+#define LOS_DOWN_RIGHT 128
+
+//what to draw on a seen tile for each set of dark tiles around it. the
+//borders that fit are put together in one pic, or it is all black.
+static BITMAP *los_cell_pic[256];
+static int los_cell_black[256];
+
+//los_buffer_check2 for the drawn tiles and the ones around them
+static int los_dark[LOS_MAX_W+2][LOS_MAX_H+2];
+
+//size the los grid after the view
+static void set_los_size(void)
+{
+	los_w = MIN((view_w+TILE_SIZE-1)/TILE_SIZE + 3, LOS_MAX_W);
+	los_h = MIN((view_h+TILE_SIZE-1)/TILE_SIZE + 3, LOS_MAX_H);
+}
+
+
 void clear_los_buffer(void)
 {
 	int i,j;
 
-	for(i=0;i<18;i++)
-		for(j=0;j<18;j++)
+	for(i=0;i<los_w;i++)
+		for(j=0;j<los_h;j++)
 			los_buffer[i][j]=0;
 }
 
@@ -37,9 +86,9 @@ void clear_los_buffer(void)
 int los_buffer_check(int x, int y)
 {
 	if(x<0)return 1;
-	if(x>16) return 1;
+	if(x>los_w-2) return 1;
 	if(y<0)return 1;
-	if(y>16) return 1;
+	if(y>los_h-2) return 1;
 
 	if(x-1 + tile_pos_x<0)return 1;
 	if(y-1 + tile_pos_y<0)return 1;
@@ -61,9 +110,9 @@ int los_buffer_check2(int x, int y)
 
 	
 	if(x<0)return 0;
-	if(x>17) return 0;
+	if(x>los_w-1) return 0;
 	if(y<0)return 0;
-	if(y>17) return 0;
+	if(y>los_h-1) return 0;
 
 		
 	//if(tile_is_wall_solid(x + tile_pos_x, y + tile_pos_y))return 1;
@@ -72,10 +121,32 @@ int los_buffer_check2(int x, int y)
 }
 
 
+//get the bits of the dark tiles around the tile l_i, l_j
+static int get_los_neighbours(int l_i, int l_j)
+{
+	int n=0;
+
+	l_i++;//los_dark starts one tile before the buffer
+	l_j++;
+
+	if(los_dark[l_i-1][l_j]) n|=LOS_LEFT;
+	if(los_dark[l_i+1][l_j]) n|=LOS_RIGHT;
+	if(los_dark[l_i][l_j-1]) n|=LOS_UP;
+	if(los_dark[l_i][l_j+1]) n|=LOS_DOWN;
+	if(los_dark[l_i-1][l_j-1]) n|=LOS_UP_LEFT;
+	if(los_dark[l_i+1][l_j-1]) n|=LOS_UP_RIGHT;
+	if(los_dark[l_i-1][l_j+1]) n|=LOS_DOWN_LEFT;
+	if(los_dark[l_i+1][l_j+1]) n|=LOS_DOWN_RIGHT;
+
+	return n;
+}
+
+
 void draw_los_buffer(BITMAP *dest, int xpos, int ypos)
 {
 	int i,j,l_i,l_j;
     int x,y,x1,y1;
+	int n;
 	
     x1=0-(xpos%TILE_SIZE);//check where on the tile map you begin to draw
     y1=0-(ypos%TILE_SIZE);
@@ -87,9 +158,13 @@ void draw_los_buffer(BITMAP *dest, int xpos, int ypos)
 	tile_pos_x = xpos/32;
 	tile_pos_y = ypos/32;
 
+	//get what the tiles around each tile are, once
+	for(i=0;i<los_w+2;i++)
+		for(j=0;j<los_h+2;j++)
+			los_dark[i][j] = los_buffer_check2(i-1,j-1)!=0;
  
-	for(i=-1;i< (virt->w/TILE_SIZE+1) ;i++)
-		for(j=-1;j< (virt->h/TILE_SIZE+1) ;j++)
+	for(i=-1;i<los_w-2;i++)
+		for(j=-1;j<los_h-2;j++)
 		{
 		  	l_i = i+1;			
 			l_j = j+1;			
@@ -101,118 +176,18 @@ void draw_los_buffer(BITMAP *dest, int xpos, int ypos)
 			}
 			else if(los_buffer[l_i][l_j]==0 && !tile_is_wall_solid(i+xpos/32, j+ypos/32))
 			{
-				
-				//--Border--//
-
-				//border right
-				if(los_buffer_check2(l_i-1,l_j) && !los_buffer_check2(l_i,l_j-1) && !los_buffer_check2(l_i,l_j+1) )
-				{
-					draw_lightsprite(dest,los_border[0][0],x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
-				}
-				
-				//border down
-				if(los_buffer_check2(l_i,l_j-1) && !los_buffer_check2(l_i-1,l_j) && !los_buffer_check2(l_i+1,l_j) )
-				{
-					draw_lightsprite(dest,los_border[0][1],x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
-				}
-				
-				//border left
-				if(los_buffer_check2(l_i+1,l_j) && !los_buffer_check2(l_i,l_j-1) && !los_buffer_check2(l_i,l_j+1) )
-				{
-					draw_lightsprite(dest,los_border[0][2],x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
-				}
-				
-				
-				//border up
-				if(los_buffer_check2(l_i,l_j+1) && !los_buffer_check2(l_i-1,l_j) && !los_buffer_check2(l_i+1,l_j) )
-				{
-					draw_lightsprite(dest,los_border[0][3],x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
-				}
-				
-				//--Inner Corner--//
+				n = get_los_neighbours(l_i, l_j);
 
-				//right
-				if(los_buffer_check2(l_i-1,l_j) && los_buffer_check2(l_i,l_j+1) && !los_buffer_check2(l_i+1,l_j) && !los_buffer_check2(l_i,l_j-1))
-				{
-					draw_lightsprite(dest,los_border[1][0],x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
-				}
-				
-				//down
-				if(los_buffer_check2(l_i-1,l_j) && los_buffer_check2(l_i,l_j-1) && !los_buffer_check2(l_i+1,l_j) && !los_buffer_check2(l_i,l_j+1))
-				{
-					draw_lightsprite(dest,los_border[1][1],x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
-				}
-				
-				//left
-				if(los_buffer_check2(l_i+1,l_j) && los_buffer_check2(l_i,l_j-1) && !los_buffer_check2(l_i-1,l_j) && !los_buffer_check2(l_i,l_j+1))
-				{
-					draw_lightsprite(dest,los_border[1][2],x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
-				}
-				
-				//up
-				if(los_buffer_check2(l_i+1,l_j) && los_buffer_check2(l_i,l_j+1) && !los_buffer_check2(l_i-1,l_j) && !los_buffer_check2(l_i,l_j-1))
-				{
-					draw_lightsprite(dest,los_border[1][3],x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
-				}
-				
-				//--Outer Corner--//
-
-				//right
-				if(los_buffer_check2(l_i-1,l_j+1) && !los_buffer_check2(l_i-1,l_j) && !los_buffer_check2(l_i,l_j+1))
-				{
-					draw_lightsprite(dest,los_border[2][0],x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
-				}
-								
-				//down
-				if(los_buffer_check2(l_i-1,l_j-1) && !los_buffer_check2(l_i-1,l_j) && !los_buffer_check2(l_i,l_j-1))
-				{
-					draw_lightsprite(dest,los_border[2][1],x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
-				}
-				
-				//left
-				if(los_buffer_check2(l_i+1,l_j-1) && !los_buffer_check2(l_i+1,l_j) && !los_buffer_check2(l_i,l_j-1))
-				{
-					draw_lightsprite(dest,los_border[2][2],x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
-				}
-				
-				//up
-				if(los_buffer_check2(l_i+1,l_j+1) && !los_buffer_check2(l_i+1,l_j) && !los_buffer_check2(l_i,l_j+1))
-				{
-					draw_lightsprite(dest,los_border[2][3],x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
-				}
-
-				//--3 Wall corner
-
-				//right
-				if(los_buffer_check2(l_i,l_j-1) && los_buffer_check2(l_i+1,l_j) && los_buffer_check2(l_i,l_j+1))
-				{
-					draw_rle_sprite(dest, tile_data[0][1].dat, x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
-				}
-				
-				//down
-				if(los_buffer_check2(l_i,l_j+1) && los_buffer_check2(l_i+1,l_j) && los_buffer_check2(l_i-1,l_j))
-				{
-					draw_rle_sprite(dest, tile_data[0][1].dat, x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
-				}
-				
-				//left
-				if(los_buffer_check2(l_i,l_j-1) && los_buffer_check2(l_i-1,l_j) && los_buffer_check2(l_i,l_j+1))
-				{
-					draw_rle_sprite(dest, tile_data[0][1].dat, x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
-				}
-				
-				//up
-				if(los_buffer_check2(l_i,l_j-1) && los_buffer_check2(l_i-1,l_j) && los_buffer_check2(l_i+1,l_j))
-				{
-					draw_rle_sprite(dest, tile_data[0][1].dat, x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
-				}
-				
+				if(los_cell_black[n])
+					dl_draw_tile(dest, 0, 1, x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
+				else if(los_cell_pic[n])
+					dl_draw_lightsprite(dest, los_cell_pic[n], x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
 			}
 			else if(los_buffer[l_i][l_j]==1)
 			{
-				draw_rle_sprite(dest, tile_data[0][1].dat, x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
+				dl_draw_tile(dest, 0, 1, x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
 				//set_trans_blender(0,0,0,180);	
-				//draw_rle_sprite(dest, tile_data[0][3].dat, x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
+				//dl_draw_rle_sprite(dest, tile_data[0][3].dat, x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
 			}
 			/*else if(los_buffer[i][j]==2)
 			{
@@ -221,19 +196,82 @@ void draw_los_buffer(BITMAP *dest, int xpos, int ypos)
 			}*/
 			
 			
-		
 		}
 }
 
 
 
+//the map has changed, all rays must be cast again
+void reset_los_buffer(void)
+{
+	set_los_size();
+	los_rays_are_valid=0;
+	reset_player_visibility();
+}
+
+
+//get the rays ready for a view starting at tile x,y. rays that can be
+//used again are kept, the others are set to -1. returns 0 if no ray has
+//changed since the last time.
+static int get_los_rays(int x, int y)
+{
+	int i,j;
+	int old_x, old_y;
+	static int temp_ray[LOS_MAX_W][LOS_MAX_H];
+	int step_x = (int)player.x/LOS_EYE_STEP;
+	int step_y = (int)player.y/LOS_EYE_STEP;
+
+	if(!los_rays_are_valid || step_x!=los_eye_step_x || step_y!=los_eye_step_y || tile_object_solidity_version!=los_solidity_version)
+	{
+		for(i=0;i<los_w;i++)
+			for(j=0;j<los_h;j++)
+				los_ray[i][j] = -1;
+
+		los_eye_step_x = step_x;
+		los_eye_step_y = step_y;
+		los_solidity_version = tile_object_solidity_version;
+		los_ray_x = x;
+		los_ray_y = y;
+		los_rays_are_valid=1;
+
+		return 1;
+	}
+
+	if(x==los_ray_x && y==los_ray_y)
+		return 0;
+
+	//the view has scrolled, move the rays with it
+	for(i=0;i<los_w;i++)
+		for(j=0;j<los_h;j++)
+		{
+			old_x = i + x-los_ray_x;
+			old_y = j + y-los_ray_y;
+
+			if(old_x<0 || old_y<0 || old_x>los_w-1 || old_y>los_h-1)
+				temp_ray[i][j] = -1;
+			else
+				temp_ray[i][j] = los_ray[old_x][old_y];
+		}
+
+	for(i=0;i<los_w;i++)
+		for(j=0;j<los_h;j++)
+			los_ray[i][j] = temp_ray[i][j];
+
+	los_ray_x = x;
+	los_ray_y = y;
+
+	return 1;
+}
+
+
+
 void update_los_buffer(int xpos, int ypos)
 {
 	int i,j;
     int x,y,x1,y1;
 	int l_i, l_j;
 
-	int temp_los_buffer[18][18];
+	static int temp_los_buffer[LOS_MAX_W][LOS_MAX_H];
 
 	int c1,c2,c3,c4;
 
@@ -247,8 +285,17 @@ void update_los_buffer(int xpos, int ypos)
 	tile_pos_x = xpos/32;
 	tile_pos_y = ypos/32;
 
-	for(i=-1;i< (virt->w/TILE_SIZE+1) ;i++)
-		for(j=-1;j< (virt->h/TILE_SIZE+1) ;j++)
+	//nothing has changed, use the last buffer
+	if(!get_los_rays(x, y))
+	{
+		for(i=0;i<los_w;i++)
+			for(j=0;j<los_h;j++)
+				los_buffer[i][j] = los_result[i][j];
+		return;
+	}
+
+	for(i=-1;i<los_w-2;i++)
+		for(j=-1;j<los_h-2;j++)
 		{
 			l_i = i+1;			
 			l_j = j+1;			
@@ -258,9 +305,12 @@ void update_los_buffer(int xpos, int ypos)
 
 			 		   
 			}
-			else if(!object_is_in_fov(player.x, player.y, player.angle,((x+i)*32)+16 ,((j+y)*32)+16 ,32,32,360,1))
+			else
 			{
-				if(!tile_is_wall_solid(i+xpos/32, j+ypos/32))
+				if(los_ray[l_i][l_j]<0)
+					los_ray[l_i][l_j] = !tile_is_visible(x+i, y+j);
+
+				if(los_ray[l_i][l_j] && !tile_is_wall_solid(i+xpos/32, j+ypos/32))
 					los_buffer[l_i][l_j]=1;
 			}
 		}
@@ -268,8 +318,8 @@ void update_los_buffer(int xpos, int ypos)
 
 	//make the check if los tils is "trapped" 
 	//if so make em black tiles
-	for(i=-1;i<17;i++)
-		for(j=-1;j<17;j++)
+	for(i=-1;i<los_w-1;i++)
+		for(j=-1;j<los_h-1;j++)
 		if(!tile_is_wall_solid(i+xpos/32, j+ypos/32) )
 		{
 			c1=0;
@@ -293,7 +343,7 @@ void update_los_buffer(int xpos, int ypos)
 			}
 
 			//right tile
-			if(l_i<17)  // Changed from <18 to <17 since we access l_i+1
+			if(l_i<los_w-1)  // the last one has no tile to the right
 			{
 				if(los_buffer[l_i+1][l_j]==1 || tile_is_wall_solid((i+1)+xpos/32, (j)+ypos/32))
 					c2=1;
@@ -304,7 +354,7 @@ void update_los_buffer(int xpos, int ypos)
 			}
 
 			//down tile
-			if(l_j<17)  // Changed from <18 to <17 since we access l_j+1
+			if(l_j<los_h-1)  // the last one has no tile below
 			{
 				if(los_buffer[l_i][l_j+1]==1 || tile_is_wall_solid((i)+xpos/32, (j+1)+ypos/32))
 					c3=1;
@@ -336,15 +386,15 @@ void update_los_buffer(int xpos, int ypos)
 		}
 
 		//set the temp_buufer
-		for(i=0;i<18;i++)
-				for(j=0;j<18;j++)
+		for(i=0;i<los_w;i++)
+				for(j=0;j<los_h;j++)
 					temp_los_buffer[i][j] = los_buffer[i][j];
 
 		
 		//check if the "black tile" is a corner or side if
 		//so make it clear at the temp buffer.
-		for(i=-1;i<17;i++)
-			for(j=-1;j<17;j++)
+		for(i=-1;i<los_w-1;i++)
+			for(j=-1;j<los_h-1;j++)
 			{
 				l_i = i+1;
 				l_j = j+1;
@@ -390,9 +440,12 @@ void update_los_buffer(int xpos, int ypos)
 			}
 
 		//the normal los buffer becomes the temp
-		for(i=0;i<18;i++)
-			for(j=0;j<18;j++)
+		for(i=0;i<los_w;i++)
+			for(j=0;j<los_h;j++)
+			{
 				los_buffer[i][j] = temp_los_buffer[i][j];
+				los_result[i][j] = temp_los_buffer[i][j];
+			}
 		
 		
 	
@@ -404,6 +457,78 @@ void update_los_buffer(int xpos, int ypos)
 #define LOS_BORDER_LENGTH 29
 
 
+//put the borders for a set of dark tiles around a tile together. uses
+//the same rules as drawing the borders one by one.
+static void make_los_cell(int n)
+{
+	int i,x,y;
+	int l  = (n&LOS_LEFT)!=0;
+	int r  = (n&LOS_RIGHT)!=0;
+	int u  = (n&LOS_UP)!=0;
+	int d  = (n&LOS_DOWN)!=0;
+	int ul = (n&LOS_UP_LEFT)!=0;
+	int ur = (n&LOS_UP_RIGHT)!=0;
+	int dl = (n&LOS_DOWN_LEFT)!=0;
+	int dr = (n&LOS_DOWN_RIGHT)!=0;
+	BITMAP *border[12];
+	int num_of_borders=0;
+
+	//--Border--// right, down, left, up
+	if(l && !u && !d) border[num_of_borders++] = los_border[0][0];
+	if(u && !l && !r) border[num_of_borders++] = los_border[0][1];
+	if(r && !u && !d) border[num_of_borders++] = los_border[0][2];
+	if(d && !l && !r) border[num_of_borders++] = los_border[0][3];
+
+	//--Inner Corner--//
+	if(l && d && !r && !u) border[num_of_borders++] = los_border[1][0];
+	if(l && u && !r && !d) border[num_of_borders++] = los_border[1][1];
+	if(r && u && !l && !d) border[num_of_borders++] = los_border[1][2];
+	if(r && d && !l && !u) border[num_of_borders++] = los_border[1][3];
+
+	//--Outer Corner--//
+	if(dl && !l && !d) border[num_of_borders++] = los_border[2][0];
+	if(ul && !l && !u) border[num_of_borders++] = los_border[2][1];
+	if(ur && !r && !u) border[num_of_borders++] = los_border[2][2];
+	if(dr && !r && !d) border[num_of_borders++] = los_border[2][3];
+
+	//--3 Wall corner, all black
+	los_cell_black[n] = (u && r && d) || (d && r && l) || (u && l && d) || (u && l && r);
+
+	los_cell_pic[n] = NULL;
+
+	if(los_cell_black[n] || num_of_borders==0)
+		return;
+
+	if(num_of_borders==1)
+	{
+		los_cell_pic[n] = border[0];
+		return;
+	}
+
+	//shading with many borders is the same as shading once with them
+	//multiplied together
+	los_cell_pic[n] = create_bitmap_ex(8,32,32);
+	
+	for(x=0;x<32;x++)
+		for(y=0;y<32;y++)
+		{
+			los_cell_pic[n]->line[y][x] = border[0]->line[y][x];
+
+			for(i=1;i<num_of_borders;i++)
+				los_cell_pic[n]->line[y][x] = (los_cell_pic[n]->line[y][x] * border[i]->line[y][x] + 15)/31;
+		}
+}
+
+
+static void make_los_cells(void)
+{
+	int i;
+
+	for(i=0;i<256;i++)
+		make_los_cell(i);
+}
+
+
 //make the line of sight gfx
 void make_los_borders(void)
 {
@@ -481,7 +606,7 @@ void make_los_borders(void)
 	draw_sprite_h_flip(los_border[2][3],los_border[2][0],0,0);
 		
 
-	
+	make_los_cells();
 }
 
 //check if an object is coverd with "black" los tiles.
@@ -489,7 +614,6 @@ int object_is_in_player_los(float x, float y, int w, int h, float angle, int sol
 {
 	int i,j;
 	int tile_x, tile_y;
-	int d_x,d_y;
 	int max;
 
 	 
@@ -497,7 +621,7 @@ int object_is_in_player_los(float x, float y, int w, int h, float angle, int sol
 		
 	if(angle==0)
 	{
-		if(!check_collision(x-w/2,y-h/2,w,h,map_x-20,map_y-20,520,520))
+		if(!check_collision(x-w/2,y-h/2,w,h,map_x-20,map_y-20,view_w+40,view_h+40))
 			return 0;
 		
 		map_tile(x-w/2, y-h/2, &tile_x, &tile_y,TILE_SIZE);
@@ -505,19 +629,15 @@ int object_is_in_player_los(float x, float y, int w, int h, float angle, int sol
 		for(i=tile_x;i<(w/32+2)+tile_x;i++)
 			for(j=tile_y;j<(h/32+2)+tile_y;j++)
 			{
-				d_x = i-map_x/32;
-				d_y = j-map_y/32;
-				
-				if(d_x>=0 && d_x<=14 && d_y>=0 && d_y<=14 && i>-1 && j>-1 && i<map->w && j<map->h)	
-					if(los_buffer[d_x][d_y]==0 )
-						//if(tile_info[(map->layer3+ (i) +( (j) * map->w))->tile_set].tile[(map->layer3+ (i) +( (j) * map->w))->tile_num].solid!=2)
-							return 1;
+				if(tile_is_visible(i, j))
+					//if(tile_info[(map->layer3+ (i) +( (j) * map->w))->tile_set].tile[(map->layer3+ (i) +( (j) * map->w))->tile_num].solid!=2)
+						return 1;
 			}
 	}
 	else
 	{
 		max = sqrt(w*w + h*h);
-		if(!check_collision(x-max/2, y-max/2, max, max, map_x, map_y, 480, 480))
+		if(!check_collision(x-max/2, y-max/2, max, max, map_x, map_y, view_w, view_h))
 			return 0;
 		
 		map_tile(x-max/2, y-max/2, &tile_x, &tile_y, TILE_SIZE);
@@ -525,14 +645,10 @@ int object_is_in_player_los(float x, float y, int w, int h, float angle, int sol
 		for(i=tile_x;i<(max/32+2)+tile_x;i++)
 			for(j=tile_y;j<(max/32+2)+tile_y;j++)
 			{
-				d_x = i-map_x/32;
-				d_y = j-map_y/32;
-				
 				if(check_angle_collision(x,y,w + 32, h + 32, angle, i*32+16, j*32+16, 32,32,0))
-					if(d_x>=0 && d_x<=15 && d_y>=0 && d_y<=15&& i>-1 && j>-1 && i<map->w && j<map->h)	
-						if(los_buffer[d_x][d_y]==0)
-							//if(tile_info[(map->layer3+ (i) +( (j) * map->w))->tile_set].tile[(map->layer3+ (i) +( (j) * map->w))->tile_num].solid!=2)
-								return 1;
+					if(tile_is_visible(i, j))
+						//if(tile_info[(map->layer3+ (i) +( (j) * map->w))->tile_set].tile[(map->layer3+ (i) +( (j) * map->w))->tile_num].solid!=2)
+							return 1;
 
 			}
 	
@@ -7,6 +7,7 @@
 
 #include <allegro.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #ifdef _WIN32
     #include <direct.h>
@@ -19,6 +20,7 @@
 #include "../grafik4.h"
 #include "../console.h"
 #include "../logger.h"
+#include "../thread.h"
 
 
 // Quick check if sounds are being loaded correctly
@@ -32,6 +34,17 @@ int lights_flashes=0;
 
 //Speed Control
 volatile int speed_counter = 0;
+volatile int interpolation_counter = 0;//how far it is to the next update
+volatile int timer_counter = 0;//counts up INTERPOLATION_STEPS times an update
+
+#define DEFAULT_BENCHMARK_FRAMES 600
+#define MAX_REPLAY_BENCHMARK_FRAMES (60*60*60) //an hour of updates
+
+#define MAX_CATCH_UP_UPDATES 5 //updates done in one go when behind, the rest are dropped
+
+#define DEFAULT_FRAME_RATE 60 //used when the refresh rate of the display is not known
+
+int max_frame_rate=0;//0 = the refresh rate of the display
 
 int fiend_load_saved_game=0;
 int fiend_new_game=0;
@@ -42,7 +55,15 @@ int fiend_new_game=0;
 void increment_speed_counter(void)
 {
  if(!csl_started)
-  speed_counter++;
+ {
+  timer_counter++;
+  interpolation_counter++;
+  if(interpolation_counter>=INTERPOLATION_STEPS)
+  {
+   interpolation_counter=0;
+   speed_counter++;
+  }
+ }
 }
 END_OF_FUNCTION(increment_speed_counter);
 
@@ -50,53 +71,143 @@ END_OF_FUNCTION(increment_speed_counter);
 
 
 
+//how many frames a second are drawn at most. without a cap they are
+//drawn at the refresh rate, unless vsync already waits for the display.
+static int get_frame_rate_cap(void)
+{
+	int rate;
+
+	if(max_frame_rate>0)
+		return max_frame_rate;
+
+	if(vsync_is_on)
+		return 0;
+
+	rate = get_refresh_rate();
+
+	return rate>0 ? rate : DEFAULT_FRAME_RATE;
+}
+
+
+//is it time to draw a new frame? if nothing was updated there is only
+//something new to draw if the frame is interpolated and the timer has moved.
+static int frame_is_due(int updated, int last_frame_step, double last_frame_time, double now)
+{
+	int rate = get_frame_rate_cap();
+
+	if(!updated && (!interpolation_is_on || timer_counter==last_frame_step))
+		return 0;
+
+	if(rate>0 && now - last_frame_time < 1.0/rate)
+		return 0;
+
+	return 1;
+}
+
+
+//sleeps until the next update or until the next frame may be drawn,
+//whichever is later. the time of the update is worked out from the
+//steps the timer has left to count.
+static void wait_for_next_frame(double last_frame_time, double now)
+{
+	double wait;
+	int rate = get_frame_rate_cap();
+
+	if(interpolation_is_on)
+		wait = 1.0/(60*INTERPOLATION_STEPS);
+	else
+		wait = (INTERPOLATION_STEPS-interpolation_counter)/(60.0*INTERPOLATION_STEPS);
+
+	if(rate>0)
+		wait = MAX(wait, last_frame_time + 1.0/rate - now);
+
+	//rest() only counts whole milliseconds, so the last part is a yield
+	if(wait>=0.001)
+		rest((int)(wait*1000));
+	else
+		rest(0);
+}
+
+
 //update the logic
 void update_game_logic(void)
 {
+	profile_begin("update");
+
+	replay_begin_update();
+
 	if(!message_active)
 	{
 		update_tile_object_height();
 		
+		profile_begin("npc");
 		update_npc();
+		profile_end();
 				
+		profile_begin("triggers");
 		check_triggers(1); 
+		profile_end();
 	
 		check_link_collison();
 		update_auto_move();
 		
 	
 		update_soundemitors();
+		profile_begin("player");
 		update_player();
+		profile_end();
+		profile_begin("objects");
 		update_objects();
 		update_door_objects();
+		profile_end();
+		profile_begin("enemy");
 		update_enemy();
+		profile_end();
 		
+		profile_begin("shells, blood, flames");
 		update_shells();
 		update_bloodpools();
-		update_missiles();
 		update_flames();
+		profile_end();
+		profile_begin("missiles");
+		update_missiles();
+		profile_end();
+		profile_begin("particles");
 		update_particles();
 		update_beams();
+		profile_end();
 
 		check_look_at_areas();
 
+		profile_begin("tiles");
 		update_tiles();
+		profile_end();
 		
 		if(inventory_is_on)update_inventory_logic();
 		
 		if(fiend_note_is_on)update_note_logic();
 
+		profile_begin("light");
 		update_normal_light();
+		profile_end();
 
-		if(RANDOM(0,100)>90)lights_flashes=0;
-		if(RANDOM(0,100)>83 || lights_flashes==1)
+		if(RANDOM_IN(RANDOM_EFFECTS, 0,100)>90)lights_flashes=0;
+		if(RANDOM_IN(RANDOM_EFFECTS, 0,100)>83 || lights_flashes==1)
 			lights_flashes=1;
 
+		profile_begin("effects");
 		update_effects();
+		profile_end();
+
+		profile_begin("spatial grid");
+		update_spatial_grid();
+		profile_end();
 	}
 	
 	// Always update sound, even during menus/messages
+	profile_begin("sound");
 	update_sound();
+	profile_end();
 
 	update_pickup_message();
 	update_engine_error();
@@ -104,6 +215,10 @@ void update_game_logic(void)
 	update_global_keys();
 
 	fiend_playtime++;	   
+
+	replay_end_update();
+
+	profile_end();
 }	
 
 
@@ -111,16 +226,192 @@ void update_game_logic(void)
 
 
 
+//load the npcs, enemies, items and such that are not in the maps
+static void load_game_data(void)
+{
+	load_npc();
+	load_enemy_data();
+	load_item_data();
+	load_global_vars();
+	load_global_triggers();
+
+	clear_player_data();
+}
+
+
+//load the map and put the player, enemies and npcs on it
+static int start_new_game(void)
+{
+	if(!load_edit_map(map, map_file))
+	{
+		allegro_message("Couldn't load map \"%s\".",map_file);
+		return 0;
+	}
+	
+	log_debug("========== MAP LOADED SUCCESSFULLY ==========");
+	log_debug("Map: %s, Size: %dx%d", map->name, map->w, map->h);
+	log_debug("Player spawn: (%.1f, %.1f) angle=%.1f", 
+		map->player_x, map->player_y, map->player_angle);
+	log_debug("Light level: %d, Outside: %d", map->light_level, map->outside);
+	log_debug("Num objects: %d, Num lights: %d", map->num_of_objects, map->num_of_lights);
+	
+	player.x = map->player_x;
+	player.y = map->player_y;
+	player.angle = map->player_angle;
+
+	speed_counter =1;
+
+	total_reset_npc_ai();
+	reset_npc_data();
+	total_reset_enemy_ai();
+	reset_enemy_data();
+	get_current_map_objects();
+	reset_shells();
+	reset_missiles();
+	reset_bloodpools();
+	reset_flames();
+	reset_particles();
+	reset_effects();
+	reset_beams();
+	check_triggers(0);  // Check triggers AFTER resetting effects so messages aren't cleared
+	update_before_map();
+
+	return 1;
+}
+
+
+static void load_saved_game(int ans)
+{
+	if(ans == 1)load_game("save/save1.sav");
+	else if(ans == 2)load_game("save/save2.sav");
+	else if(ans == 3)load_game("save/save3.sav");
+	else if(ans == 4)load_game("save/save4.sav");
+	else if(ans == 5)load_game("save/save5.sav");
+	
+	// Reset transient effects that aren't saved
+	reset_beams();
+	reset_particles();
+	reset_effects();
+}
+
+
+static int compare_times(const void *a, const void *b)
+{
+	double diff = *(const double *)a - *(const double *)b;
+
+	return diff<0 ? -1 : (diff>0 ? 1 : 0);
+}
+
+
+//run the game without a display, draw benchmark_frames frames of the
+//start map and print how long each update and frame took. the last
+//frame is saved to benchmark.bmp so it can be compared between builds.
+//when a replay is played the recorded game is run instead, to the end
+//of the replay if no number of frames is given.
+void run_benchmark(void)
+{
+	int i;
+	int ans=0;
+	int run_to_end=0;
+	int num_of_frames = benchmark_frames>0 ? benchmark_frames : DEFAULT_BENCHMARK_FRAMES;
+	double start, update_time, total_update=0;
+	double *frame_time;
+	double total_draw=0;
+
+	if(replay_mode==REPLAY_PLAY)
+	{
+		ans = replay_fiend_menu(0);
+		if(ans == -1)
+			return;
+
+		if(benchmark_frames<=0)
+		{
+			num_of_frames = MAX_REPLAY_BENCHMARK_FRAMES;
+			run_to_end = 1;
+		}
+	}
+
+	load_game_data();
+
+	if(replay_mode==REPLAY_OFF || fiend_new_game)
+	{
+		if(!start_new_game())
+			return;
+	}
+	else if(fiend_load_saved_game)
+	{
+		load_saved_game(ans);
+	}
+
+	frame_time = malloc(sizeof(double)*num_of_frames);
+	if(frame_time==NULL)
+		return;
+
+	printf("frame, update ms, draw ms\n");
+
+	for(i=0;i<num_of_frames && !game_ended;i++)
+	{
+		if(run_to_end && replay_mode==REPLAY_OFF)
+			break;
+
+		start = get_precise_time();
+		update_game_logic();
+		update_time = get_precise_time()-start;
+
+		start = get_precise_time();
+		draw_level();
+		render_thread_sync();
+		frame_time[i] = get_precise_time()-start;
+
+		profile_new_frame();
+
+		total_update += update_time;
+		total_draw += frame_time[i];
+
+		printf("%d, %.3f, %.3f\n", i, update_time*1000, frame_time[i]*1000);
+	}
+	num_of_frames = i;
+
+	if(num_of_frames>0)
+	{
+		qsort(frame_time, num_of_frames, sizeof(double), compare_times);
+
+		log_info("Benchmark: %d frames of %s", num_of_frames, map_file);
+		log_info("  update: %.3f ms avg", total_update*1000/num_of_frames);
+		log_info("  draw: %.3f ms avg, %.3f ms min, %.3f ms median, %.3f ms 99%%, %.3f ms max",
+			total_draw*1000/num_of_frames, frame_time[0]*1000, frame_time[num_of_frames/2]*1000,
+			frame_time[(num_of_frames*99)/100]*1000, frame_time[num_of_frames-1]*1000);
+
+		printf("draw avg %.3f ms, median %.3f ms, 99%% %.3f ms, max %.3f ms\n",
+			total_draw*1000/num_of_frames, frame_time[num_of_frames/2]*1000,
+			frame_time[(num_of_frames*99)/100]*1000, frame_time[num_of_frames-1]*1000);
+
+		save_bitmap("benchmark.bmp", virt, NULL);
+	}
+
+	free(frame_time);
+
+	release_map(map);
+}
+
+
 void the_game(void)
 {	
 	int ans;
+	int num_of_updates;
+	int updated;//has the logic been updated since the last frame
+	int last_frame_step;
+	double last_frame_time;
+	double now;
 	
 	//----BEGIN SPEED CONTROL--------
 	
 	LOCK_VARIABLE(speed_counter);
+	LOCK_VARIABLE(interpolation_counter);
+	LOCK_VARIABLE(timer_counter);
 	LOCK_FUNCTION(increment_speed_counter);
 
-    if(install_int_ex(increment_speed_counter, BPS_TO_TIMER(60))<0)return;
+    if(install_int_ex(increment_speed_counter, BPS_TO_TIMER(60*INTERPOLATION_STEPS))<0)return;
 	
 	//----END SPEED CONTROL--------
 	
@@ -134,18 +425,12 @@ void the_game(void)
 	show_gripdesign();
 	show_poem();
 	
-	ans = fiend_menu(0);
+	ans = replay_fiend_menu(0);
 
 	if(ans == -1)game_ended=1;
 	
 	//--Begin shit that is going to be taken away (maybe)
-	load_npc();
-	load_enemy_data();
-	load_item_data();
-	load_global_vars();
-	load_global_triggers();
-
-	clear_player_data();
+	load_game_data();
 
 	
 	
@@ -156,52 +441,12 @@ void the_game(void)
 			show_intro_text();
 		}
 		
-		if(!load_edit_map(map, map_file))
-		{
-			allegro_message("Couldn't load map \"%s\".",map_file);
+		if(!start_new_game())
 			return;
-		}
-		
-		log_debug("========== MAP LOADED SUCCESSFULLY ==========");
-		log_debug("Map: %s, Size: %dx%d", map->name, map->w, map->h);
-		log_debug("Player spawn: (%.1f, %.1f) angle=%.1f", 
-			map->player_x, map->player_y, map->player_angle);
-		log_debug("Light level: %d, Outside: %d", map->light_level, map->outside);
-		log_debug("Num objects: %d, Num lights: %d", map->num_of_objects, map->num_of_lights);
-		
-		player.x = map->player_x;
-		player.y = map->player_y;
-		player.angle = map->player_angle;
-	
-		speed_counter =1;
-	
-		total_reset_npc_ai();
-		reset_npc_data();
-		total_reset_enemy_ai();
-		reset_enemy_data();
-		get_current_map_objects();
-		reset_shells();
-		reset_missiles();
-		reset_bloodpools();
-		reset_flames();
-		reset_particles();
-		reset_effects();
-		reset_beams();
-		check_triggers(0);  // Check triggers AFTER resetting effects so messages aren't cleared
-		update_before_map();
 	}
 	else if(fiend_load_saved_game)
 	{
-		if(ans == 1)load_game("save/save1.sav");
-		else if(ans == 2)load_game("save/save2.sav");
-		else if(ans == 3)load_game("save/save3.sav");
-		else if(ans == 4)load_game("save/save4.sav");
-		else if(ans == 5)load_game("save/save5.sav");
-		
-		// Reset transient effects that aren't saved
-		reset_beams();
-		reset_particles();
-		reset_effects();
+		load_saved_game(ans);
 	}
 	
 	// Reset screen fade flag after loading
@@ -210,24 +455,63 @@ void the_game(void)
 	//--End that shit
 
 	init_frame_speed();
+
+	if(render_thread_is_on)
+		start_render_thread();
 	
 	log_debug("========== ENTERING MAIN GAME LOOP ==========");
 	log_debug("game_ended=%d, map=%p, player.x=%.1f, player.y=%.1f", 
 		game_ended, (void*)map, player.x, player.y);
 	
+	last_frame_step = timer_counter-1;
+	last_frame_time = get_precise_time();
+	updated = 0;
+
 	while(!game_ended)
 	{
+		//only the updates done in one go count against the cap
+		num_of_updates = 0;
+
 		while(speed_counter>0)
 		{
+			//if we are too far behind, skip ahead instead
+			if(num_of_updates>=MAX_CATCH_UP_UPDATES)
+			{
+				speed_counter=0;
+				break;
+			}
+
+			store_interpolation_state();
 			update_game_logic();
 		
 			speed_counter--;
+			num_of_updates++;
+			updated = 1;
+		}
+
+		//sleep until there is something new to draw
+		now = get_precise_time();
+		if(!frame_is_due(updated, last_frame_step, last_frame_time, now))
+		{
+			wait_for_next_frame(last_frame_time, now);
+			continue;
 		}
 		
+		last_frame_step = timer_counter;
+		last_frame_time = now;
+		updated = 0;
+		
+		//draw the things part of the way to the next update
+		begin_interpolated_frame((float)interpolation_counter/INTERPOLATION_STEPS);
 		draw_level();
+		end_interpolated_frame();
+
+		profile_new_frame();
 	
 	}
 
+	stop_render_thread();
+
 
 	if(game_complete) show_ending();
 
@@ -274,16 +558,30 @@ void main(int argc, char *argv[])
 		log_info("  FAILED: Could not load with backslashes");
 	}
 
-	install_mouse();
-    install_keyboard();
+	//there is no display to get the input from when headless
+	if(!headless_is_on)
+	{
+		install_mouse();
+		install_keyboard();
+	}
     install_timer();
     
-	set_window_title("Fiend");
+	if(!headless_is_on)
+		set_window_title("Fiend");
 
 	if(init_fiend()==CSLMSG_QUIT){allegro_message(fiend_errorcode);logger_cleanup();return;}
 
+	//seeds the random streams, and sets the map when replaying
+	if(replay_mode!=REPLAY_OFF)
+		start_replay();
+
 	//fiend_menu(0);
-	the_game();
+	if(headless_is_on)
+		run_benchmark();
+	else
+		the_game();
+
+	stop_replay();
 
 	log_info("Fiend shutting down...");
 	logger_cleanup();
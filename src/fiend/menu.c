@@ -15,6 +15,7 @@
 #include "../audio.h"
 #include "../grafik4.h"
 #include "../draw.h"
+#include "../present.h"
 
 
 #define FIEND_FG_COLOR makecol(255,255,255)
@@ -106,7 +107,7 @@ int play_menu_sound(char *name, int loop)
 	//if the sound has more then one alternative (num>1) randomize between em
 	if(sound_info[num].num>1)
 	{
-		temp = RANDOM(0,sound_info[num].num-1);
+		temp = RANDOM_IN(RANDOM_SOUND, 0,sound_info[num].num-1);
 		num+=temp;
 	}
 	
@@ -461,7 +462,7 @@ static void update_menu_gfx(void)
 	
 	//if(vsync_is_on)vsync();
 	//acquire_screen();
-	blit(virt,screen,0,0,80,0,virt->w,virt->h);
+	present_blit(virt,0,0,view_x,view_y,virt->w,virt->h);
 
 }
 
@@ -886,6 +887,8 @@ int fiend_menu(int in_game)
 {
 	int ans,i;
 
+	render_thread_sync();
+
 	menu_in_game = in_game;
 
 	pause_fiend_music();
@@ -13,6 +13,7 @@
 #include "../fiend.h"
 #include "../grafik4.h"
 #include "../draw.h"
+#include "../draw_list.h"
 
 
 //Gloabal vars that can trigger events
@@ -56,6 +57,7 @@ void make_new_missile(int x, int y, float angle, int type)
 	missile_data[data_num].p_type=p_type;
 	
 	missile_data[data_num].used=1;
+	reset_missile_interpolation(data_num);
 	
 	missile_data[data_num].x=x;
 	missile_data[data_num].y=y;
@@ -347,7 +349,7 @@ void update_missiles(void)
 						enemy_ai[k].damage_taken+=temp;
 
 						//if the player is in fov, attack!!!
-						if(object_is_in_fov(enemy_data[k].x, enemy_data[k].y, enemy_data[k].angle, player.x, player.y, char_info[0].w, char_info[0].h, 360,5))
+						if(player_is_in_fov(enemy_data[k].x, enemy_data[k].y, enemy_data[k].angle, 360))
 						{
 							enemy_ai[k].found_player=FOUND_LENGTH;
 							enemy_ai[k].last_player_x = player.x;
@@ -389,27 +391,27 @@ void draw_missiles(void)
 				if(particle_info[p_type].aa)
 				{
 					//set_alpha_blender();
-					draw_additive_sprite(virt,particle_info[p_type].pic[missile_data[i].frame].dat, 
+					dl_draw_additive_sprite(virt,particle_info[p_type].pic[missile_data[i].frame].dat, 
 						missile_data[i].x - get_bitmap_w(particle_info[p_type].pic[missile_data[i].frame].dat)/2-map_x,
 						missile_data[i].y - get_bitmap_h(particle_info[p_type].pic[missile_data[i].frame].dat)/2-map_y);
 				}
 				else if(particle_info[p_type].trans)
 				{	
-					set_trans_blender(0,0,0,particle_info[p_type].trans_alpha);
-					draw_trans_sprite(virt,particle_info[p_type].pic[missile_data[i].frame].dat, 
+					dl_draw_blend_sprite(virt,particle_info[p_type].pic[missile_data[i].frame].dat, 
 						missile_data[i].x - get_bitmap_w(particle_info[p_type].pic[missile_data[i].frame].dat)/2-map_x,
-						missile_data[i].y - get_bitmap_h(particle_info[p_type].pic[missile_data[i].frame].dat)/2-map_y);
+						missile_data[i].y - get_bitmap_h(particle_info[p_type].pic[missile_data[i].frame].dat)/2-map_y,
+						particle_info[p_type].trans_alpha);
 				}	
 				else if(particle_info[p_type].rotate)
 				{	
-					rotate_sprite(virt,particle_info[p_type].pic[missile_data[i].frame].dat, 
+					dl_rotate_sprite(virt,particle_info[p_type].pic[missile_data[i].frame].dat, 
 						missile_data[i].x - get_bitmap_w(particle_info[p_type].pic[missile_data[i].frame].dat)/2-map_x,
 						missile_data[i].y - get_bitmap_h(particle_info[p_type].pic[missile_data[i].frame].dat)/2-map_y,
 						degree_to_fixed(missile_data[i].angle));
 				}
 				else 
 				{
-					draw_sprite(virt,particle_info[p_type].pic[missile_data[i].frame].dat, 
+					dl_draw_sprite(virt,particle_info[p_type].pic[missile_data[i].frame].dat, 
 						missile_data[i].x - get_bitmap_w(particle_info[p_type].pic[missile_data[i].frame].dat)/2-map_x,
 						missile_data[i].y - get_bitmap_h(particle_info[p_type].pic[missile_data[i].frame].dat)/2-map_y);
 				}
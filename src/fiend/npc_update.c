@@ -454,12 +454,12 @@ void update_npc_data(int num)
 		{
 
 			//if(distance(player.x, player.y, npc_data[num].x, npc_data[num].y)<HEAR_RANGE)
-			//	npc_ai[num].panic=RANDOM(300,400);
+			//	npc_ai[num].panic=RANDOM_IN(RANDOM_AI, 300,400);
 		}
 		if(npc_damaged)
 		{
 			///if(object_is_in_fov(npc_data[num].x, npc_data[num].y,npc_data[num].angle, npc_data[npc_damaged].x, npc_data[npc_damaged].y,char_info[type].w,char_info[type].h,360,5))
-			//	npc_ai[num].panic=RANDOM(450,600);
+			//	npc_ai[num].panic=RANDOM_IN(RANDOM_AI, 450,600);
 		}
 	
 		/*for(j=0;j<current_map_enemy_num;j++)
@@ -469,7 +469,7 @@ void update_npc_data(int num)
 				if(distance(enemy_data[i].x, enemy_data[i].y,npc_data[num].x, npc_data[num].y)<300 ) 
 					if(object_is_in_fov(npc_data[num].x, npc_data[num].y, npc_data[num].angle, enemy_data[i].x, enemy_data[i].y, enemy_info[enemy_data[i].type].w, enemy_info[enemy_data[i].type].h,360,5)) 
 					{
-						npc_ai[num].panic=RANDOM(450,600);
+						npc_ai[num].panic=RANDOM_IN(RANDOM_AI, 450,600);
 						break;
 					}
 							
@@ -490,8 +490,8 @@ void update_npc_data(int num)
 		
 			do
 			{
-				npc_ai[num].panic_x = RANDOM(0,map->w*TILE_SIZE);
-				npc_ai[num].panic_y = RANDOM(0,map->h*TILE_SIZE);
+				npc_ai[num].panic_x = RANDOM_IN(RANDOM_AI, 0,map->w*TILE_SIZE);
+				npc_ai[num].panic_y = RANDOM_IN(RANDOM_AI, 0,map->h*TILE_SIZE);
 
 			}
 			while(check_npc_collision(npc_ai[num].panic_x, npc_ai[num].panic_y, num));
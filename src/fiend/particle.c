@@ -14,6 +14,7 @@
 
 #include "../fiend.h"
 #include "../draw.h"
+#include "../draw_list.h"
 #include "../grafik4.h"
 #include "../path_utils.h"
 
@@ -64,7 +65,7 @@ void make_new_particle(char *name, float x, float y, float angle, float speed,fl
 			break;
 	
 	if(i>MAX_PARTICLE_DATA-1)
-		i = RANDOM(0,MAX_PARTICLE_DATA-1);
+		i = RANDOM_IN(RANDOM_PARTICLES, 0,MAX_PARTICLE_DATA-1);
 
 	particle_data[i].blood = 0;
 	
@@ -72,6 +73,7 @@ void make_new_particle(char *name, float x, float y, float angle, float speed,fl
 		particle_data[i].blood = blood;
 	
 	particle_data[i].used = 1;
+	reset_particle_interpolation(i);
 	particle_data[i].type = type;
 	
 	particle_data[i].x = x;
@@ -112,7 +114,7 @@ void update_particles(void)
 			particle_data[i].speed-=particle_data[i].speed_dec;
 			if(particle_data[i].speed<0)particle_data[i].speed=0;
 
-			if(particle_data[i].blood==1 && RANDOM(1,13)==1)
+			if(particle_data[i].blood==1 && RANDOM_IN(RANDOM_PARTICLES, 1,13)==1)
 			{
 				make_new_particle("blood_child",particle_data[i].x, particle_data[i].y,0,0,0, 20,2,particle_data[i].color);
 			}
@@ -171,33 +173,33 @@ void draw_particles(int level)
 				
 				if(particle_data[i].blood)
 				{
-					//set_trans_blender(0,0,0,128);
-					putpixel(virt,particle_data[i].x-map_x,particle_data[i].y-map_y,particle_data[i].color);
+					//dl_set_trans_blender(0,0,0,128);
+					dl_putpixel(virt,particle_data[i].x-map_x,particle_data[i].y-map_y,particle_data[i].color);
 					//circlefill(virt,particle_data[i].x,particle_data[i].y,10,makecol(200,0,0));
 				}
 				else if(particle_info[type].aa)
 				{
-					draw_additive_sprite(virt,particle_info[type].pic[pic_num].dat, 
+					dl_draw_additive_sprite(virt,particle_info[type].pic[pic_num].dat, 
 						particle_data[i].x - get_bitmap_w(particle_info[type].pic[pic_num].dat)/2-map_x,
 						particle_data[i].y - get_bitmap_h(particle_info[type].pic[pic_num].dat)/2-map_y);
 				}
 				else if(particle_info[type].trans)
 				{
-					set_trans_blender(0,0,0,particle_info[type].trans_alpha);
-					draw_trans_sprite(virt,particle_info[type].pic[pic_num].dat, 
+					dl_draw_blend_sprite(virt,particle_info[type].pic[pic_num].dat, 
 						particle_data[i].x - get_bitmap_w(particle_info[type].pic[pic_num].dat)/2-map_x,
-						particle_data[i].y - get_bitmap_h(particle_info[type].pic[pic_num].dat)/2-map_y);
+						particle_data[i].y - get_bitmap_h(particle_info[type].pic[pic_num].dat)/2-map_y,
+						particle_info[type].trans_alpha);
 				}	
 				else if(particle_info[type].rotate)
 				{
-					rotate_sprite(virt,particle_info[type].pic[pic_num].dat, 
+					dl_rotate_sprite(virt,particle_info[type].pic[pic_num].dat, 
 						particle_data[i].x - get_bitmap_w(particle_info[type].pic[pic_num].dat)/2-map_x,
 						particle_data[i].y - get_bitmap_h(particle_info[type].pic[pic_num].dat)/2-map_y,
 						degree_to_fixed(particle_data[i].angle));
 				}
 				else 
 				{
-				draw_sprite(virt,particle_info[type].pic[pic_num].dat, 
+				dl_draw_sprite(virt,particle_info[type].pic[pic_num].dat, 
 					particle_data[i].x - get_bitmap_w(particle_info[type].pic[pic_num].dat)/2-map_x,
 					particle_data[i].y - get_bitmap_h(particle_info[type].pic[pic_num].dat)/2-map_y);
 				}
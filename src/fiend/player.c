@@ -15,6 +15,7 @@
 #include "../fiend.h"
 #include "../grafik4.h"
 #include "../console.h"
+#include "../present.h"
 
 
 //some gloabals
@@ -432,10 +433,13 @@ void player_death(void)
 	
 	float alpha=0;
 	int ans;
+
+	render_thread_sync();
 	
 	
 	
 	clear(screen);
+	present_screen();
 
 	stop_all_sounds();
 	stop_fiend_music();
@@ -480,10 +484,10 @@ void player_death(void)
 		clear(virt);
 		textout_centre_ex(virt,font_avalon2->dat,"Y o u   d i e d", 220,240,makecol((alpha/255)*200,(alpha/255)*30,(alpha/255)*30), -1);
 	
-		blit(virt,screen,0,0,80,0,480,480);
+		present_blit(virt, 0, 0, view_x, view_y, view_w, view_h);
 	}
 
-	ans = fiend_menu(0);
+	ans = replay_fiend_menu(0);
 
 	if(ans ==-1) game_ended = 1;
 		
@@ -567,6 +571,7 @@ void update_global_keys(void)
     {
 		if(debug_is_on)
 		{
+			render_thread_sync();
 			csl_start(NULL,0);
 			return;
 		}
@@ -575,7 +580,7 @@ void update_global_keys(void)
 	if(!key[KEY_ESC] && esc_down)esc_down =0;
 	if(key[KEY_ESC] && !esc_down)
 	{
-		ans = fiend_menu(1);
+		ans = replay_fiend_menu(1);
 
 		if(ans ==-1) game_ended = 1;
 		
@@ -1343,8 +1348,8 @@ void update_player(void)
 	
 
 
-	map_x = player.x - 240;
-	map_y = player.y - 240;
+	map_x = player.x - view_w/2;
+	map_y = player.y - view_h/2;
 	
 	
 }
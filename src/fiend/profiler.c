@@ -0,0 +1,238 @@
+////////////////////////////////////////////////////
+// This file contains the timing of the parts of a
+// frame. The parts are timed between profile_begin
+// and profile_end, and parts inside another part are
+// kept under it. The times are shown on the screen
+// as the average and the worst of the last frames,
+// and the last timings can be saved as a trace that
+// the chrome://tracing page can show.
+///////////////////////////////////////////////////
+
+
+#include <stdio.h>
+#include <string.h>
+
+#include <allegro.h>
+
+#include "../fiend.h"
+#include "../grafik4.h"
+#include "../thread.h"
+#include "profiler.h"
+
+
+typedef struct
+{
+	const char *name;
+	int parent;
+	int depth;
+
+	double frame_time;//in this frame
+	double total_time;//in the frames since the last average
+	double max_time;
+
+	double avg_shown;
+	double max_shown;
+}PROFILE_ZONE;
+
+
+typedef struct
+{
+	int zone;
+	double start;
+	double time;
+}PROFILE_EVENT;
+
+
+int profiler_is_on=0;
+
+static PROFILE_ZONE zone[PROFILE_MAX_ZONES];
+static int num_of_zones=0;
+
+//the parts that are being timed
+static int stack_zone[PROFILE_MAX_DEPTH];
+static double stack_start[PROFILE_MAX_DEPTH];
+static int stack_depth=0;
+
+static PROFILE_EVENT event[PROFILE_MAX_EVENTS];
+static int next_event=0;
+static int num_of_events=0;
+
+static int num_of_frames=0;
+static double start_time=0;
+
+
+
+//the zone with the name under the parent, a new one if there is none
+static int get_zone(const char *name, int parent)
+{
+	int i;
+
+	for(i=0;i<num_of_zones;i++)
+		if(zone[i].parent==parent && (zone[i].name==name || strcmp(zone[i].name,name)==0))
+			return i;
+
+	if(num_of_zones>=PROFILE_MAX_ZONES)
+		return -1;
+
+	memset(&zone[num_of_zones], 0, sizeof(PROFILE_ZONE));
+	zone[num_of_zones].name = name;
+	zone[num_of_zones].parent = parent;
+	zone[num_of_zones].depth = parent<0 ? 0 : zone[parent].depth+1;
+
+	return num_of_zones++;
+}
+
+
+
+void reset_profiler(void)
+{
+	num_of_zones=0;
+	stack_depth=0;
+	next_event=0;
+	num_of_events=0;
+	num_of_frames=0;
+	start_time = get_precise_time();
+}
+
+
+void profile_begin(const char *name)
+{
+	int parent;
+
+	if(!profiler_is_on)
+		return;
+
+	if(stack_depth>=PROFILE_MAX_DEPTH)
+	{
+		stack_depth++;
+		return;
+	}
+
+	parent = stack_depth>0 ? stack_zone[stack_depth-1] : -1;
+
+	stack_zone[stack_depth] = parent<0 && stack_depth>0 ? -1 : get_zone(name, parent);
+	stack_start[stack_depth] = get_precise_time();
+	stack_depth++;
+}
+
+
+void profile_end(void)
+{
+	double time;
+	int i;
+
+	//the profiler was turned on inside a part
+	if(stack_depth<=0)
+		return;
+
+	stack_depth--;
+	if(stack_depth>=PROFILE_MAX_DEPTH || stack_zone[stack_depth]<0)
+		return;
+
+	i = stack_zone[stack_depth];
+	time = get_precise_time() - stack_start[stack_depth];
+
+	zone[i].frame_time += time;
+
+	event[next_event].zone = i;
+	event[next_event].start = stack_start[stack_depth];
+	event[next_event].time = time;
+	next_event = (next_event+1)%PROFILE_MAX_EVENTS;
+	if(num_of_events<PROFILE_MAX_EVENTS)num_of_events++;
+}
+
+
+//add up the times of the frame that has been drawn
+void profile_new_frame(void)
+{
+	int i;
+
+	if(!profiler_is_on)
+		return;
+
+	stack_depth=0;
+
+	for(i=0;i<num_of_zones;i++)
+	{
+		zone[i].total_time += zone[i].frame_time;
+		if(zone[i].frame_time > zone[i].max_time)
+			zone[i].max_time = zone[i].frame_time;
+		zone[i].frame_time = 0;
+	}
+
+	num_of_frames++;
+	if(num_of_frames<PROFILE_AVG_FRAMES)
+		return;
+
+	for(i=0;i<num_of_zones;i++)
+	{
+		zone[i].avg_shown = zone[i].total_time/num_of_frames;
+		zone[i].max_shown = zone[i].max_time;
+		zone[i].total_time = 0;
+		zone[i].max_time = 0;
+	}
+
+	num_of_frames=0;
+}
+
+
+
+//the zones are shown with the parts of a zone under it
+static int draw_zone(BITMAP *dest, int parent, int y)
+{
+	int i;
+
+	for(i=0;i<num_of_zones;i++)
+	{
+		if(zone[i].parent!=parent)
+			continue;
+
+		textprintf_ex(dest, font_small1->dat, 4+zone[i].depth*8, y, makecol(255,255,255), makecol(0,0,0),
+			"%s %.2f ms (%.2f)", zone[i].name, zone[i].avg_shown*1000, zone[i].max_shown*1000);
+		y += 10;
+
+		y = draw_zone(dest, i, y);
+	}
+
+	return y;
+}
+
+
+void draw_profiler(BITMAP *dest)
+{
+	if(!profiler_is_on)
+		return;
+
+	draw_zone(dest, -1, 20);
+}
+
+
+
+//save the last timings as json for chrome://tracing. returns 0 on error.
+int save_profile_trace(char *file)
+{
+	FILE *f;
+	int i;
+	int num;
+
+	f = fopen(file, "w");
+	if(f==NULL)
+		return 0;
+
+	fprintf(f, "{\"traceEvents\":[\n");
+
+	for(i=0;i<num_of_events;i++)
+	{
+		num = (next_event - num_of_events + i + PROFILE_MAX_EVENTS)%PROFILE_MAX_EVENTS;
+
+		fprintf(f, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.1f,\"dur\":%.1f}%s\n",
+			zone[event[num].zone].name, (event[num].start-start_time)*1000000, event[num].time*1000000,
+			i<num_of_events-1 ? "," : "");
+	}
+
+	fprintf(f, "]}\n");
+
+	fclose(f);
+
+	return 1;
+}
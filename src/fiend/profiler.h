@@ -0,0 +1,21 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#define PROFILE_MAX_ZONES 64
+#define PROFILE_MAX_DEPTH 16
+#define PROFILE_MAX_EVENTS 65536 //the trace keeps the last this many timings
+#define PROFILE_AVG_FRAMES 60 //the overlay shows the times of this many frames
+
+extern int profiler_is_on;
+
+
+void profile_begin(const char *name);
+void profile_end(void);
+void profile_new_frame(void);
+
+void reset_profiler(void);
+
+void draw_profiler(BITMAP *dest);
+int save_profile_trace(char *file);
+
+#endif
@@ -0,0 +1,247 @@
+////////////////////////////////////////////////////
+// This file contains the render thread. The world part
+// of a frame is saved in a draw list and drawn by the
+// thread into its own buffer while the game logic goes
+// on with the next frame. There are two lists, one that
+// is being drawn and one that is being made.
+//
+// The thread only draws to the world buffer and the
+// light mask. Everything that uses the screen, virt or
+// the allegro blenders outside of draw_level must call
+// render_thread_sync first.
+///////////////////////////////////////////////////
+
+
+#include <allegro.h>
+
+#include "../fiend.h"
+#include "../draw_list.h"
+#include "../logger.h"
+#include "render_thread.h"
+#include "../thread.h"
+
+
+int render_thread_is_on=0;
+
+
+static FIEND_THREAD *thread=NULL;
+static FIEND_SEMAPHORE *start_sem=NULL;//a list is ready to be drawn
+static FIEND_SEMAPHORE *done_sem=NULL;//the list has been drawn
+static FIEND_MUTEX *scratch_mutex=NULL;
+
+static DRAW_LIST draw_list[2];
+static int next_list=0;
+
+static DRAW_LIST *drawing_list=NULL;//in use by the thread
+static DRAW_LIST *recorded_list=NULL;//made but not yet given to the thread
+
+static int thread_quit=0;
+
+//the world buffer has not got the world from the last frame
+static int world_is_old=1;
+
+static BITMAP *world_buffer=NULL;
+
+
+
+static void lock_scratch(void)
+{
+	lock_fiend_mutex(scratch_mutex);
+}
+
+static void unlock_scratch(void)
+{
+	unlock_fiend_mutex(scratch_mutex);
+}
+
+
+static void render_thread_func(void *arg)
+{
+	while(1)
+	{
+		fiend_semaphore_wait(start_sem);
+
+		if(thread_quit)
+			break;
+
+		dl_replay(drawing_list);
+
+		fiend_semaphore_post(done_sem);
+	}
+}
+
+
+//wait for the thread to draw its list
+static void wait_for_render_thread(void)
+{
+	if(drawing_list==NULL)
+		return;
+
+	fiend_semaphore_wait(done_sem);
+
+	dl_clear(drawing_list);
+	drawing_list = NULL;
+}
+
+
+
+int start_render_thread(void)
+{
+	if(thread)
+		return 1;
+
+	world_buffer = create_bitmap_ex(bitmap_color_depth(virt), virt->w, virt->h);
+	start_sem = create_fiend_semaphore(0);
+	done_sem = create_fiend_semaphore(0);
+	scratch_mutex = create_fiend_mutex();
+
+	if(world_buffer==NULL || start_sem==NULL || done_sem==NULL || scratch_mutex==NULL)
+	{
+		log_warning("render thread: could not make the buffers");
+		stop_render_thread();
+		return 0;
+	}
+
+	clear(world_buffer);
+
+	dl_lock_scratch = lock_scratch;
+	dl_unlock_scratch = unlock_scratch;
+	dl_defer_destroy=1;
+
+	thread_quit=0;
+	world_is_old=1;
+
+	thread = create_fiend_thread(render_thread_func, NULL);
+
+	if(thread==NULL)
+	{
+		log_warning("render thread: could not start the thread");
+		stop_render_thread();
+		return 0;
+	}
+
+	log_info("render thread started");
+
+	return 1;
+}
+
+
+void stop_render_thread(void)
+{
+	if(thread)
+	{
+		render_thread_sync();
+
+		thread_quit=1;
+		fiend_semaphore_post(start_sem);
+		join_fiend_thread(thread);
+		thread=NULL;
+
+		log_info("render thread stopped");
+	}
+
+	dl_defer_destroy=0;
+	dl_lock_scratch = NULL;
+	dl_unlock_scratch = NULL;
+
+	dl_release(&draw_list[0]);
+	dl_release(&draw_list[1]);
+
+	if(world_buffer)destroy_bitmap(world_buffer);
+	if(start_sem)destroy_fiend_semaphore(start_sem);
+	if(done_sem)destroy_fiend_semaphore(done_sem);
+	if(scratch_mutex)destroy_fiend_mutex(scratch_mutex);
+
+	world_buffer=NULL;
+	start_sem=NULL;
+	done_sem=NULL;
+	scratch_mutex=NULL;
+}
+
+
+int render_thread_is_running(void)
+{
+	return thread!=NULL;
+}
+
+
+
+//draw the world part of a frame to virt. with the thread running the
+//world is saved in a list that the thread draws while the game goes on,
+//and virt gets the world of the frame before.
+void render_world(void (*draw_world)(void))
+{
+	DRAW_LIST *list;
+	BITMAP *temp_virt;
+
+	if(thread==NULL)
+	{
+		draw_world();
+		return;
+	}
+
+	list = &draw_list[next_list];
+	next_list = !next_list;
+
+	//the world functions draws to virt, save them for the world buffer
+	temp_virt = virt;
+	virt = world_buffer;
+
+	dl_begin(list);
+	draw_world();
+	dl_end();
+
+	virt = temp_virt;
+
+	if(drawing_list)
+	{
+		wait_for_render_thread();
+	}
+	else if(world_is_old)//nothing to show yet, draw this one at once
+	{
+		dl_replay(list);
+		dl_clear(list);
+		list = NULL;
+		world_is_old=0;
+	}
+
+	blit(world_buffer, virt, 0, 0, 0, 0, virt->w, virt->h);
+
+	recorded_list = list;
+}
+
+
+//let the thread draw the list made in render_world. called when virt is
+//on screen, so that the thread and the hud don't use the blenders at the
+//same time.
+void render_thread_submit(void)
+{
+	if(recorded_list==NULL)
+		return;
+
+	drawing_list = recorded_list;
+	recorded_list = NULL;
+
+	fiend_semaphore_post(start_sem);
+}
+
+
+//wait until the thread is done and throw away what it has not drawn.
+//the next frame is drawn at once.
+void render_thread_sync(void)
+{
+	if(thread==NULL)
+		return;
+
+	wait_for_render_thread();
+
+	if(recorded_list)
+	{
+		dl_clear(recorded_list);
+		recorded_list = NULL;
+	}
+
+	dl_flush_garbage();
+
+	world_is_old=1;
+}
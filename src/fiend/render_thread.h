@@ -0,0 +1,20 @@
+#include <allegro.h>
+
+
+#ifndef RENDER_THREAD_H
+#define RENDER_THREAD_H
+
+
+extern int render_thread_is_on;
+
+
+int start_render_thread(void);
+void stop_render_thread(void);
+int render_thread_is_running(void);
+
+void render_world(void (*draw_world)(void));
+void render_thread_submit(void);
+void render_thread_sync(void);
+
+
+#endif
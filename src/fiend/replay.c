@@ -0,0 +1,362 @@
+////////////////////////////////////////////////////
+// This file contains the recording and replaying of
+// games. The seed of the random streams, the keys
+// that are down at every logic update and the menu
+// choices are saved, so that a game can be played
+// again update by update. A hash of the game state
+// is saved after each update, when replaying it is
+// checked so that it shows where a replay goes
+// another way than the recorded game.
+///////////////////////////////////////////////////
+
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <allegro.h>
+
+#include "../fiend.h"
+#include "../grafik4.h"
+#include "../logger.h"
+#include "replay.h"
+
+
+#define REPLAY_ID "FIENDRP1"
+
+//the kinds of records in the file
+#define REPLAY_KEYS 0
+#define REPLAY_MENU 1
+#define REPLAY_HASH 2
+
+extern int fiend_new_game;
+extern int fiend_load_saved_game;
+extern int key_reload;
+
+
+typedef struct
+{
+	char id[8];
+	unsigned int seed;
+	char map_file[80];
+}REPLAY_HEADER;
+
+
+typedef struct
+{
+	int type;
+	int value[3];
+}REPLAY_ENTRY;
+
+
+int replay_mode=REPLAY_OFF;
+char replay_file[256];
+
+static FILE *replay_f=NULL;
+
+static int num_of_updates=0;
+static int num_of_mismatches=0;
+
+
+
+//the keys that are saved, the esc key brings up the menu
+static int get_replay_key(int num)
+{
+	switch(num)
+	{
+	case 0: return key_forward;
+	case 1: return key_backward;
+	case 2: return key_left;
+	case 3: return key_right;
+	case 4: return key_attack;
+	case 5: return key_action;
+	case 6: return key_pickup;
+	case 7: return key_inventory;
+	case 8: return key_strafe;
+	case 9: return key_reload;
+	case 10: return KEY_ESC;
+	default: return -1;
+	}
+}
+
+
+static void write_record(int type, int value0, int value1, int value2)
+{
+	REPLAY_ENTRY record;
+
+	record.type = type;
+	record.value[0] = value0;
+	record.value[1] = value1;
+	record.value[2] = value2;
+
+	fwrite(&record, sizeof(REPLAY_ENTRY), 1, replay_f);
+}
+
+
+//read the next record, it must be of the type given. if the file has
+//ended or the type is wrong the replay is stopped.
+static int read_record(int type, REPLAY_ENTRY *record)
+{
+	if(fread(record, sizeof(REPLAY_ENTRY), 1, replay_f)!=1)
+	{
+		stop_replay();
+		return 0;
+	}
+
+	if(record->type!=type)
+	{
+		log_warning("replay: the game went another way after %d updates", num_of_updates);
+		stop_replay();
+		return 0;
+	}
+
+	return 1;
+}
+
+
+
+//FNV-1a
+static unsigned int hash_bytes(unsigned int hash, void *data, int size)
+{
+	unsigned char *byte = data;
+	int i;
+
+	for(i=0;i<size;i++)
+	{
+		hash ^= byte[i];
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+
+//a hash of the things the logic updates
+unsigned int get_game_state_hash(void)
+{
+	unsigned int hash = 2166136261u;
+	unsigned int state;
+	int i;
+
+	hash = hash_bytes(hash, &player.x, sizeof(float));
+	hash = hash_bytes(hash, &player.y, sizeof(float));
+	hash = hash_bytes(hash, &player.angle, sizeof(float));
+	hash = hash_bytes(hash, &player.energy, sizeof(int));
+	hash = hash_bytes(hash, &map_x, sizeof(int));
+	hash = hash_bytes(hash, &map_y, sizeof(int));
+
+	for(i=0;i<MAX_ENEMY_DATA;i++)
+		if(enemy_data[i].used && enemy_data[i].active)
+		{
+			hash = hash_bytes(hash, &i, sizeof(int));
+			hash = hash_bytes(hash, &enemy_data[i].x, sizeof(float));
+			hash = hash_bytes(hash, &enemy_data[i].y, sizeof(float));
+			hash = hash_bytes(hash, &enemy_data[i].angle, sizeof(float));
+			hash = hash_bytes(hash, &enemy_data[i].energy, sizeof(float));
+			hash = hash_bytes(hash, &enemy_data[i].action, sizeof(int));
+		}
+
+	for(i=0;i<MAX_NPC_NUM;i++)
+		if(npc_data[i].used && npc_data[i].active)
+		{
+			hash = hash_bytes(hash, &i, sizeof(int));
+			hash = hash_bytes(hash, &npc_data[i].x, sizeof(float));
+			hash = hash_bytes(hash, &npc_data[i].y, sizeof(float));
+			hash = hash_bytes(hash, &npc_data[i].angle, sizeof(float));
+		}
+
+	for(i=0;i<MAX_MISSILES;i++)
+		if(missile_data[i].used)
+		{
+			hash = hash_bytes(hash, &i, sizeof(int));
+			hash = hash_bytes(hash, &missile_data[i].x, sizeof(float));
+			hash = hash_bytes(hash, &missile_data[i].y, sizeof(float));
+		}
+
+	//the sound stream is left out, the sounds are not played when the
+	//sound is off or headless and they do not change the game.
+	for(i=0;i<RANDOM_STREAM_NUM;i++)
+	{
+		if(i==RANDOM_SOUND)
+			continue;
+
+		state = get_random_state(i);
+		hash = hash_bytes(hash, &state, sizeof(unsigned int));
+	}
+
+	return hash;
+}
+
+
+
+//open replay_file for recording or replaying, as replay_mode says.
+//the random streams are seeded from the file, so this must be done
+//before the game is started. returns 0 on error.
+int start_replay(void)
+{
+	REPLAY_HEADER header;
+
+	num_of_updates=0;
+	num_of_mismatches=0;
+
+	if(replay_mode==REPLAY_RECORD)
+	{
+		replay_f = fopen(replay_file, "wb");
+		if(replay_f==NULL)
+		{
+			log_error("replay: couldn't create \"%s\"", replay_file);
+			replay_mode = REPLAY_OFF;
+			return 0;
+		}
+
+		memset(&header, 0, sizeof(REPLAY_HEADER));
+		memcpy(header.id, REPLAY_ID, 8);
+		header.seed = time(NULL);
+		strcpy(header.map_file, map_file);
+
+		fwrite(&header, sizeof(REPLAY_HEADER), 1, replay_f);
+
+		seed_random(header.seed);
+
+		log_info("replay: recording to \"%s\"", replay_file);
+	}
+	else if(replay_mode==REPLAY_PLAY)
+	{
+		replay_f = fopen(replay_file, "rb");
+		if(replay_f==NULL)
+		{
+			log_error("replay: couldn't open \"%s\"", replay_file);
+			replay_mode = REPLAY_OFF;
+			return 0;
+		}
+
+		if(fread(&header, sizeof(REPLAY_HEADER), 1, replay_f)!=1 || memcmp(header.id, REPLAY_ID, 8)!=0)
+		{
+			log_error("replay: \"%s\" is not a replay", replay_file);
+			fclose(replay_f);
+			replay_f = NULL;
+			replay_mode = REPLAY_OFF;
+			return 0;
+		}
+
+		strcpy(map_file, header.map_file);
+
+		seed_random(header.seed);
+
+		log_info("replay: playing \"%s\"", replay_file);
+	}
+
+	return 1;
+}
+
+
+void stop_replay(void)
+{
+	int i;
+
+	if(replay_f==NULL)
+		return;
+
+	fclose(replay_f);
+	replay_f = NULL;
+
+	//let go of the keys the replay held down
+	if(replay_mode==REPLAY_PLAY)
+		for(i=0;get_replay_key(i)>=0;i++)
+			key[get_replay_key(i)] = 0;
+
+	if(replay_mode==REPLAY_PLAY)
+		log_info("replay: played %d updates, %d with another state than recorded", num_of_updates, num_of_mismatches);
+	else
+		log_info("replay: recorded %d updates", num_of_updates);
+
+	replay_mode = REPLAY_OFF;
+}
+
+
+
+//save the keys that are down, or set them from the replay
+void replay_begin_update(void)
+{
+	REPLAY_ENTRY record;
+	int i;
+	int keys=0;
+
+	if(replay_mode==REPLAY_RECORD)
+	{
+		for(i=0;get_replay_key(i)>=0;i++)
+			if(key[get_replay_key(i)])
+				keys |= 1<<i;
+
+		write_record(REPLAY_KEYS, keys, 0, 0);
+	}
+	else if(replay_mode==REPLAY_PLAY)
+	{
+		if(!read_record(REPLAY_KEYS, &record))
+			return;
+
+		for(i=0;get_replay_key(i)>=0;i++)
+			key[get_replay_key(i)] = (record.value[0] & (1<<i)) ? 1 : 0;
+	}
+}
+
+
+//save the hash of the state, or check it against the replay
+void replay_end_update(void)
+{
+	REPLAY_ENTRY record;
+	unsigned int hash;
+
+	if(replay_mode==REPLAY_OFF)
+		return;
+
+	hash = get_game_state_hash();
+
+	if(replay_mode==REPLAY_RECORD)
+	{
+		write_record(REPLAY_HASH, (int)hash, 0, 0);
+	}
+	else
+	{
+		if(!read_record(REPLAY_HASH, &record))
+			return;
+
+		if((unsigned int)record.value[0]!=hash)
+		{
+			if(num_of_mismatches==0)
+				log_warning("replay: the state is not the recorded one after %d updates", num_of_updates+1);
+			num_of_mismatches++;
+		}
+	}
+
+	num_of_updates++;
+}
+
+
+//show the menu, the choice is saved or taken from the replay
+int replay_fiend_menu(int in_game)
+{
+	REPLAY_ENTRY record;
+	int ans;
+
+	if(replay_mode==REPLAY_PLAY)
+	{
+		if(read_record(REPLAY_MENU, &record))
+		{
+			fiend_new_game = record.value[1];
+			fiend_load_saved_game = record.value[2];
+			return record.value[0];
+		}
+	}
+
+	//there are no keys to answer the menu with
+	if(headless_is_on)
+		return -1;
+
+	ans = fiend_menu(in_game);
+
+	if(replay_mode==REPLAY_RECORD)
+		write_record(REPLAY_MENU, ans, fiend_new_game, fiend_load_saved_game);
+
+	return ans;
+}
@@ -0,0 +1,22 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#define REPLAY_OFF 0
+#define REPLAY_RECORD 1
+#define REPLAY_PLAY 2
+
+extern int replay_mode;
+extern char replay_file[256];
+
+
+int start_replay(void);
+void stop_replay(void);
+
+void replay_begin_update(void);
+void replay_end_update(void);
+
+int replay_fiend_menu(int in_game);
+
+unsigned int get_game_state_hash(void);
+
+#endif
@@ -16,6 +16,7 @@
 
 #include "../fiend.h"
 #include "../grafik4.h"
+#include "../light_bake.h"
 #include "../logger.h"
 
 
@@ -278,6 +279,7 @@ int load_game(char *file)
 
 	log_debug("Loading saved objects: %d objects", map->num_of_objects);
 	fread(map->light, sizeof(LIGHT_DATA), map->num_of_lights, f);		
+	light_bake_init_map();
 	fread(map->object, sizeof(OBJECT_DATA),map->num_of_objects, f);
 	log_debug("Loaded objects from save file");
 	
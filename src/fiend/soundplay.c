@@ -84,7 +84,7 @@ int play_fiend_sound(char *name, int x, int y,int lower_at_dist,int loop,int pri
 	//if the sound has more then one alternative (num>1) randomize between em
 	if(sound_info[num].num>1)
 	{
-		temp = RANDOM(0,sound_info[num].num-1);
+		temp = RANDOM_IN(RANDOM_SOUND, 0,sound_info[num].num-1);
 		num+=temp;
 	}
 	
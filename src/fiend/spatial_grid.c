@@ -0,0 +1,301 @@
+////////////////////////////////////////////////////
+// This file contains the grid that the objects, items,
+// enemies and npcs of the current map are sorted into
+// by position, so that the things close to the screen
+// can be found without going through all of them.
+// Things are moved between cells when they move.
+///////////////////////////////////////////////////
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <allegro.h>
+
+#include "../fiend.h"
+#include "../grafik4.h"
+#include "spatial_grid.h"
+
+
+#define GRID_MAX_W ((MAX_LAYER_W*TILE_SIZE)/GRID_CELL_SIZE+1)
+#define GRID_MAX_H ((MAX_LAYER_H*TILE_SIZE)/GRID_CELL_SIZE+1)
+
+
+typedef struct
+{
+	int cell;//-1 if not in the grid
+	int next;//the next entry in the same cell, -1 if last
+}GRID_ENTRY;
+
+
+//the entries are the slots in the current map lists
+static GRID_ENTRY entry[GRID_TYPE_NUM][GRID_MAX_ENTRIES];
+static int num_of_entries[GRID_TYPE_NUM];
+
+static int first_entry[GRID_TYPE_NUM][GRID_MAX_W*GRID_MAX_H];
+
+//how far from its position the biggest thing of a type can be drawn
+static int max_reach[GRID_TYPE_NUM];
+
+static int grid_w=0;
+static int grid_h=0;
+
+//what spatial_grid_get returns
+static int found[GRID_TYPE_NUM][GRID_MAX_ENTRIES];
+
+
+
+//how far from the pivot a pic can be drawn at any angle
+int pic_data_reach(PIC_DATA *pic)
+{
+	if(pic->data==NULL)
+		return 0;
+
+	return pic->data->w + pic->data->h + abs(pic->center_x) + abs(pic->center_y);
+}
+
+
+//how far from its position a frame of an object can be drawn
+int object_frame_reach(OBJECT_INFO *temp, int num)
+{
+	int reach;
+
+	if(temp->door)
+		num = 0;
+
+	if(temp->angles && !temp->additive && !temp->door)//only the rle pics are kept
+	{
+		if(temp->rle_pic[num][0]==NULL)
+			return 0;
+		reach = temp->rle_pic[num][0]->w + temp->rle_pic[num][0]->h;
+	}
+	else
+	{
+		if(temp->pic[num][0].data==NULL)
+			return 0;
+		reach = temp->pic[num][0].data->w + temp->pic[num][0].data->h;
+	}
+
+	//doors turn around a hinge and slide
+	if(temp->door)
+		reach += 2*(abs(temp->door_x) + abs(temp->door_y)) + temp->w;
+
+	return reach;
+}
+
+
+
+static int get_grid_w(void)
+{
+	return MID(1, (map->w*TILE_SIZE+GRID_CELL_SIZE-1)/GRID_CELL_SIZE, GRID_MAX_W);
+}
+
+
+static int get_grid_h(void)
+{
+	return MID(1, (map->h*TILE_SIZE+GRID_CELL_SIZE-1)/GRID_CELL_SIZE, GRID_MAX_H);
+}
+
+
+static int get_num_in_list(int type, int slot)
+{
+	switch(type)
+	{
+	case GRID_OBJECT: return slot;
+	case GRID_ITEM: return current_map_item[slot];
+	case GRID_ENEMY: return current_map_enemy[slot];
+	default: return current_map_npc[slot];
+	}
+}
+
+
+static int get_list_size(int type)
+{
+	switch(type)
+	{
+	case GRID_OBJECT: return map->num_of_objects;
+	case GRID_ITEM: return current_map_item_num;
+	case GRID_ENEMY: return current_map_enemy_num;
+	default: return current_map_npc_num;
+	}
+}
+
+
+static int get_cell(int type, int slot)
+{
+	int i = get_num_in_list(type, slot);
+	int x,y;
+
+	switch(type)
+	{
+	case GRID_OBJECT: x = map->object[i].x; y = map->object[i].y; break;
+	case GRID_ITEM: x = item_data[i].x; y = item_data[i].y; break;
+	case GRID_ENEMY: x = enemy_data[i].x; y = enemy_data[i].y; break;
+	default: x = npc_data[i].x; y = npc_data[i].y; break;
+	}
+
+	//the things outside the map are kept in the edge cells
+	x = MID(0, x/GRID_CELL_SIZE, grid_w-1);
+	y = MID(0, y/GRID_CELL_SIZE, grid_h-1);
+
+	return x + y*grid_w;
+}
+
+
+static int get_max_reach(int type)
+{
+	int i,j,k;
+	int reach=0;
+	PIC_DATA *pic;
+
+	for(j=0;j<num_of_entries[type];j++)
+	{
+		i = get_num_in_list(type, j);
+
+		switch(type)
+		{
+		case GRID_OBJECT:
+			for(k=0;k<object_info[map->object[i].type].num_of_frames;k++)
+				reach = MAX(reach, object_frame_reach(&object_info[map->object[i].type], k));
+			break;
+
+		case GRID_ITEM:
+			reach = MAX(reach, item_pic[item_data[i].type].dat->w + item_pic[item_data[i].type].dat->h);
+			break;
+
+		case GRID_ENEMY:
+			for(k=0;k<enemy_info[enemy_data[i].type].num_of_frames;k++)
+			{
+				pic = &enemy_info[enemy_data[i].type].pic[k];
+				reach = MAX(reach, pic_data_reach(pic));
+			}
+			reach = MAX(reach, enemy_shadow[enemy_data[i].type]->w + enemy_shadow[enemy_data[i].type]->h);
+			break;
+
+		default:
+			for(k=0;k<char_info[npc_data[i].type].num_of_frames;k++)
+			{
+				pic = &char_info[npc_data[i].type].pic[k];
+				reach = MAX(reach, pic_data_reach(pic));
+			}
+			reach = MAX(reach, char_shadow[npc_data[i].type]->w + char_shadow[npc_data[i].type]->h);
+			break;
+		}
+	}
+
+	return reach;
+}
+
+
+static void add_entry(int type, int slot, int cell)
+{
+	entry[type][slot].cell = cell;
+	entry[type][slot].next = first_entry[type][cell];
+	first_entry[type][cell] = slot;
+}
+
+
+static void remove_entry(int type, int slot)
+{
+	int *link = &first_entry[type][entry[type][slot].cell];
+
+	while(*link!=slot)
+		link = &entry[type][*link].next;
+
+	*link = entry[type][slot].next;
+	entry[type][slot].cell = -1;
+}
+
+
+
+//put everything in the current map lists in the grid. called when
+//the lists are made.
+void spatial_grid_init_map(void)
+{
+	int i,type;
+
+	grid_w = get_grid_w();
+	grid_h = get_grid_h();
+
+	for(type=0;type<GRID_TYPE_NUM;type++)
+	{
+		memset(first_entry[type], -1, sizeof(int)*grid_w*grid_h);
+
+		num_of_entries[type] = MIN(get_list_size(type), GRID_MAX_ENTRIES);
+
+		for(i=0;i<num_of_entries[type];i++)
+			add_entry(type, i, get_cell(type, i));
+
+		max_reach[type] = get_max_reach(type);
+	}
+}
+
+
+//move the things that have changed cell. called after the logic has
+//moved things.
+void update_spatial_grid(void)
+{
+	int i,type;
+	int cell;
+
+	for(type=0;type<GRID_TYPE_NUM;type++)
+	{
+		if(num_of_entries[type]!=get_list_size(type))
+		{
+			spatial_grid_init_map();
+			return;
+		}
+
+		for(i=0;i<num_of_entries[type];i++)
+		{
+			cell = get_cell(type, i);
+
+			if(cell!=entry[type][i].cell)
+			{
+				remove_entry(type, i);
+				add_entry(type, i, cell);
+			}
+		}
+	}
+}
+
+
+
+static int compare_ints(const void *a, const void *b)
+{
+	return *(const int *)a - *(const int *)b;
+}
+
+
+//get the things of a type that can be seen in the rect. list is set
+//to their numbers in the data (not the slots), in the same order as
+//in the current map lists. returns the number of things found.
+int spatial_grid_get(int type, int x, int y, int w, int h, int **list)
+{
+	int i,j,k;
+	int x1,y1,x2,y2;
+	int num_found=0;
+
+	if(grid_w!=get_grid_w() || grid_h!=get_grid_h() || num_of_entries[type]!=get_list_size(type))
+		spatial_grid_init_map();
+
+	//the edge cells also have what is outside the map
+	x1 = MID(0, (x-max_reach[type])/GRID_CELL_SIZE, grid_w-1);
+	y1 = MID(0, (y-max_reach[type])/GRID_CELL_SIZE, grid_h-1);
+	x2 = MID(0, (x+w+max_reach[type])/GRID_CELL_SIZE, grid_w-1);
+	y2 = MID(0, (y+h+max_reach[type])/GRID_CELL_SIZE, grid_h-1);
+
+	for(i=x1;i<=x2;i++)
+		for(j=y1;j<=y2;j++)
+			for(k=first_entry[type][i+j*grid_w];k>=0;k=entry[type][k].next)
+				found[type][num_found++] = k;
+
+	qsort(found[type], num_found, sizeof(int), compare_ints);
+
+	for(i=0;i<num_found;i++)
+		found[type][i] = get_num_in_list(type, found[type][i]);
+
+	*list = found[type];
+
+	return num_found;
+}
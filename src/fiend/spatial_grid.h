@@ -0,0 +1,24 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+//the kinds of things in the grid
+#define GRID_OBJECT 0
+#define GRID_ITEM 1
+#define GRID_ENEMY 2
+#define GRID_NPC 3
+#define GRID_TYPE_NUM 4
+
+#define GRID_CELL_SIZE 256 //in pixels
+
+#define GRID_MAX_ENTRIES 300 //the biggest of the current map lists
+
+
+void spatial_grid_init_map(void);
+void update_spatial_grid(void);
+
+int spatial_grid_get(int type, int x, int y, int w, int h, int **list);
+
+int pic_data_reach(PIC_DATA *pic);
+int object_frame_reach(OBJECT_INFO *temp, int num);
+
+#endif
@@ -280,6 +280,7 @@ int check_enemy_events(void)
 		if(num<0)return -1;
 		
 		enemy_data[num].active = x;
+		reset_enemy_interpolation(num);
 		return 1;
 	}
 
@@ -421,6 +422,7 @@ int check_npc_events(void)
 		if(num<0)return -1;
 		
 		npc_data[num].active = x;
+		reset_npc_interpolation(num);
 		return 1;
 	}
 
@@ -434,6 +436,7 @@ int check_npc_events(void)
 			npc_data[num].active=1;
 		else
 			npc_data[num].active=0;
+		reset_npc_interpolation(num);
 
 		return 1;
 	}
@@ -44,7 +44,7 @@ void update_before_map(void)
 	float temp_x, temp_y;
 	int temp;
 
-	num_of_turns = RANDOM(MIN_UPDATE_TURNS,MAX_UPDATE_TURNS);
+	num_of_turns = RANDOM_IN(RANDOM_AI, MIN_UPDATE_TURNS,MAX_UPDATE_TURNS);
 	
 	for(i=0;i<map->num_of_objects;i++)
 	{
@@ -74,7 +74,7 @@ void update_before_map(void)
 	player.x = -100;
 	player.y = -100;
 
-	temp = RANDOM(750, 800);
+	temp = RANDOM_IN(RANDOM_AI, 750, 800);
 
 	sound_was_on=sound_is_on;
 	
@@ -104,6 +104,8 @@ void update_before_map(void)
 		 
  	if(map->outside)
 		map->light_level = outside_lightlevel;
+
+	update_spatial_grid();
 }
 
 
@@ -131,8 +133,8 @@ void update_enemies_before_map(void)
 			{
 				type = enemy_data[i].type;
 				
-				new_x = enemy_data[i].x + RANDOM(-200,200); 
-				new_y = enemy_data[i].y + RANDOM(-200,200); 
+				new_x = enemy_data[i].x + RANDOM_IN(RANDOM_AI, -200,200); 
+				new_y = enemy_data[i].y + RANDOM_IN(RANDOM_AI, -200,200); 
 				
 				end_loop = 1;
 
@@ -319,6 +321,8 @@ void get_current_map_objects(void)
 		}
 	}
 
+	spatial_grid_init_map();
+	reset_interpolation();
 
 }
 
@@ -0,0 +1,226 @@
+////////////////////////////////////////////////////
+// This file contains what tiles the player can see.
+// The whole visible set is found in one sweep with
+// symmetric shadowcasting over the tiles, going out
+// row by row in each quarter and keeping track of
+// the slopes that are not yet in shadow. It is
+// symmetric, so if the player can see a tile an
+// enemy on that tile can see the player.
+///////////////////////////////////////////////////
+
+
+#include <string.h>
+
+#include <allegro.h>
+
+#include "../fiend.h"
+#include "../grafik4.h"
+#include "visibility.h"
+
+
+//a slope is num/den, den is always > 0
+typedef struct
+{
+	int num;
+	int den;
+}SLOPE;
+
+
+//the visible tiles has visible[] equal to the stamp of the last sweep
+static unsigned int visible[MAX_LAYER_W*MAX_LAYER_H];
+static unsigned int visible_stamp=0;
+
+static int visible_is_valid=0;
+static int eye_tile_x;
+static int eye_tile_y;
+static int eye_solidity_version;
+
+//the quarter being swept and where it starts
+static int quarter;
+static int origin_x;
+static int origin_y;
+
+
+
+//divide that rounds down for negative numbers too
+static int floor_div(int a, int b)
+{
+	if(a<0)
+		return -((-a+b-1)/b);
+	else
+		return a/b;
+}
+
+static int ceil_div(int a, int b)
+{
+	return -floor_div(-a, b);
+}
+
+
+//get the tile at depth and col in the quarter
+static void quarter_tile(int depth, int col, int *x, int *y)
+{
+	switch(quarter)
+	{
+	case 0: *x = origin_x + col; *y = origin_y - depth; break;//up
+	case 1: *x = origin_x + depth; *y = origin_y + col; break;//right
+	case 2: *x = origin_x + col; *y = origin_y + depth; break;//down
+	default: *x = origin_x - depth; *y = origin_y + col; break;//left
+	}
+}
+
+
+static int tile_is_opaque(int x, int y)
+{
+	if(x<0 || y<0 || x>=map->w || y>=map->h)
+		return 1;
+
+	return tile_blocks_sight(x, y);
+}
+
+
+static void set_visible(int x, int y)
+{
+	if(x<0 || y<0 || x>=map->w || y>=map->h)
+		return;
+
+	visible[x + y*MAX_LAYER_W] = visible_stamp;
+}
+
+
+//sweep a row of the quarter between two slopes and the rows after it
+//that can be seen through the gaps. there is no range, the tiles outside
+//the map are walls so the sweep stops at the edge of the map.
+static void scan_row(int depth, SLOPE start, SLOPE end)
+{
+	int col;
+	int min_col, max_col;
+	int x,y;
+	int opaque;
+	int prev=-1;//-1 none, 0 floor, 1 wall
+	SLOPE temp;
+
+	//round ties up for the start and down for the end
+	min_col = floor_div(2*depth*start.num + start.den, 2*start.den);
+	max_col = ceil_div(2*depth*end.num - end.den, 2*end.den);
+
+	for(col=min_col;col<=max_col;col++)
+	{
+		quarter_tile(depth, col, &x, &y);
+		opaque = tile_is_opaque(x, y);
+
+		//walls are seen, floors only if the centre is inside the slopes
+		if(opaque || (col*start.den >= depth*start.num && col*end.den <= depth*end.num))
+			set_visible(x, y);
+
+		if(prev==1 && !opaque)
+		{
+			start.num = 2*col - 1;
+			start.den = 2*depth;
+		}
+		if(prev==0 && opaque)
+		{
+			temp.num = 2*col - 1;
+			temp.den = 2*depth;
+			scan_row(depth+1, start, temp);
+		}
+
+		prev = opaque;
+	}
+
+	if(prev==0)
+		scan_row(depth+1, start, end);
+}
+
+
+//find all tiles seen from the tile the player is on
+static void sweep_visibility(int x, int y)
+{
+	SLOPE start = {-1, 1};
+	SLOPE end = {1, 1};
+
+	visible_stamp++;
+	if(visible_stamp==0)
+	{
+		memset(visible, 0, sizeof(visible));
+		visible_stamp=1;
+	}
+
+	origin_x = x;
+	origin_y = y;
+
+	set_visible(x, y);
+
+	for(quarter=0;quarter<4;quarter++)
+		scan_row(1, start, end);
+}
+
+
+//sweep again if the player has moved to another tile or something
+//solid has moved
+static void check_player_visibility(void)
+{
+	int x = (int)player.x/TILE_SIZE;
+	int y = (int)player.y/TILE_SIZE;
+
+	if(visible_is_valid && x==eye_tile_x && y==eye_tile_y && tile_object_solidity_version==eye_solidity_version)
+		return;
+
+	eye_tile_x = x;
+	eye_tile_y = y;
+	eye_solidity_version = tile_object_solidity_version;
+	visible_is_valid=1;
+
+	sweep_visibility(x, y);
+}
+
+
+
+//the map has changed
+void reset_player_visibility(void)
+{
+	visible_is_valid=0;
+}
+
+
+//can the player see the tile
+int tile_is_visible(int x, int y)
+{
+	if(x<0 || y<0 || x>=map->w || y>=map->h)
+		return 0;
+
+	check_player_visibility();
+
+	return visible[x + y*MAX_LAYER_W]==visible_stamp;
+}
+
+
+//object_is_in_fov for when the object is the player. the eye sees the
+//player if the player sees the eye, so the sweep is used instead of rays.
+int player_is_in_fov(float eye_x, float eye_y, float eye_angle, float fov)
+{
+	float max_angle;
+	float min_angle;
+	float object_angle;
+
+	if(!tile_is_visible((int)eye_x/TILE_SIZE, (int)eye_y/TILE_SIZE))
+		return 0;
+
+	max_angle = add_angle(eye_angle, fov/2);
+	min_angle = add_angle(eye_angle, -(fov/2));
+
+	object_angle=compute_angle(player.x, player.y, eye_x, eye_y);
+
+	if(max_angle>min_angle)
+	{
+		if(object_angle<min_angle || object_angle>max_angle)
+			return 0;	
+	}
+	else
+	{	
+		if(object_angle<min_angle && object_angle>max_angle)
+			return 0;	
+	}
+
+	return 1;
+}
@@ -0,0 +1,11 @@
+#ifndef VISIBILITY_H
+#define VISIBILITY_H
+
+
+void reset_player_visibility(void);
+
+int tile_is_visible(int x, int y);
+
+int player_is_in_fov(float eye_x, float eye_y, float eye_angle, float fov);
+
+#endif
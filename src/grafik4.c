@@ -32,12 +32,55 @@ int i;
   }
  
  srand(time(NULL));
+ seed_random(time(NULL));
  
  return 0;
 }
 
 
 
+static unsigned int random_state[RANDOM_STREAM_NUM];
+
+//seed all the random streams
+void seed_random(unsigned int seed)
+{
+ int i;
+ unsigned int x;
+
+ for(i=0;i<RANDOM_STREAM_NUM;i++)
+ {
+  //mix the seed so the streams are not alike
+  x = seed + (i+1)*0x9E3779B9u;
+  x = (x ^ (x>>16)) * 0x85EBCA6Bu;
+  x = (x ^ (x>>13)) * 0xC2B2AE35u;
+  x ^= x>>16;
+
+  random_state[i] = x ? x : 1;
+ }
+}
+
+
+//the next number of a stream, 0 to 0x7fffffff (xorshift)
+int get_random(int stream)
+{
+ unsigned int x = random_state[stream];
+
+ x ^= x<<13;
+ x ^= x>>17;
+ x ^= x<<5;
+ random_state[stream] = x;
+
+ return x>>1;
+}
+
+
+unsigned int get_random_state(int stream)
+{
+ return random_state[stream];
+}
+
+
+
 //what tile is att x,y? This fucntion tells you...
 void map_tile(int x, int y, int *tile_x, int *tile_y, int tile_size)
 {
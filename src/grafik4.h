@@ -20,7 +20,18 @@ extern float tan_table[3601];
 #define  check_collision(x1,y1,bredd1,hojd1,x2,y2,bredd2,hojd2) !(x1>x2+bredd2-1 || x2>x1+bredd1-1 || y1>y2+hojd2-1 || y2>y1+hojd1-1)
 
 
-#define RANDOM(low, high) rand()%((int)(high)+1-((int)low))+((int)low)
+//the random numbers come from streams that are seeded together, so that
+//a game can be played again with the same numbers. each part of the game
+//has its own stream so it does not change the numbers of the others.
+#define RANDOM_GAME 0
+#define RANDOM_AI 1
+#define RANDOM_PARTICLES 2
+#define RANDOM_EFFECTS 3
+#define RANDOM_SOUND 4
+#define RANDOM_STREAM_NUM 5
+
+#define RANDOM(low, high) get_random(RANDOM_GAME)%((int)(high)+1-((int)low))+((int)low)
+#define RANDOM_IN(stream, low, high) get_random(stream)%((int)(high)+1-((int)low))+((int)low)
 
 
 //main routines
@@ -28,6 +39,12 @@ int init_grafik4(void);
 
 
 
+//random routines
+void seed_random(unsigned int seed);
+int get_random(int stream);
+unsigned int get_random_state(int stream);
+
+
 //misc routines
 void map_tile(int x, int y, int *tile_x, int *tile_y, int tile_size);
 
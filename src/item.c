@@ -16,6 +16,7 @@
 
 #include "fiend.h"
 #include "item.h"
+#include "draw_list.h"
 
 
 
@@ -172,12 +173,12 @@ void draw_fiend_item(BITMAP *dest,int num,int x, int y,float angle, int lit)
 
 	if(lit)
 	{
-		set_trans_blender(255,255,255,0);
-		draw_lit_rle_sprite(dest,item_pic[num].dat,x - ((RLE_SPRITE *)item_pic[num].dat)->w/2, y - ((RLE_SPRITE *)item_pic[num].dat)->h/2,item_light);
+		dl_set_trans_blender(255,255,255,0);
+		dl_draw_lit_rle_sprite(dest,item_pic[num].dat,x - ((RLE_SPRITE *)item_pic[num].dat)->w/2, y - ((RLE_SPRITE *)item_pic[num].dat)->h/2,item_light);
 	}
 	else
 	{
-		draw_rle_sprite(dest,item_pic[num].dat,x - ((RLE_SPRITE *)item_pic[num].dat)->w/2, y - ((RLE_SPRITE *)item_pic[num].dat)->h/2);
+		dl_draw_rle_sprite(dest,item_pic[num].dat,x - ((RLE_SPRITE *)item_pic[num].dat)->w/2, y - ((RLE_SPRITE *)item_pic[num].dat)->h/2);
 	}
 }
 
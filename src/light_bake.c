@@ -0,0 +1,279 @@
+////////////////////////////////////////////////////
+// This file contains the baked light layer. Lights
+// that are on and do not flash or move are added
+// together once into chunks of light, so that the
+// light mask only has to add a few chunks and the
+// dynamic lights every frame. The lights are checked
+// each frame and the chunks under a light that is
+// turned on or off (or starts moving) are baked again.
+///////////////////////////////////////////////////
+
+
+#include <stdlib.h>
+
+#include <allegro.h>
+
+#include "fiend.h"
+#include "grafik4.h"
+#include "light_bake.h"
+#include "draw_list.h"
+#include "logger.h"
+
+
+int light_bake_is_on=1;
+
+static LIGHT_BAKE_CHUNK *chunk=NULL;
+static int chunks_w=0;
+static int chunks_h=0;
+
+//the chunks given to the light mask
+static LIGHT_MASK_LIGHT *seen_chunk=NULL;
+static int max_seen_chunks=0;
+
+
+//how each light was when the chunks were baked
+typedef struct
+{
+	int baked;
+	int x;//upper left corner in the world
+	int y;
+	BITMAP *pic;
+
+	int moved;//has moved since the map was loaded, never baked again
+	int last_x;
+	int last_y;
+}BAKED_LIGHT;
+
+static BAKED_LIGHT baked_light[MAX_LIGHT_NUM];
+
+
+
+//should the light be in the baked layer
+static int light_should_be_baked(int num)
+{
+	LIGHT_DATA *light = &map->light[num];
+
+	return light_bake_is_on && light->active && !light->flash && !baked_light[num].moved && lightmap_data[num]!=NULL;
+}
+
+
+//the chunks touching a rectangle in the world must be baked again
+static void invalidate_rect(int x, int y, int w, int h)
+{
+	int i,j;
+	int x1,y1,x2,y2;
+
+	if(chunk==NULL || w<=0 || h<=0 || x+w<=0 || y+h<=0)
+		return;
+
+	x1 = MAX(x, 0)/LIGHT_BAKE_CHUNK_SIZE;
+	y1 = MAX(y, 0)/LIGHT_BAKE_CHUNK_SIZE;
+	x2 = MIN((x+w-1)/LIGHT_BAKE_CHUNK_SIZE, chunks_w-1);
+	y2 = MIN((y+h-1)/LIGHT_BAKE_CHUNK_SIZE, chunks_h-1);
+
+	for(i=x1;i<=x2;i++)
+		for(j=y1;j<=y2;j++)
+			chunk[i + j*chunks_w].dirty=1;
+}
+
+
+//look for lights that has changed since they were baked
+static void update_baked_lights(void)
+{
+	int i;
+	int bake;
+	LIGHT_DATA *light;
+	BAKED_LIGHT *temp;
+
+	for(i=0;i<map->num_of_lights;i++)
+	{
+		light = &map->light[i];
+		temp = &baked_light[i];
+
+		if(light->world_x!=temp->last_x || light->world_y!=temp->last_y)
+		{
+			temp->moved=1;
+			temp->last_x = light->world_x;
+			temp->last_y = light->world_y;
+		}
+
+		bake = light_should_be_baked(i);
+
+		if(bake==temp->baked)
+			continue;
+
+		if(temp->baked)
+			invalidate_rect(temp->x, temp->y, temp->pic->w, temp->pic->h);
+
+		temp->baked = bake;
+		temp->pic = lightmap_data[i];
+		temp->x = light->world_x - light->strech_w/2;
+		temp->y = light->world_y - light->strech_h/2;
+
+		if(temp->baked)
+			invalidate_rect(temp->x, temp->y, temp->pic->w, temp->pic->h);
+	}
+}
+
+
+//add the baked lights to a new pic for the chunk. the old pic can be in
+//a list the render thread has not drawn yet, so it is not changed.
+static void bake_chunk(LIGHT_BAKE_CHUNK *temp)
+{
+	int i;
+	BITMAP *pic;
+	BAKED_LIGHT *light;
+
+	pic = create_bitmap_ex(8, LIGHT_BAKE_CHUNK_SIZE, LIGHT_BAKE_CHUNK_SIZE);
+	if(pic==NULL)
+		return;
+
+	clear_to_color(pic, 0);
+	temp->num_of_lights=0;
+
+	for(i=0;i<map->num_of_lights;i++)
+	{
+		light = &baked_light[i];
+
+		if(!light->baked)
+			continue;
+		if(!check_collision(light->x, light->y, light->pic->w, light->pic->h, temp->x, temp->y, LIGHT_BAKE_CHUNK_SIZE, LIGHT_BAKE_CHUNK_SIZE))
+			continue;
+
+		draw_lightmap2(pic, light->pic, light->x - temp->x, light->y - temp->y);
+		temp->num_of_lights++;
+	}
+
+	if(temp->pic)
+		dl_destroy_bitmap(temp->pic);
+
+	temp->pic = pic;
+	temp->dirty=0;
+}
+
+
+
+//free all chunks
+void light_bake_release(void)
+{
+	int i;
+
+	if(chunk)
+	{
+		for(i=0;i<chunks_w*chunks_h;i++)
+			if(chunk[i].pic)
+				dl_destroy_bitmap(chunk[i].pic);
+		free(chunk);
+	}
+	if(seen_chunk)
+		free(seen_chunk);
+
+	chunk=NULL;
+	seen_chunk=NULL;
+	max_seen_chunks=0;
+	chunks_w=0;
+	chunks_h=0;
+}
+
+
+//split the current map into chunks. the chunks are baked when they are
+//first seen. called when a map is loaded.
+void light_bake_init_map(void)
+{
+	int i,j;
+
+	light_bake_release();
+
+	chunks_w = (map->w*TILE_SIZE+LIGHT_BAKE_CHUNK_SIZE-1)/LIGHT_BAKE_CHUNK_SIZE;
+	chunks_h = (map->h*TILE_SIZE+LIGHT_BAKE_CHUNK_SIZE-1)/LIGHT_BAKE_CHUNK_SIZE;
+
+	chunk = calloc(sizeof(LIGHT_BAKE_CHUNK), chunks_w*chunks_h);
+
+	if(chunk==NULL)
+	{
+		log_warning("light bake: out of memory, drawing lights one by one");
+		chunks_w=0;
+		chunks_h=0;
+	}
+
+	for(i=0;i<chunks_w;i++)
+		for(j=0;j<chunks_h;j++)
+		{
+			chunk[i + j*chunks_w].x = i*LIGHT_BAKE_CHUNK_SIZE;
+			chunk[i + j*chunks_w].y = j*LIGHT_BAKE_CHUNK_SIZE;
+			chunk[i + j*chunks_w].dirty = 1;
+		}
+
+	for(i=0;i<map->num_of_lights;i++)
+	{
+		baked_light[i].baked = 0;
+		baked_light[i].moved = 0;
+		baked_light[i].last_x = map->light[i].world_x;
+		baked_light[i].last_y = map->light[i].world_y;
+	}
+
+	if(chunk)
+		update_baked_lights();
+}
+
+
+
+//is the light in the baked chunks, if not it must be drawn every frame
+int light_is_baked(int num)
+{
+	return chunk!=NULL && baked_light[num].baked;
+}
+
+
+
+//get the chunks seen in a part of the world, baking them if needed.
+//*light is set to the chunks, with the positions relative to xpos, ypos.
+//returns the number of chunks.
+int light_bake_get_chunks(int xpos, int ypos, int w, int h, LIGHT_MASK_LIGHT **light)
+{
+	int i,j;
+	int x1,y1,x2,y2;
+	int num=0;
+	LIGHT_BAKE_CHUNK *temp;
+
+	*light = seen_chunk;
+
+	if(chunk==NULL || xpos+w<=0 || ypos+h<=0)
+		return 0;
+
+	update_baked_lights();
+
+	x1 = MAX(xpos, 0)/LIGHT_BAKE_CHUNK_SIZE;
+	y1 = MAX(ypos, 0)/LIGHT_BAKE_CHUNK_SIZE;
+	x2 = MIN((xpos+w-1)/LIGHT_BAKE_CHUNK_SIZE, chunks_w-1);
+	y2 = MIN((ypos+h-1)/LIGHT_BAKE_CHUNK_SIZE, chunks_h-1);
+
+	if(x2<x1 || y2<y1)
+		return 0;
+
+	if((x2-x1+1)*(y2-y1+1) > max_seen_chunks)
+	{
+		max_seen_chunks = (x2-x1+1)*(y2-y1+1);
+		seen_chunk = realloc(seen_chunk, sizeof(LIGHT_MASK_LIGHT)*max_seen_chunks);
+		*light = seen_chunk;
+	}
+
+	for(i=x1;i<=x2;i++)
+		for(j=y1;j<=y2;j++)
+		{
+			temp = &chunk[i + j*chunks_w];
+
+			if(temp->dirty)
+				bake_chunk(temp);
+
+			if(temp->pic==NULL || temp->num_of_lights==0)
+				continue;
+
+			seen_chunk[num].pic = temp->pic;
+			seen_chunk[num].x = temp->x - xpos;
+			seen_chunk[num].y = temp->y - ypos;
+			num++;
+		}
+
+	return num;
+}
@@ -0,0 +1,32 @@
+#include <allegro.h>
+
+#include "draw.h"
+
+
+#ifndef LIGHT_BAKE_H
+#define LIGHT_BAKE_H
+
+#define LIGHT_BAKE_CHUNK_SIZE 256 //chunk width and height in pixels
+
+
+typedef struct
+{
+	int x;//position in the world, in pixels
+	int y;
+
+	BITMAP *pic;//the static lights added together, NULL until needed
+	int dirty;//must be baked again before it is used
+	int num_of_lights;//lights baked into pic
+}LIGHT_BAKE_CHUNK;
+
+
+extern int light_bake_is_on;
+
+void light_bake_init_map(void);
+void light_bake_release(void);
+
+int light_is_baked(int num);
+
+int light_bake_get_chunks(int xpos, int ypos, int w, int h, LIGHT_MASK_LIGHT **light);
+
+#endif
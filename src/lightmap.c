@@ -7,11 +7,16 @@
 
 
 
+#include <stdlib.h>
+#include <string.h>
+
 #include <allegro.h>
 #include "grafik4.h"
 #include "fiend.h"
 #include "lightmap.h"
 #include "draw.h"
+#include "draw_list.h"
+#include "thread.h"
 
 #define S_SHADOW_LENGTH (4)
 
@@ -50,9 +55,6 @@ static int lightmap_r[LIGHTMAP_R_NUM]={20,40,80,120,180,220,280,340};
 
 NORMAL_LIGHT_DATA *normal_light_data;
 
-//not used....
-BITMAP *lightmap_cache;
-
 
 //Wall shadow stuff....
 
@@ -265,8 +267,8 @@ void draw_wall_shadows(BITMAP *dest,int xpos,int ypos)
 	x=(xpos-(xpos%TILE_SIZE))/TILE_SIZE;//what tile do you begin with 
 	y=(ypos-(ypos%TILE_SIZE))/TILE_SIZE;
 
-	for(i=-1;i< (dest->w/TILE_SIZE+1) ;i++)
-		for(j=-1;j< (dest->h/TILE_SIZE+1) ;j++)
+	for(i=-1;i< ((dest->w+TILE_SIZE-1)/TILE_SIZE+1) ;i++)
+		for(j=-1;j< ((dest->h+TILE_SIZE-1)/TILE_SIZE+1) ;j++)
 		{
 			if((i+x < 0)|| (j+y < 0) || (j+y > map->h-1) || (i+x > map->w-1) ) //if the tile is out side the map it is just a black square
 			{
@@ -277,7 +279,7 @@ void draw_wall_shadows(BITMAP *dest,int xpos,int ypos)
 				num = *(map->shadow+ (i+x) +( (j+y) * map->w));
 			
 				if(num>-1)
-					draw_lightsprite(dest, wall_shadow[num], x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
+					dl_draw_lightsprite(dest, wall_shadow[num], x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
 			}
 		}
 
@@ -424,7 +426,7 @@ void draw_normal_light(BITMAP* dest, int num)
 	{
 		size = normal_lightmap[normal_light_data[num].c][normal_light_data[num].r]->w/2;
 
-		draw_lightmap2(dest, normal_lightmap[normal_light_data[num].c][normal_light_data[num].r],normal_light_data[num].x - map_x -size, normal_light_data[num].y - map_y -size );
+		dl_draw_lightmap2(dest, normal_lightmap[normal_light_data[num].c][normal_light_data[num].r],normal_light_data[num].x - map_x -size, normal_light_data[num].y - map_y -size );
 	}
 
 }
@@ -527,38 +529,181 @@ void create_light_map(BITMAP **dest, LIGHT_DATA *light)
 
 
 
-//create a lightmap for the game.....(same thing but max value is 31 instead of 255)
-void create_light_map2(BITMAP **dest, LIGHT_DATA *light)
+//find how wide circlefill makes the rows of a circle, it is the same
+//loop as in allegro. span[d] is the half width of the rows d above and
+//below the centre.
+static void get_circle_spans(int radius, int *span)
 {
+ int cx = 0;
+ int cy = radius;
+ int df = 1 - radius;
+ int d_e = 3;
+ int d_se = -2*radius + 5;
  int i;
- BITMAP *temp;
- int color = light->max_light;
- 	
- *dest = create_bitmap_ex(8, light->bitmap_w, light->bitmap_h);
- clear_to_color(*dest, 0); 	 
 
- 
- for(i=light->r;i>light->centre_r;i--)
+ for(i=0;i<=radius;i++)
+  span[i] = -1;
+
+ do
+ {
+  if(cy>span[cx]) span[cx] = cy;
+
+  if(df<0)
+  {
+   df += d_e;
+   d_e += 2;
+   d_se += 2;
+  }
+  else
+  {
+   if(cx!=cy && cx>span[cy]) span[cy] = cx;
+
+   df += d_se;
+   d_e += 2;
+   d_se += 4;
+   cy--;
+  }
+
+  cx++;
+ }while(cx<=cy);
+}
+
+
+//set the pixels from to to away from x, on both sides of x
+static void fill_falloff_row(BITMAP *dest, int x, int y, int from, int to, int color)
+{
+ int x1,x2;
+
+ if(y<0 || y>=dest->h) return;
+
+ x1 = MAX(x-to, 0);
+ x2 = MIN(x-from, dest->w-1);
+ if(x1<=x2) memset(dest->line[y]+x1, color, x2-x1+1);
+
+ x1 = MAX(x+MAX(from,1), 0);
+ x2 = MIN(x+to, dest->w-1);
+ if(x1<=x2) memset(dest->line[y]+x1, color, x2-x1+1);
+}
+
+
+//draw the light falloff. gives the same pixels as doing circlefill for
+//every radius from r down to centre_r+1, but each pixel is only set once.
+//the smallest circle over a pixel is drawn last so it gets that color,
+//so the radii are gone through from the smallest and only the part of
+//a row outside the smaller circles is set.
+static void draw_light_falloff(BITMAP *dest, LIGHT_DATA *light)
+{
+ int i,d;
+ int color;
+ int *span;
+ int *done;
+
+ for(i=0;i<dest->h;i++)
+  memset(dest->line[i], 0, dest->w);
+
+ if(light->r<0) return;
+
+ span = malloc(sizeof(int)*(light->r+1));
+ done = malloc(sizeof(int)*(light->r+1));
+
+ for(d=0;d<=light->r;d++)
+  done[d] = -1;
+
+ for(i=MAX(light->centre_r+1, 0);i<=light->r;i++)
  {
    color = ((1-( (float)(i-light->centre_r) / (float)(light->r-light->centre_r)   )) * light->max_light)/8;
    if(color>31)color=31;  
-   circlefill(*dest,light->x, light->y,i, color);
-        
+
+   get_circle_spans(i, span);
+
+   for(d=0;d<=i;d++)
+    if(span[d]>done[d])
+    {
+     fill_falloff_row(dest, light->x, light->y-d, done[d]+1, span[d], color);
+     if(d>0)
+      fill_falloff_row(dest, light->x, light->y+d, done[d]+1, span[d], color);
+
+     done[d] = span[d];
+    }
  }
 
+ free(span);
+ free(done);
+}
+
+
+//stretch the light map if the light is not round
+static void stretch_light_map(BITMAP **dest, LIGHT_DATA *light)
+{
+ BITMAP *temp;
+
  if(light->bitmap_w!=light->strech_w || light->bitmap_h!=light->strech_h)
  {
 	 temp = create_bitmap_ex(8,light->strech_w, light->strech_h);
 	 stretch_blit(*dest, temp,0,0,light->bitmap_w, light->bitmap_h,0,0,light->strech_w,light->strech_h);
 	 destroy_bitmap(*dest);
-	 *dest = create_bitmap_ex(8,light->strech_w,light->strech_h);
-	 blit(temp,*dest,0,0,0,0,light->strech_w,light->strech_h);
-	 destroy_bitmap(temp);
-
+	 *dest = temp;
  }
+}
 
 
+//create a lightmap for the game.....(same thing but max value is 31 instead of 255)
+void create_light_map2(BITMAP **dest, LIGHT_DATA *light)
+{
+ *dest = create_bitmap_ex(8, light->bitmap_w, light->bitmap_h);
 
+ draw_light_falloff(*dest, light);
+
+ stretch_light_map(dest, light);
 }
 
 
+
+typedef struct
+{
+	BITMAP **dest;
+	LIGHT_DATA *light;
+}LIGHT_MAP_JOB;
+
+static void light_map_job(void *arg, int num)
+{
+	LIGHT_MAP_JOB *job = arg;
+
+	draw_light_falloff(job->dest[num], &job->light[num]);
+}
+
+
+//create the lightmaps for many lights, the falloffs are drawn by all
+//the cpus. the bitmaps are made and stretched here since allegro does
+//not like that being done by many threads.
+void create_light_maps2(BITMAP **dest, LIGHT_DATA *light, int num_of_lights)
+{
+ int i;
+ int threads;
+ LIGHT_MAP_JOB job;
+ FIEND_WORKER_POOL *pool=NULL;
+
+ for(i=0;i<num_of_lights;i++)
+  dest[i] = create_bitmap_ex(8, light[i].bitmap_w, light[i].bitmap_h);
+
+ job.dest = dest;
+ job.light = light;
+
+ threads = MIN(get_num_of_cpus(), num_of_lights);
+ if(threads>1)
+  pool = create_worker_pool(threads-1);
+
+ if(pool)
+ {
+  run_worker_jobs(pool, light_map_job, &job, num_of_lights);
+  destroy_worker_pool(pool);
+ }
+ else
+ {
+  for(i=0;i<num_of_lights;i++)
+   light_map_job(&job, i);
+ }
+
+ for(i=0;i<num_of_lights;i++)
+  stretch_light_map(&dest[i], &light[i]);
+}
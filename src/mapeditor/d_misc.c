@@ -6,7 +6,7 @@
 #include "../draw.h"
 
 //cheating...
-int los_buffer[18][18];
+int los_buffer[LOS_MAX_W][LOS_MAX_H];
 
 static char temp_string[40];
 
@@ -472,6 +472,21 @@ void update_load_text(char *string)
 	return;
 }
 
+void render_thread_sync(void)
+{
+	return;
+}
+
+void reset_los_buffer(void)
+{
+	return;
+}
+
+void release_render_queue(void)
+{
+	return;
+}
+
 void init_fiend_note(void)
 {
 	return;
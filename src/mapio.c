@@ -12,6 +12,9 @@
 #include <malloc.h>
 #include "fiend.h"
 #include "lightmap.h"
+#include "tile_cache.h"
+#include "tile_plan.h"
+#include "light_bake.h"
 #include "logger.h"
 
 
@@ -213,8 +216,7 @@ int load_map(MAP_DATA* map, char *file)
 		
 	
 	
-	for(i=0;i<map->num_of_lights;i++)
-		create_light_map2(&lightmap_data[i], &map->light[i]);
+	create_light_maps2(lightmap_data, map->light, map->num_of_lights);
 	
 	
 
@@ -234,6 +236,9 @@ int load_edit_map(MAP_DATA* map, char *file)
 	int i;
 	MAP_DATA *temp_map;
 	FILE *f;
+
+	//the render thread might be drawing the old map
+	render_thread_sync();
 	
 	// Free old map memory if it exists (for map transitions)
 	// The first time this is called, new_map() will have already allocated memory
@@ -467,10 +472,14 @@ int load_edit_map(MAP_DATA* map, char *file)
     
 	if(in_the_game)
 	{
-		for(i=0;i<map->num_of_lights;i++)
-			create_light_map2(&lightmap_data[i], &map->light[i]);
+		create_light_maps2(lightmap_data, map->light, map->num_of_lights);
 
 		sprintf(map_file,"%s",file);
+
+		tile_plan_init_map();
+		tile_cache_init_map();
+		light_bake_init_map();
+		reset_los_buffer();
 	}
 	else
 	{
@@ -659,6 +668,8 @@ void clear_map(MAP_DATA *map)
 void release_map(MAP_DATA *map)
 {
   int i;
+
+  render_thread_sync();
  	
   for(i=0;i<map->num_of_lights;i++) {
 	if(lightmap_data[i]) {  // Check for NULL to prevent double-free
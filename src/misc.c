@@ -18,8 +18,10 @@
 #include "grafik4.h"
 #include "picdata.h"
 #include "draw_polygon.h"
+#include "draw_list.h"
 #include "logger.h"
 #include "path_utils.h"
+#include "present.h"
 
 
 ///////////////////////////////////////////////
@@ -167,7 +169,7 @@ void make_pickup_message(char *string,BITMAP *pic,int time)
 				color = getpixel(pic,i,j);
 				
 				r = getr(color);g = getg(color);b = getb(color);
-				if(color==MASK_COLOR_16)
+				if(color==bitmap_mask_color(pic))
 				{
 				}
 				else
@@ -383,7 +385,7 @@ void draw_fiend_beam(BITMAP *dest, BITMAP *img, int x1, int y1,int x2, int y2)
 	}
 
 
-	quad3d_f(dest,POLYTYPE_ATEX_MASK,img, &point[0], &point[1], &point[3],&point[2] );
+	dl_quad3d_f(dest,POLYTYPE_ATEX_MASK,img, &point[0], &point[1], &point[3],&point[2] );
 
 	//fiend_quad3d(dest,img, &the_point[0], &the_point[1], &the_point[3],&the_point[2] );
 
@@ -437,8 +439,8 @@ void make_bullet_hit_object(int i,int power)
 	//int amount,j;
 	int x_add, y_add;
 
-	x_add = RANDOM(-5,5);
-	y_add = RANDOM(-5,5);
+	x_add = RANDOM_IN(RANDOM_PARTICLES, -5,5);
+	y_add = RANDOM_IN(RANDOM_PARTICLES, -5,5);
 
 	make_new_particle("dust",missile_data[i].x+x_add, missile_data[i].y+y_add,0,0,0, 60,2,0);
 }
@@ -449,14 +451,14 @@ void make_bullet_hit_flesh(int i,int power, int color)
 	int amount,j;
 	int x_add=0, y_add=0;
 	
-	amount = RANDOM(15,27);
+	amount = RANDOM_IN(RANDOM_PARTICLES, 15,27);
 	for(j=0;j<amount;j++)
 	{
 
-		x_add = RANDOM(-3,3);
-		y_add = RANDOM(-3,3);
-		make_new_particle("blood",missile_data[i].x+x_add, missile_data[i].y+y_add, add_angle(missile_data[i].angle,RANDOM(150,210) )
-			,(float)(RANDOM(5,12))/10,0.001, RANDOM(40,60),2,color);
+		x_add = RANDOM_IN(RANDOM_PARTICLES, -3,3);
+		y_add = RANDOM_IN(RANDOM_PARTICLES, -3,3);
+		make_new_particle("blood",missile_data[i].x+x_add, missile_data[i].y+y_add, add_angle(missile_data[i].angle,RANDOM_IN(RANDOM_PARTICLES, 150,210) )
+			,(float)(RANDOM_IN(RANDOM_PARTICLES, 5,12))/10,0.001, RANDOM_IN(RANDOM_PARTICLES, 40,60),2,color);
 
 	}
 	
@@ -496,11 +498,11 @@ void make_bloodcircle(int x, int y, int size, int color)
 void make_bloodpool(int x, int y, int size, int color)
 {
 	int i;
-	int temp = RANDOM(5,8);
+	int temp = RANDOM_IN(RANDOM_PARTICLES, 5,8);
 
 	for(i=0;i<temp;i++)
 	{
-		make_bloodcircle(x +RANDOM(-size/2, size/2), y +RANDOM(-size/2, size/2), RANDOM(size/4, size/2),color);
+		make_bloodcircle(x +RANDOM_IN(RANDOM_PARTICLES, -size/2, size/2), y +RANDOM_IN(RANDOM_PARTICLES, -size/2, size/2), RANDOM_IN(RANDOM_PARTICLES, size/4, size/2),color);
 	}
 }
 
@@ -534,21 +536,21 @@ void draw_bloodpools(void)
 			{
 				temp = bloodpool[i].size*0.5;
 				
-				circlefill(virt, bloodpool[i].x-map_x, bloodpool[i].y-map_y, temp*2, bloodpool[i].color );
+				dl_circlefill(virt, bloodpool[i].x-map_x, bloodpool[i].y-map_y, temp*2, bloodpool[i].color );
 
 				dec = (255)/(bloodpool[i].size*0.5);
 				alpha = 255;
 
 			 
-				drawing_mode(DRAW_MODE_TRANS,NULL,0,0);
+				dl_drawing_mode(DRAW_MODE_TRANS,NULL,0,0);
 				for(j=temp;j<bloodpool[i].size;j+=1)
 				{
-					set_trans_blender(0,0,0,(int)alpha);
-					circle(virt, bloodpool[i].x-map_x, bloodpool[i].y-map_y, temp+j, bloodpool[i].color);
+					dl_set_trans_blender(0,0,0,(int)alpha);
+					dl_circle(virt, bloodpool[i].x-map_x, bloodpool[i].y-map_y, temp+j, bloodpool[i].color);
 					alpha-=dec;
 					if(alpha<0)alpha=0;
 				}
-				drawing_mode(DRAW_MODE_SOLID,NULL,0,0);
+				dl_drawing_mode(DRAW_MODE_SOLID,NULL,0,0);
 			}
 }
 
@@ -560,39 +562,39 @@ void make_flesh_explosion(int x, int y, int size, int angle)
 	char stain[4][20]={"bloodstain1","bloodstain2","bloodstain3","bloodstain4"};
 	char part[4][20]={"bodypart1","bodypart2","bodypart3","bodypart4"};
 
-	amount = RANDOM(6,10);
+	amount = RANDOM_IN(RANDOM_PARTICLES, 6,10);
 	for(j=0;j<amount;j++)
 	{
-		x_add = RANDOM(-17,17);
-		y_add = RANDOM(-17,17);
-		make_new_particle(stain[RANDOM(0,3)],x+x_add, y+y_add, 
-						add_angle(angle,RANDOM(-120,120)),0, 0, -1,0);
+		x_add = RANDOM_IN(RANDOM_PARTICLES, -17,17);
+		y_add = RANDOM_IN(RANDOM_PARTICLES, -17,17);
+		make_new_particle(stain[RANDOM_IN(RANDOM_PARTICLES, 0,3)],x+x_add, y+y_add, 
+						add_angle(angle,RANDOM_IN(RANDOM_PARTICLES, -120,120)),0, 0, -1,0);
 	}
-	amount = RANDOM(7,16);
+	amount = RANDOM_IN(RANDOM_PARTICLES, 7,16);
 	for(j=0;j<amount;j++)
 	{
-		x_add = RANDOM(-5,5);
-		y_add = RANDOM(-5,5);
+		x_add = RANDOM_IN(RANDOM_PARTICLES, -5,5);
+		y_add = RANDOM_IN(RANDOM_PARTICLES, -5,5);
 		make_new_particle("blood2",x+x_add, y+y_add, 
-						add_angle(angle,RANDOM(-120,120)),(float)(RANDOM(90,140))/100,
+						add_angle(angle,RANDOM_IN(RANDOM_PARTICLES, -120,120)),(float)(RANDOM_IN(RANDOM_PARTICLES, 90,140))/100,
 						0.023, -1,0);
 	}
-	amount = RANDOM(14,24);
+	amount = RANDOM_IN(RANDOM_PARTICLES, 14,24);
 	for(j=0;j<amount;j++)
 	{
-		x_add = RANDOM(-5,5);
-		y_add = RANDOM(-5,5);
+		x_add = RANDOM_IN(RANDOM_PARTICLES, -5,5);
+		y_add = RANDOM_IN(RANDOM_PARTICLES, -5,5);
 		make_new_particle("blood1",x+x_add, y+y_add, 
-						RANDOM((0),359),(float)(RANDOM(150,190))/100,
-						0.023, RANDOM(40,130),1);
+						RANDOM_IN(RANDOM_PARTICLES, (0),359),(float)(RANDOM_IN(RANDOM_PARTICLES, 150,190))/100,
+						0.023, RANDOM_IN(RANDOM_PARTICLES, 40,130),1);
 	}
-	amount = RANDOM(3,6);
+	amount = RANDOM_IN(RANDOM_PARTICLES, 3,6);
 	for(j=0;j<amount;j++)
 	{
-		x_add = RANDOM(-15,15);
-		y_add = RANDOM(-15,15);
-		make_new_particle(part[RANDOM(0,4)],x+x_add, y+y_add, 
-						add_angle(angle,RANDOM(-90,90)),(float)(RANDOM(100,140))/100,
+		x_add = RANDOM_IN(RANDOM_PARTICLES, -15,15);
+		y_add = RANDOM_IN(RANDOM_PARTICLES, -15,15);
+		make_new_particle(part[RANDOM_IN(RANDOM_PARTICLES, 0,4)],x+x_add, y+y_add, 
+						add_angle(angle,RANDOM_IN(RANDOM_PARTICLES, -90,90)),(float)(RANDOM_IN(RANDOM_PARTICLES, 100,140))/100,
 						0.023, -1,0);
 	}*/
 	
@@ -666,7 +668,7 @@ void draw_flames(void)
 			if(object_is_in_player_los(flame_data[i].x,flame_data[i].y,get_bitmap_w(flame_pic[type].dat),get_bitmap_h(flame_pic[type].dat),0,0)) 
 			{
 				//set_alpha_blender();
-				draw_additive_sprite(virt,flame_pic[type].dat, 
+				dl_draw_additive_sprite(virt,flame_pic[type].dat, 
 					flame_data[i].x - get_bitmap_w(flame_pic[type].dat)/2-map_x,
 					flame_data[i].y - get_bitmap_h(flame_pic[type].dat)/2-map_y);
 			}
@@ -857,7 +859,7 @@ void draw_shells(void)
 
 			if(object_is_in_player_los(shell_data[i].x,shell_data[i].y,get_bitmap_w(particle_info[type].pic[0].dat),get_bitmap_h(particle_info[type].pic[0].dat),0,0)) 
 			{
-				rotate_scaled_sprite(virt,particle_info[type].pic[0].dat, 
+				dl_rotate_scaled_sprite(virt,particle_info[type].pic[0].dat, 
 					shell_data[i].x - get_bitmap_w(particle_info[type].pic[0].dat)/2-map_x,
 					shell_data[i].y - get_bitmap_h(particle_info[type].pic[0].dat)/2-map_y,
 					degree_to_fixed(shell_data[i].angle),
@@ -1065,6 +1067,7 @@ void update_load_text(char *string)
 {
 	//text_mode(0);
 	textprintf_ex(screen,font_small1->dat,0,465,makecol(255,255,255),0,"%s          ",string);
+	present_rect(0,465,screen->w,15);
 }
 
 
@@ -1113,6 +1116,56 @@ void get_args(int argc, char *argv[])
 			{
 				vsync_is_on =1;
 			}
+			else if(strcasecmp(temp,"headless")==0)
+			{
+				headless_is_on =1;
+			}
+			else if(strcasecmp(temp,"benchmark")==0)
+			{
+				headless_is_on =1;
+				if(i+1<argc && argv[i+1][0]!='-')
+				{
+					benchmark_frames = atoi(argv[i+1]);
+					i++;
+				}
+			}
+			else if(strcasecmp(temp,"record")==0 || strcasecmp(temp,"replay")==0)
+			{
+				if(i+1<argc)
+				{
+					replay_mode = strcasecmp(temp,"record")==0 ? REPLAY_RECORD : REPLAY_PLAY;
+					strncpy(replay_file, argv[i+1], sizeof(replay_file)-1);
+					i++;
+				}
+			}
+			else if(strcasecmp(temp,"depth")==0)
+			{
+				if(i+1<argc)
+				{
+					color_depth = atoi(argv[i+1])==32 ? 32 : 16;
+					i++;
+				}
+			}
+			else if(strcasecmp(temp,"scale")==0)
+			{
+				if(i+1<argc)
+				{
+					present_scale = atoi(argv[i+1]);
+					i++;
+				}
+			}
+			else if(strcasecmp(temp,"view")==0)
+			{
+				if(i+1<argc)
+				{
+					sscanf(argv[i+1], "%dx%d", &view_w, &view_h);
+					i++;
+				}
+			}
+			else if(strcasecmp(temp,"renderthread")==0)
+			{
+				render_thread_is_on =1;
+			}
 			else if(strcasecmp(temp,"nosound")==0)
 			{
 				sound_is_on =0;
@@ -14,6 +14,7 @@
 #include "fiend.h"
 #include "draw.h"
 #include "rotate_sprite.h"
+#include "draw_list.h"
 #include "path_utils.h"
 
 
@@ -66,16 +67,15 @@ void draw_fiend_object(BITMAP *dest,OBJECT_INFO *temp,int x, int y,int action,in
 
 			if(temp->additive)
 			{
-				draw_additive_sprite(dest, temp->pic[num][pic].data, x-temp->pic[num][pic].data->w/2, y-temp->pic[num][pic].data->h/2);
+				dl_draw_additive_sprite(dest, temp->pic[num][pic].data, x-temp->pic[num][pic].data->w/2, y-temp->pic[num][pic].data->h/2);
 			}
 			else if(temp->trans)
 			{
-				set_trans_blender(0,0,0,temp->trans);
-				draw_trans_rle_sprite(dest, temp->rle_pic[num][pic],x-temp->rle_pic[num][pic]->w/2,y-temp->rle_pic[num][pic]->h/2);
+				dl_draw_blend_rle_sprite(dest, temp->rle_pic[num][pic],x-temp->rle_pic[num][pic]->w/2,y-temp->rle_pic[num][pic]->h/2,temp->trans);
 			}
 			else
 			{
-				draw_rle_sprite(dest, temp->rle_pic[num][pic], x-temp->rle_pic[num][pic]->w/2,y-temp->rle_pic[num][pic]->h/2);
+				dl_draw_rle_sprite(dest, temp->rle_pic[num][pic], x-temp->rle_pic[num][pic]->w/2,y-temp->rle_pic[num][pic]->h/2);
 			}
 			
 		}
@@ -83,16 +83,15 @@ void draw_fiend_object(BITMAP *dest,OBJECT_INFO *temp,int x, int y,int action,in
 		{
 			if(temp->additive)
 			{
-				draw_additive_sprite(dest, temp->pic[num][0].data,x-temp->pic[num][0].data->w/2,y-temp->pic[num][0].data->h/2);
+				dl_draw_additive_sprite(dest, temp->pic[num][0].data,x-temp->pic[num][0].data->w/2,y-temp->pic[num][0].data->h/2);
 			}
 			else if(temp->trans)
 			{
-				set_trans_blender(0,0,0,temp->trans);
-				draw_trans_sprite(dest, temp->pic[num][0].data,x-temp->pic[num][0].data->w/2,y-temp->pic[num][0].data->h/2);
+				dl_draw_blend_sprite(dest, temp->pic[num][0].data,x-temp->pic[num][0].data->w/2,y-temp->pic[num][0].data->h/2, temp->trans);
 			}
 			else
 			{
-				draw_sprite(dest, temp->pic[num][0].data,x-temp->pic[num][0].data->w/2,y-temp->pic[num][0].data->h/2);
+				dl_draw_sprite(dest, temp->pic[num][0].data,x-temp->pic[num][0].data->w/2,y-temp->pic[num][0].data->h/2);
 			}
 		}
 	}
@@ -150,9 +149,9 @@ void draw_fiend_object(BITMAP *dest,OBJECT_INFO *temp,int x, int y,int action,in
 			}
 
 			if(temp->additive)
-				rotate_fiend_sprite(dest, temp->pic[num][0].data,x-x_add,y+y_add,the_angle,FIEND_DRAW_MODE_ADDITIVE);
+				dl_rotate_fiend_sprite(dest, temp->pic[num][0].data,x-x_add,y+y_add,the_angle,FIEND_DRAW_MODE_ADDITIVE);
 			else
-				rotate_sprite(dest, temp->pic[num][0].data,x-x_add-temp->pic[num][0].data->w/2,y+y_add-temp->pic[num][0].data->h/2,degree_to_fixed(the_angle));//FIEND_DRAW_MODE_TRANS);
+				dl_rotate_sprite(dest, temp->pic[num][0].data,x-x_add-temp->pic[num][0].data->w/2,y+y_add-temp->pic[num][0].data->h/2,degree_to_fixed(the_angle));//FIEND_DRAW_MODE_TRANS);
 		}
 		
 		//the sliding door
@@ -165,9 +164,9 @@ void draw_fiend_object(BITMAP *dest,OBJECT_INFO *temp,int x, int y,int action,in
 			xyplus(length,add_angle(angle,90),&new_x,&new_y);
 			
 			if(temp->additive)
-				rotate_fiend_sprite(dest, temp->pic[num][0].data,x+new_x,y+new_y,angle,FIEND_DRAW_MODE_ADDITIVE);
+				dl_rotate_fiend_sprite(dest, temp->pic[num][0].data,x+new_x,y+new_y,angle,FIEND_DRAW_MODE_ADDITIVE);
 			else
-				rotate_fiend_sprite(dest, temp->pic[num][0].data,x+new_x,y+new_y,angle,FIEND_DRAW_MODE_TRANS);
+				dl_rotate_fiend_sprite(dest, temp->pic[num][0].data,x+new_x,y+new_y,angle,FIEND_DRAW_MODE_TRANS);
 
 		}
 
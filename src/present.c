@@ -0,0 +1,226 @@
+////////////////////////////////////////////////////
+// This file contains the putting of the frames on the
+// display. When the desktop is 32 bit or the game is
+// scaled up the game still draws in 16 bit, to a
+// screen in memory, and the parts of it that are done
+// are turned into 32 bit pixels and scaled by a whole
+// number in one go, straight into the window. When
+// the game draws in 32 bit the pixels are only scaled.
+///////////////////////////////////////////////////
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <allegro.h>
+
+#include "present.h"
+#include "draw_simd.h"
+#include "logger.h"
+
+
+int present_scale=0;//0 is the biggest that fits on the desktop
+int present_is_on=0;
+
+static BITMAP *display=NULL;//the real screen, screen is the one in memory
+static int display_x=0;//where the scaled screen is on the display
+static int display_y=0;
+static int scale=1;
+
+//the display has 0RGB pixels that can be written a line at a time
+static int fast_path=0;
+
+static unsigned int *row=NULL;//a scaled row
+static unsigned int *unscaled_row=NULL;
+
+//for other displays, the screen is converted by allegro and stretched
+static BITMAP *convert_bitmap=NULL;
+
+
+
+static void release_buffers(void)
+{
+	free(row);
+	free(unscaled_row);
+	row=NULL;
+	unscaled_row=NULL;
+
+	if(convert_bitmap)
+		destroy_bitmap(convert_bitmap);
+	convert_bitmap=NULL;
+}
+
+
+//set a 32 bit graphics mode of w x h scaled, with a screen in memory of
+//depth (16 or 32) for the game. returns 0 if the game should draw
+//straight to a display of its own depth.
+int init_present(int gfx_driver, int w, int h, int depth)
+{
+	int desktop_w, desktop_h;
+
+	scale = present_scale;
+	if(scale<=0)
+	{
+		//leave some of the desktop for the task bar and the window border
+		if(get_desktop_resolution(&desktop_w, &desktop_h)==0)
+			scale = MIN(desktop_w/w, (desktop_h*9/10)/h);
+		else
+			scale = 1;
+	}
+	scale = MID(1, scale, PRESENT_MAX_SCALE);
+
+	if(scale==1 && (depth==32 || desktop_color_depth()!=32))
+		return 0;
+
+	set_color_depth(32);
+	if(set_gfx_mode(gfx_driver, w*scale, h*scale, 0, 0)!=0)
+	{
+		log_warning("Couldn't set a %dx%d 32 bit mode", w*scale, h*scale);
+		return 0;
+	}
+
+	display = screen;
+	display_x = (display->w - w*scale)/2;
+	display_y = (display->h - h*scale)/2;
+
+	fast_path = is_linear_bitmap(display) && bitmap_color_depth(display)==32 &&
+				_rgb_r_shift_32==16 && _rgb_g_shift_32==8 && _rgb_b_shift_32==0;
+
+	if(fast_path)
+	{
+		row = malloc(sizeof(unsigned int)*w*scale);
+		unscaled_row = malloc(sizeof(unsigned int)*w);
+	}
+	else
+	{
+		convert_bitmap = create_bitmap_ex(bitmap_color_depth(display), w, h);
+	}
+
+	//the game is drawn like on a display of its own depth
+	set_color_depth(depth);
+	screen = create_bitmap(w, h);
+
+	if(screen==NULL || (fast_path && (row==NULL || unscaled_row==NULL)) || (!fast_path && convert_bitmap==NULL))
+	{
+		if(screen)
+			destroy_bitmap(screen);
+		screen = display;
+		release_buffers();
+		strcpy(allegro_error, "out of memory");
+		return 0;
+	}
+
+	clear(screen);
+	clear(display);
+
+	present_is_on=1;
+
+	log_info("Presenting %dx%d scaled %d times on a %dx%d %d bit display%s", w, h, scale,
+		display->w, display->h, bitmap_color_depth(display), fast_path ? "" : " (slow path)");
+
+	return 1;
+}
+
+
+void release_present(void)
+{
+	if(!present_is_on)
+		return;
+
+	destroy_bitmap(screen);
+	screen = display;
+	display = NULL;
+
+	release_buffers();
+
+	present_is_on=0;
+}
+
+
+
+//put a part of the screen on the display
+void present_rect(int x, int y, int w, int h)
+{
+	int j,k;
+	unsigned short *src;
+	unsigned int *dest;
+	unsigned int *pix;
+	void (*convert_row)(unsigned int *dest, unsigned short *src, int len);
+
+	if(!present_is_on)
+		return;
+
+	if(x<0){w+=x;x=0;}
+	if(y<0){h+=y;y=0;}
+	if(x+w>screen->w)w=screen->w-x;
+	if(y+h>screen->h)h=screen->h-y;
+	if(w<=0 || h<=0)
+		return;
+
+	if(!fast_path)
+	{
+		blit(screen, convert_bitmap, x, y, x, y, w, h);
+		stretch_blit(convert_bitmap, display, x, y, w, h, display_x+x*scale, display_y+y*scale, w*scale, h*scale);
+		return;
+	}
+
+	if(bitmap_color_depth(screen)==32)
+		convert_row = NULL;
+	else if(bitmap_color_depth(screen)==15)
+		convert_row = convert_row15;
+	else
+		convert_row = convert_row16;
+
+	acquire_bitmap(display);
+
+	for(j=y;j<y+h;j++)
+	{
+		src = (unsigned short*)screen->line[j] + x;
+
+		if(scale==1)
+		{
+			dest = (unsigned int*)bmp_write_line(display, display_y+j) + display_x+x;
+			if(convert_row)
+				convert_row(dest, src, w);
+			else
+				memcpy(dest, (unsigned int*)screen->line[j] + x, sizeof(unsigned int)*w);
+			continue;
+		}
+
+		//32 bit pixels are scaled as they are
+		if(convert_row)
+		{
+			convert_row(unscaled_row, src, w);
+			pix = unscaled_row;
+		}
+		else
+		{
+			pix = (unsigned int*)screen->line[j] + x;
+		}
+
+		scale_row32(row, pix, w, scale);
+
+		for(k=0;k<scale;k++)
+		{
+			dest = (unsigned int*)bmp_write_line(display, display_y+j*scale+k) + display_x+x*scale;
+			memcpy(dest, row, sizeof(unsigned int)*w*scale);
+		}
+	}
+
+	bmp_unwrite_line(display);
+	release_bitmap(display);
+}
+
+
+void present_screen(void)
+{
+	present_rect(0, 0, screen->w, screen->h);
+}
+
+
+//blit to the screen and put that part on the display
+void present_blit(BITMAP *src, int sx, int sy, int dx, int dy, int w, int h)
+{
+	blit(src, screen, sx, sy, dx, dy, w, h);
+	present_rect(dx, dy, w, h);
+}
@@ -0,0 +1,20 @@
+#include <allegro.h>
+
+
+#ifndef PRESENT_H
+#define PRESENT_H
+
+#define PRESENT_MAX_SCALE 4
+
+
+extern int present_scale;
+extern int present_is_on;
+
+int init_present(int gfx_driver, int w, int h, int depth);
+void release_present(void);
+
+void present_rect(int x, int y, int w, int h);
+void present_screen(void);
+void present_blit(BITMAP *src, int sx, int sy, int dx, int dy, int w, int h);
+
+#endif
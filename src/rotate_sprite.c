@@ -6,10 +6,13 @@
 
 
 #include <math.h>
+#include <stdlib.h>
 #include <allegro.h>
 
+#include "fiend.h"
 #include "grafik4.h"
 #include "rotate_sprite.h"
+#include "draw_list.h"
 
 #define RED_MASK16 63488
 #define GREEN_MASK16 2016
@@ -19,17 +22,21 @@
 #define GREEN_MASK15 992
 #define BLUE_MASK15 31
 
+#define RED_MASK32 0xff0000
+#define GREEN_MASK32 0xff00
+#define BLUE_MASK32 0xff
+
 
 #define MAX_HYPOT_LENGTH 1000
 
-static fixed max_x_buffer[480];
-static fixed min_x_buffer[480];
+static fixed max_x_buffer[MAX_VIEW_H];
+static fixed min_x_buffer[MAX_VIEW_H];
 
-static fixed max_u_buffer[480];
-static fixed min_u_buffer[480];
+static fixed max_u_buffer[MAX_VIEW_H];
+static fixed min_u_buffer[MAX_VIEW_H];
 
-static fixed max_v_buffer[480];
-static fixed min_v_buffer[480];
+static fixed max_v_buffer[MAX_VIEW_H];
+static fixed min_v_buffer[MAX_VIEW_H];
 
 static int src_add[MAX_HYPOT_LENGTH];
 
@@ -69,6 +76,8 @@ void rotate_fiend_sprite(BITMAP *dest, BITMAP * src, int dest_x, int dest_y, flo
 
 	register unsigned short *dest_buffer;
 	register unsigned short *src_buffer;
+	unsigned int *dest_buffer32;
+	unsigned int *src_buffer32;
 	register int j;
 	
 	// test for errors //
@@ -116,6 +125,7 @@ void rotate_fiend_sprite(BITMAP *dest, BITMAP * src, int dest_x, int dest_y, flo
 
 	if(min_y<0)min_y=0;
 	if(max_y>=dest->h)max_y=dest->h-1;
+	if(max_y>=MAX_VIEW_H)max_y=MAX_VIEW_H-1;
 
 	if(min_y>=dest->h)return;
 	if(max_y<0)return;
@@ -401,8 +411,26 @@ void rotate_fiend_sprite(BITMAP *dest, BITMAP * src, int dest_x, int dest_y, flo
 	
 	dest_buffer = (short*)dest->line[0];
 	dest_buffer += (min_y*dest->w)+fixtoi(min_x_buffer[min_y]);
+
+	dest_buffer32 = (unsigned int*)dest->line[0];
+	dest_buffer32 += (min_y*dest->w)+fixtoi(min_x_buffer[min_y]);
 		
-	if(bitmap_color_depth(dest) == 16)
+	if(bitmap_color_depth(dest) == 32)
+	{
+		if(draw_mode == FIEND_DRAW_MODE_TRANS)
+		{
+			ROTATE_DRAW_LOOP_TRANS32
+		}
+		else if(draw_mode == FIEND_DRAW_MODE_FLAT)
+		{
+			ROTATE_DRAW_LOOP_FLAT32
+		}
+		else if(draw_mode == FIEND_DRAW_MODE_ADDITIVE)
+		{
+			ROTATE_DRAW_LOOP_ADDITIVE32
+		}
+	}
+	else if(bitmap_color_depth(dest) == 16)
 	{
 		if(draw_mode == FIEND_DRAW_MODE_TRANS)
 		{
@@ -436,3 +464,206 @@ void rotate_fiend_sprite(BITMAP *dest, BITMAP * src, int dest_x, int dest_y, flo
 
 
 
+
+
+
+/////////////////////////////////////////////////
+////////// ROTATION CACHE ///////////////////////
+/////////////////////////////////////////////////
+
+//pivot_sprite is slow, so characters and enemies are rotated once for
+//each angle step and kept as rle sprites. The least used ones are
+//thrown away when the cache gets bigger than rotation_cache_budget.
+
+#define ROTATION_CACHE_ANGLES 128
+#define ROTATION_CACHE_HASH_SIZE 1024
+
+typedef struct ROTATION_CACHE_ENTRY
+{
+	BITMAP *src;//what was rotated
+	int cx;
+	int cy;
+	int angle;//0 - ROTATION_CACHE_ANGLES-1
+
+	RLE_SPRITE *pic;//NULL if nothing was visible
+	int x;//where the pivot ended up in pic
+	int y;
+	int size;
+
+	struct ROTATION_CACHE_ENTRY *hash_next;
+	struct ROTATION_CACHE_ENTRY *prev;//the lru list, newest first
+	struct ROTATION_CACHE_ENTRY *next;
+}ROTATION_CACHE_ENTRY;
+
+
+int rotation_cache_is_on=1;
+int rotation_cache_budget=8192;//in kb
+
+static ROTATION_CACHE_ENTRY *rotation_hash[ROTATION_CACHE_HASH_SIZE];
+static ROTATION_CACHE_ENTRY *newest_rotation=NULL;
+static ROTATION_CACHE_ENTRY *oldest_rotation=NULL;
+static int rotation_cache_size=0;
+
+
+static int rotation_hash_key(BITMAP *src, int cx, int cy, int angle)
+{
+	unsigned long key = (unsigned long)src;
+
+	key = (key>>4) ^ (key>>12);
+	key = key*31 + cx;
+	key = key*31 + cy;
+	key = key*31 + angle;
+
+	return key % ROTATION_CACHE_HASH_SIZE;
+}
+
+
+static void unlink_rotation(ROTATION_CACHE_ENTRY *temp)
+{
+	if(temp->prev)temp->prev->next = temp->next;
+	else newest_rotation = temp->next;
+
+	if(temp->next)temp->next->prev = temp->prev;
+	else oldest_rotation = temp->prev;
+}
+
+
+static void link_rotation_first(ROTATION_CACHE_ENTRY *temp)
+{
+	temp->prev = NULL;
+	temp->next = newest_rotation;
+
+	if(newest_rotation)newest_rotation->prev = temp;
+	newest_rotation = temp;
+
+	if(oldest_rotation==NULL)oldest_rotation = temp;
+}
+
+
+static void remove_rotation(ROTATION_CACHE_ENTRY *temp)
+{
+	ROTATION_CACHE_ENTRY **hash;
+
+	hash = &rotation_hash[rotation_hash_key(temp->src, temp->cx, temp->cy, temp->angle)];
+	while(*hash!=temp)
+		hash = &(*hash)->hash_next;
+	*hash = temp->hash_next;
+
+	unlink_rotation(temp);
+
+	rotation_cache_size -= temp->size;
+
+	if(temp->pic)
+		dl_destroy_rle_sprite(temp->pic);
+	free(temp);
+}
+
+
+//rotate the sprite into a buffer big enough for any angle, then cut
+//away the empty border.
+static ROTATION_CACHE_ENTRY *make_rotation(BITMAP *src, int cx, int cy, int angle)
+{
+	ROTATION_CACHE_ENTRY *temp;
+	BITMAP *buffer;
+	BITMAP *sub;
+	int mask_color;
+	int r,i,j;
+	int x1,y1,x2,y2;
+
+	temp = calloc(sizeof(ROTATION_CACHE_ENTRY),1);
+	temp->src = src;
+	temp->cx = cx;
+	temp->cy = cy;
+	temp->angle = angle;
+
+	r = 2 + (int)sqrt( (double)MAX(cx*cx, (src->w-cx)*(src->w-cx)) + MAX(cy*cy, (src->h-cy)*(src->h-cy)) );
+
+	buffer = create_bitmap_ex(bitmap_color_depth(src), r*2, r*2);
+	mask_color = bitmap_mask_color(buffer);
+	clear_to_color(buffer, mask_color);
+
+	pivot_sprite(buffer, src, r, r, cx, cy, itofix(angle*256)/ROTATION_CACHE_ANGLES);
+
+	x1=buffer->w; y1=buffer->h;
+	x2=-1; y2=-1;
+
+	for(j=0;j<buffer->h;j++)
+		for(i=0;i<buffer->w;i++)
+			if(getpixel(buffer,i,j)!=mask_color)
+			{
+				if(i<x1)x1=i;
+				if(i>x2)x2=i;
+				if(j<y1)y1=j;
+				if(j>y2)y2=j;
+			}
+
+	if(x2>=0)
+	{
+		sub = create_sub_bitmap(buffer, x1, y1, x2-x1+1, y2-y1+1);
+		temp->pic = dl_get_rle_sprite(sub);
+		temp->x = r-x1;
+		temp->y = r-y1;
+		temp->size = temp->pic->size;
+		destroy_bitmap(sub);
+	}
+
+	temp->size += sizeof(ROTATION_CACHE_ENTRY);
+
+	destroy_bitmap(buffer);
+
+	return temp;
+}
+
+
+//same as pivot_sprite, but the angle is in degrees and is rounded
+//to the nearest of ROTATION_CACHE_ANGLES steps.
+void pivot_cached_sprite(BITMAP *dest, BITMAP *sprite, int x, int y, int cx, int cy, float angle)
+{
+	ROTATION_CACHE_ENTRY *temp;
+	int step;
+	int key;
+
+	if(!rotation_cache_is_on)
+	{
+		dl_pivot_sprite(dest, sprite, x, y, cx, cy, degree_to_fixed(angle));
+		return;
+	}
+
+	step = (int)floor(angle*ROTATION_CACHE_ANGLES/360 + 0.5) % ROTATION_CACHE_ANGLES;
+	if(step<0)step += ROTATION_CACHE_ANGLES;
+
+	key = rotation_hash_key(sprite, cx, cy, step);
+
+	for(temp=rotation_hash[key];temp!=NULL;temp=temp->hash_next)
+		if(temp->src==sprite && temp->angle==step && temp->cx==cx && temp->cy==cy)
+			break;
+
+	if(temp)
+	{
+		unlink_rotation(temp);
+	}
+	else
+	{
+		temp = make_rotation(sprite, cx, cy, step);
+
+		temp->hash_next = rotation_hash[key];
+		rotation_hash[key] = temp;
+
+		rotation_cache_size += temp->size;
+		while(rotation_cache_size > rotation_cache_budget*1024 && oldest_rotation)
+			remove_rotation(oldest_rotation);
+	}
+
+	link_rotation_first(temp);
+
+	if(temp->pic)
+		dl_draw_rle_sprite(dest, temp->pic, x-temp->x, y-temp->y);
+}
+
+
+//throw away all rotations. must be called before the sprites are freed.
+void release_rotation_cache(void)
+{
+	while(oldest_rotation)
+		remove_rotation(oldest_rotation);
+}
@@ -9,6 +9,12 @@ void rotate_fiend_sprite(BITMAP *dest, BITMAP * src, int dest_x, int dest_y, flo
 
 void pivot_fiend_sprite(BITMAP *bmp, BITMAP *sprite, int x, int y, int cx, int cy, float angle, int draw_mode);
 
+extern int rotation_cache_is_on;
+extern int rotation_cache_budget;
+
+void pivot_cached_sprite(BITMAP *dest, BITMAP *sprite, int x, int y, int cx, int cy, float angle);
+void release_rotation_cache(void);
+
 
 #endif 
 
@@ -0,0 +1,420 @@
+////////////////////////////////////////////////////
+// This file contains the threads, semaphores and
+// mutexes used by the render thread and the worker
+// pools that split drawing between the cpus.
+// pthreads on unix and the win32 api on windows.
+// It also has a precise clock for timing.
+///////////////////////////////////////////////////
+
+
+#include <stdlib.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <unistd.h>
+    #include <time.h>
+#endif
+
+#include "thread.h"
+
+
+#ifdef _WIN32
+
+struct FIEND_THREAD
+{
+	HANDLE handle;
+	void (*func)(void *arg);
+	void *arg;
+};
+
+struct FIEND_SEMAPHORE
+{
+	HANDLE handle;
+};
+
+struct FIEND_MUTEX
+{
+	CRITICAL_SECTION section;
+};
+
+
+static DWORD WINAPI thread_start(LPVOID data)
+{
+	FIEND_THREAD *thread = data;
+
+	thread->func(thread->arg);
+
+	return 0;
+}
+
+
+FIEND_THREAD *create_fiend_thread(void (*func)(void *arg), void *arg)
+{
+	FIEND_THREAD *thread = calloc(sizeof(FIEND_THREAD),1);
+
+	thread->func = func;
+	thread->arg = arg;
+	thread->handle = CreateThread(NULL, 0, thread_start, thread, 0, NULL);
+
+	if(thread->handle==NULL)
+	{
+		free(thread);
+		return NULL;
+	}
+
+	return thread;
+}
+
+
+void join_fiend_thread(FIEND_THREAD *thread)
+{
+	WaitForSingleObject(thread->handle, INFINITE);
+	CloseHandle(thread->handle);
+	free(thread);
+}
+
+
+FIEND_SEMAPHORE *create_fiend_semaphore(int count)
+{
+	FIEND_SEMAPHORE *sem = calloc(sizeof(FIEND_SEMAPHORE),1);
+
+	sem->handle = CreateSemaphore(NULL, count, 0x7fffffff, NULL);
+
+	return sem;
+}
+
+void destroy_fiend_semaphore(FIEND_SEMAPHORE *sem)
+{
+	CloseHandle(sem->handle);
+	free(sem);
+}
+
+void fiend_semaphore_wait(FIEND_SEMAPHORE *sem)
+{
+	WaitForSingleObject(sem->handle, INFINITE);
+}
+
+void fiend_semaphore_post(FIEND_SEMAPHORE *sem)
+{
+	ReleaseSemaphore(sem->handle, 1, NULL);
+}
+
+
+FIEND_MUTEX *create_fiend_mutex(void)
+{
+	FIEND_MUTEX *mutex = calloc(sizeof(FIEND_MUTEX),1);
+
+	InitializeCriticalSection(&mutex->section);
+
+	return mutex;
+}
+
+void destroy_fiend_mutex(FIEND_MUTEX *mutex)
+{
+	DeleteCriticalSection(&mutex->section);
+	free(mutex);
+}
+
+void lock_fiend_mutex(FIEND_MUTEX *mutex)
+{
+	EnterCriticalSection(&mutex->section);
+}
+
+void unlock_fiend_mutex(FIEND_MUTEX *mutex)
+{
+	LeaveCriticalSection(&mutex->section);
+}
+
+
+int get_num_of_cpus(void)
+{
+	SYSTEM_INFO info;
+
+	GetSystemInfo(&info);
+
+	return info.dwNumberOfProcessors;
+}
+
+
+double get_precise_time(void)
+{
+	LARGE_INTEGER count, freq;
+
+	QueryPerformanceCounter(&count);
+	QueryPerformanceFrequency(&freq);
+
+	return (double)count.QuadPart/(double)freq.QuadPart;
+}
+
+
+#else //pthreads
+
+
+struct FIEND_THREAD
+{
+	pthread_t handle;
+	void (*func)(void *arg);
+	void *arg;
+};
+
+//posix semaphores are missing on some systems, so make one
+struct FIEND_SEMAPHORE
+{
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	int count;
+};
+
+struct FIEND_MUTEX
+{
+	pthread_mutex_t mutex;
+};
+
+
+static void *thread_start(void *data)
+{
+	FIEND_THREAD *thread = data;
+
+	thread->func(thread->arg);
+
+	return NULL;
+}
+
+
+FIEND_THREAD *create_fiend_thread(void (*func)(void *arg), void *arg)
+{
+	FIEND_THREAD *thread = calloc(sizeof(FIEND_THREAD),1);
+
+	thread->func = func;
+	thread->arg = arg;
+
+	if(pthread_create(&thread->handle, NULL, thread_start, thread)!=0)
+	{
+		free(thread);
+		return NULL;
+	}
+
+	return thread;
+}
+
+
+void join_fiend_thread(FIEND_THREAD *thread)
+{
+	pthread_join(thread->handle, NULL);
+	free(thread);
+}
+
+
+FIEND_SEMAPHORE *create_fiend_semaphore(int count)
+{
+	FIEND_SEMAPHORE *sem = calloc(sizeof(FIEND_SEMAPHORE),1);
+
+	pthread_mutex_init(&sem->mutex, NULL);
+	pthread_cond_init(&sem->cond, NULL);
+	sem->count = count;
+
+	return sem;
+}
+
+void destroy_fiend_semaphore(FIEND_SEMAPHORE *sem)
+{
+	pthread_cond_destroy(&sem->cond);
+	pthread_mutex_destroy(&sem->mutex);
+	free(sem);
+}
+
+void fiend_semaphore_wait(FIEND_SEMAPHORE *sem)
+{
+	pthread_mutex_lock(&sem->mutex);
+	while(sem->count==0)
+		pthread_cond_wait(&sem->cond, &sem->mutex);
+	sem->count--;
+	pthread_mutex_unlock(&sem->mutex);
+}
+
+void fiend_semaphore_post(FIEND_SEMAPHORE *sem)
+{
+	pthread_mutex_lock(&sem->mutex);
+	sem->count++;
+	pthread_cond_signal(&sem->cond);
+	pthread_mutex_unlock(&sem->mutex);
+}
+
+
+FIEND_MUTEX *create_fiend_mutex(void)
+{
+	FIEND_MUTEX *mutex = calloc(sizeof(FIEND_MUTEX),1);
+
+	pthread_mutex_init(&mutex->mutex, NULL);
+
+	return mutex;
+}
+
+void destroy_fiend_mutex(FIEND_MUTEX *mutex)
+{
+	pthread_mutex_destroy(&mutex->mutex);
+	free(mutex);
+}
+
+void lock_fiend_mutex(FIEND_MUTEX *mutex)
+{
+	pthread_mutex_lock(&mutex->mutex);
+}
+
+void unlock_fiend_mutex(FIEND_MUTEX *mutex)
+{
+	pthread_mutex_unlock(&mutex->mutex);
+}
+
+
+int get_num_of_cpus(void)
+{
+	long num = sysconf(_SC_NPROCESSORS_ONLN);
+
+	if(num<1)
+		return 1;
+
+	return num;
+}
+
+
+double get_precise_time(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec + now.tv_nsec/1000000000.0;
+}
+
+#endif
+
+
+
+//////////////////////////////////////////////////
+// Worker pools. run_worker_jobs hands out the jobs
+// 0 to num_of_jobs-1 to the workers and the calling
+// thread and returns when all are done.
+//////////////////////////////////////////////////
+
+struct FIEND_WORKER_POOL
+{
+	int num_of_workers;
+	FIEND_THREAD **thread;
+
+	FIEND_SEMAPHORE *start;
+	FIEND_SEMAPHORE *done;
+	FIEND_MUTEX *mutex;
+
+	void (*job)(void *arg, int num);
+	void *arg;
+	int num_of_jobs;
+	int next_job;
+	int quit;
+};
+
+
+//run jobs until there are none left
+static void do_worker_jobs(FIEND_WORKER_POOL *pool)
+{
+	int num;
+
+	while(1)
+	{
+		lock_fiend_mutex(pool->mutex);
+		num = pool->next_job++;
+		unlock_fiend_mutex(pool->mutex);
+
+		if(num >= pool->num_of_jobs)
+			break;
+
+		pool->job(pool->arg, num);
+	}
+}
+
+
+static void worker_thread(void *arg)
+{
+	FIEND_WORKER_POOL *pool = arg;
+
+	while(1)
+	{
+		fiend_semaphore_wait(pool->start);
+
+		if(pool->quit)
+			break;
+
+		do_worker_jobs(pool);
+
+		fiend_semaphore_post(pool->done);
+	}
+}
+
+
+FIEND_WORKER_POOL *create_worker_pool(int num_of_workers)
+{
+	int i;
+	FIEND_WORKER_POOL *pool = calloc(sizeof(FIEND_WORKER_POOL),1);
+
+	pool->thread = calloc(sizeof(FIEND_THREAD*), num_of_workers);
+	pool->start = create_fiend_semaphore(0);
+	pool->done = create_fiend_semaphore(0);
+	pool->mutex = create_fiend_mutex();
+
+	for(i=0;i<num_of_workers;i++)
+	{
+		pool->thread[i] = create_fiend_thread(worker_thread, pool);
+		if(pool->thread[i]==NULL)
+			break;
+
+		pool->num_of_workers++;
+	}
+
+	if(pool->num_of_workers==0)
+	{
+		destroy_worker_pool(pool);
+		return NULL;
+	}
+
+	return pool;
+}
+
+
+void destroy_worker_pool(FIEND_WORKER_POOL *pool)
+{
+	int i;
+
+	pool->quit = 1;
+
+	for(i=0;i<pool->num_of_workers;i++)
+		fiend_semaphore_post(pool->start);
+	for(i=0;i<pool->num_of_workers;i++)
+		join_fiend_thread(pool->thread[i]);
+
+	destroy_fiend_mutex(pool->mutex);
+	destroy_fiend_semaphore(pool->done);
+	destroy_fiend_semaphore(pool->start);
+	free(pool->thread);
+	free(pool);
+}
+
+
+void run_worker_jobs(FIEND_WORKER_POOL *pool, void (*job)(void *arg, int num), void *arg, int num_of_jobs)
+{
+	int i;
+
+	pool->job = job;
+	pool->arg = arg;
+	pool->num_of_jobs = num_of_jobs;
+	pool->next_job = 0;
+
+	for(i=0;i<pool->num_of_workers;i++)
+		fiend_semaphore_post(pool->start);
+
+	do_worker_jobs(pool);
+
+	for(i=0;i<pool->num_of_workers;i++)
+		fiend_semaphore_wait(pool->done);
+}
@@ -0,0 +1,37 @@
+////////////////////////////////////////////////////
+// Threads, semaphores, mutexes, worker pools and a
+// precise clock. Uses pthreads or the win32 api, so
+// it does not include allegro.
+///////////////////////////////////////////////////
+
+#ifndef THREAD_H
+#define THREAD_H
+
+typedef struct FIEND_THREAD FIEND_THREAD;
+typedef struct FIEND_SEMAPHORE FIEND_SEMAPHORE;
+typedef struct FIEND_MUTEX FIEND_MUTEX;
+typedef struct FIEND_WORKER_POOL FIEND_WORKER_POOL;
+
+
+FIEND_THREAD *create_fiend_thread(void (*func)(void *arg), void *arg);
+void join_fiend_thread(FIEND_THREAD *thread);
+
+FIEND_SEMAPHORE *create_fiend_semaphore(int count);
+void destroy_fiend_semaphore(FIEND_SEMAPHORE *sem);
+void fiend_semaphore_wait(FIEND_SEMAPHORE *sem);
+void fiend_semaphore_post(FIEND_SEMAPHORE *sem);
+
+FIEND_MUTEX *create_fiend_mutex(void);
+void destroy_fiend_mutex(FIEND_MUTEX *mutex);
+void lock_fiend_mutex(FIEND_MUTEX *mutex);
+void unlock_fiend_mutex(FIEND_MUTEX *mutex);
+
+int get_num_of_cpus(void);
+
+double get_precise_time(void);//seconds, only good for differences
+
+FIEND_WORKER_POOL *create_worker_pool(int num_of_workers);
+void destroy_worker_pool(FIEND_WORKER_POOL *pool);
+void run_worker_jobs(FIEND_WORKER_POOL *pool, void (*job)(void *arg, int num), void *arg, int num_of_jobs);
+
+#endif
@@ -18,6 +18,10 @@
 #include "console.h"
 #include "logger.h"
 #include "path_utils.h"
+#include "tile_cache.h"
+#include "tile_plan.h"
+#include "tile_atlas.h"
+#include "draw_list.h"
 
 
 
@@ -38,20 +42,167 @@ int num_of_tilesets=0;
 static int tile_frame_count=0;
 
 
-void update_tiles(void)
+//the animated tiles, the ones with the same speed are next to each other
+static TILE_ANIM *anim_tile=NULL;
+static int num_of_anim_tiles=0;
+
+static TILE_ANIM_GROUP *anim_group=NULL;
+static int num_of_anim_groups=0;
+
+//the groups that are due at each update, a group with a longer time
+//than the wheel waits some turns of the wheel.
+static int tile_wheel[TILE_WHEEL_SIZE];
+static int tile_wheel_pos=0;
+
+
+
+static int anim_tile_speed(TILE_ANIM *temp)
+{
+	return MAX(tile_info[temp->tile_set].tile[temp->tile_num].anim_speed, 1);
+}
+
+
+static int compare_anim_speed(const void *a, const void *b)
+{
+	return anim_tile_speed((TILE_ANIM*)a) - anim_tile_speed((TILE_ANIM*)b);
+}
+
+
+//let a group show the next frame in ticks updates
+static void schedule_tile_group(int num, int ticks)
+{
+	int slot = (tile_wheel_pos + ticks) % TILE_WHEEL_SIZE;
+
+	anim_group[num].rounds = (ticks-1) / TILE_WHEEL_SIZE;
+	anim_group[num].next = tile_wheel[slot];
+	tile_wheel[slot] = num;
+}
+
+
+static void release_tile_animations(void)
+{
+	free(anim_tile);
+	free(anim_group);
+	anim_tile=NULL;
+	anim_group=NULL;
+	num_of_anim_tiles=0;
+	num_of_anim_groups=0;
+}
+
+
+//find the animated tiles and group them by speed
+static int make_tile_animations(void)
 {
 	int i,j;
 
+	release_tile_animations();
+
+	for(i=0;i<TILE_WHEEL_SIZE;i++)
+		tile_wheel[i] = -1;
+	tile_wheel_pos=0;
+
 	for(i=0;i<num_of_tilesets;i++)
 		for(j=0;j<tile_info[i].num_of_tiles;j++)
-		{
-			if(tile_info[i].tile[j].next_tile>-1 && tile_info[i].tile[j].anim_count >= tile_info[i].tile[j].anim_speed)
+			if(tile_info[i].tile[j].next_tile>-1)
+				num_of_anim_tiles++;
+
+	if(num_of_anim_tiles==0)
+		return 1;
+
+	anim_tile = malloc(sizeof(TILE_ANIM)*num_of_anim_tiles);
+	anim_group = malloc(sizeof(TILE_ANIM_GROUP)*num_of_anim_tiles);
+	if(anim_tile==NULL || anim_group==NULL)
+	{
+		release_tile_animations();
+		return 0;
+	}
+
+	num_of_anim_tiles=0;
+	for(i=0;i<num_of_tilesets;i++)
+		for(j=0;j<tile_info[i].num_of_tiles;j++)
+			if(tile_info[i].tile[j].next_tile>-1)
 			{
-				tile_info[i].tile[j].current_tile = tile_info[i].tile[tile_info[i].tile[j].current_tile].next_tile;
-				tile_info[i].tile[j].anim_count=0;
+				anim_tile[num_of_anim_tiles].tile_set = i;
+				anim_tile[num_of_anim_tiles].tile_num = j;
+				num_of_anim_tiles++;
 			}
-			tile_info[i].tile[j].anim_count++;
+
+	qsort(anim_tile, num_of_anim_tiles, sizeof(TILE_ANIM), compare_anim_speed);
+
+	for(i=0;i<num_of_anim_tiles;i++)
+	{
+		if(i==0 || anim_tile_speed(&anim_tile[i])!=anim_group[num_of_anim_groups-1].speed)
+		{
+			anim_group[num_of_anim_groups].speed = anim_tile_speed(&anim_tile[i]);
+			anim_group[num_of_anim_groups].first = i;
+			anim_group[num_of_anim_groups].num = 0;
+			num_of_anim_groups++;
+		}
+		anim_group[num_of_anim_groups-1].num++;
+	}
+
+	//the counters start at 0, so the first frame is one update later
+	for(i=0;i<num_of_anim_groups;i++)
+	{
+		j = tile_info[anim_tile[anim_group[i].first].tile_set].tile[anim_tile[anim_group[i].first].tile_num].anim_speed;
+		schedule_tile_group(i, j>0 ? j+1 : 1);
+	}
+
+	return 1;
+}
+
+
+//show the next frame of the tiles in a group
+static void animate_tile_group(TILE_ANIM_GROUP *group)
+{
+	TILE_INFO *temp;
+	int i;
+
+	for(i=group->first;i<group->first+group->num;i++)
+	{
+		temp = &tile_info[anim_tile[i].tile_set].tile[anim_tile[i].tile_num];
+
+		if(tile_info[anim_tile[i].tile_set].tile[temp->current_tile].next_tile>-1)
+			temp->current_tile = tile_info[anim_tile[i].tile_set].tile[temp->current_tile].next_tile;
+		temp->anim_count=0;
+
+		tile_plan_tile_changed(anim_tile[i].tile_set, anim_tile[i].tile_num);
+		tile_cache_tile_changed(anim_tile[i].tile_set, anim_tile[i].tile_num);
+	}
+}
+
+
+//only the groups that are due this update are looked at
+void update_tiles(void)
+{
+	int num, next;
+
+	if(num_of_anim_groups==0)
+		return;
+
+	tile_wheel_pos = (tile_wheel_pos+1) % TILE_WHEEL_SIZE;
+
+	num = tile_wheel[tile_wheel_pos];
+	tile_wheel[tile_wheel_pos] = -1;
+
+	while(num>-1)
+	{
+		next = anim_group[num].next;
+
+		if(anim_group[num].rounds>0)
+		{
+			anim_group[num].rounds--;
+			anim_group[num].next = tile_wheel[tile_wheel_pos];
+			tile_wheel[tile_wheel_pos] = num;
 		}
+		else
+		{
+			animate_tile_group(&anim_group[num]);
+			schedule_tile_group(num, anim_group[num].speed);
+		}
+
+		num = next;
+	}
 }
 
 
@@ -121,6 +272,11 @@ int load_tiles(void)
 
 	}
    
+	if(!make_tile_animations())
+	{sprintf(fiend_errorcode,"couldn't allocate the tile animations");return 1;}
+
+	if(!make_tile_atlas())
+	{sprintf(fiend_errorcode,"couldn't allocate the tile atlas");return 1;}
 	
 	return 0;
 
@@ -134,12 +290,16 @@ void release_tiles(void)
 {
 	int i;
 
+	release_tile_atlas();
+
 	for(i=0;i<num_of_tilesets;i++)
 	{
 		unload_rle_array(tile_data[i]);
 
 	}
 	
+	release_tile_animations();
+
 	free(tile_info);
 }
 
@@ -147,14 +307,83 @@ void release_tiles(void)
 
 
 
+//get the set and the number that a layer of a map cell is showing right now.
+//invalid tiles are treated as the blank tile.
+static void get_cell_tile(TILE_DATA *layer_data, int x, int y, int *tile_set, int *tile_num)
+{
+	*tile_set = (layer_data+ x +( y * map->w))->tile_set;
+	*tile_num = (layer_data+ x +( y * map->w))->tile_num;
+
+	// Skip bounds check - set defaults for invalid values
+	if(!(*tile_set >= 0 && *tile_set < num_of_tilesets && *tile_num >= 0 && *tile_num < 100)) {
+		*tile_set = 0;
+		*tile_num = 0;
+	} else {
+		*tile_num = tile_info[*tile_set].tile[*tile_num].current_tile;
+	}
+}
+
+
+//checks if a map cell has something to draw in a layer pass. returns
+//TILE_DRAW_NONE, TILE_DRAW_NORMAL or TILE_DRAW_TRANS and sets the tile to draw.
+//Don't forget that the FIRST layer is 1 NOT 0
+int get_tile_layer_cell(int layer, int solid, int x, int y, int *set, int *num)
+{
+	int tile_set[4];
+	int	tile_num[4];
+
+	get_cell_tile(map->layer1, x, y, &tile_set[1], &tile_num[1]);
+	get_cell_tile(map->layer2, x, y, &tile_set[2], &tile_num[2]);
+	get_cell_tile(map->layer3, x, y, &tile_set[3], &tile_num[3]);
+
+	*set = tile_set[layer];
+	*num = tile_num[layer];
+
+	switch(layer) //What layer should be drawn...
+	{
+	case 1://Check if there any solid tiles above if not draw the tile
+		if(tile_info[tile_set[1]].tile[tile_num[1]].solid==solid)
+			if( tile_info[tile_set[2]].tile[tile_num[2]].masked || tile_info[tile_set[2]].tile[tile_num[2]].trans ||
+				tile_info[tile_set[3]].tile[tile_num[3]].masked || tile_info[tile_set[3]].tile[tile_num[3]].trans)
+				return TILE_DRAW_NORMAL;
+		break;
+
+	case 2://Check if there any solid tiles above if not draw the tile
+		if(tile_info[tile_set[2]].tile[tile_num[2]].solid==solid)
+			if( tile_info[tile_set[3]].tile[tile_num[3]].masked || tile_info[tile_set[3]].tile[tile_num[3]].trans)
+				if(tile_set[layer]!=0 || tile_num[layer]!=0)//if it is balnk don't draw it
+				{
+					if(tile_info[tile_set[layer]].tile[tile_num[layer]].trans)//shall trans or normal drawing bee used..
+						return TILE_DRAW_TRANS;
+					else
+						return TILE_DRAW_NORMAL;
+				}
+		break;
+
+	case 3:
+		if(tile_info[tile_set[3]].tile[tile_num[3]].solid==solid)
+			if(tile_set[layer]!=0 || tile_num[layer]!=0)//if it is balnk don't draw it
+			{
+				if(tile_info[tile_set[layer]].tile[tile_num[layer]].trans)//shall trans or normal drawing bee used..
+					return TILE_DRAW_TRANS;
+				else
+					return TILE_DRAW_NORMAL;
+			}
+		break;
+	}
+
+	return TILE_DRAW_NONE;
+}
+
+
 //draws a tilelayer....
 //Don't forget that the FIRST layer is 1 NOT 0
 void draw_tile_layer(BITMAP *virt, int layer,int solid, int xpos, int ypos)
 {
 	int i,j;
     int x,y,x1,y1;
-	int tile_set[4];
-	int	tile_num[4];
+	int tile_set;
+	int	tile_num;
 	static int debug_counter = 0;
 	
 	if(debug_counter < 5) {
@@ -164,6 +393,13 @@ void draw_tile_layer(BITMAP *virt, int layer,int solid, int xpos, int ypos)
 		debug_counter++;
 	}
 
+	//use the prerendered chunks if they are there
+	if(tile_cache_is_on && tile_cache_draw_layer(virt, layer, solid, xpos, ypos))
+		return;
+
+	if(tile_plan_draw_layer(virt, layer, solid, xpos, ypos))
+		return;
+
      x1=0-(xpos%TILE_SIZE);//check where on the tile map you begin to draw
      y1=0-(ypos%TILE_SIZE);
 	 
@@ -173,95 +409,30 @@ void draw_tile_layer(BITMAP *virt, int layer,int solid, int xpos, int ypos)
 
 	 
 
-	 for(i=-1;i< (virt->w/TILE_SIZE+1) ;i++)
-      for(j=-1;j< (virt->h/TILE_SIZE+1) ;j++)
+	 //round up, the view is not always a whole number of tiles
+	 for(i=-1;i< ((virt->w+TILE_SIZE-1)/TILE_SIZE+1) ;i++)
+      for(j=-1;j< ((virt->h+TILE_SIZE-1)/TILE_SIZE+1) ;j++)
 	  {
 		  	  
 	      if((i+x < 0)|| (j+y < 0) || (j+y > map->h-1) || (i+x > map->w-1) ) //if the tile is out side the map it is just a black square
 		  {
 
 			if(layer==3)
-			 draw_rle_sprite(virt, tile_data[0][1].dat, x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
+			 dl_draw_tile(virt, 0, 1, x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
 			 		   
 		  }
 		  else //get the set and the number of the tiles
 		  {
-			tile_set[1] = (map->layer1+ (i+x) +( (j+y) * map->w))->tile_set;
-			tile_num[1] = (map->layer1+ (i+x) +( (j+y) * map->w))->tile_num;
-			// Skip bounds check - set defaults for invalid values
-			if(!(tile_set[1] >= 0 && tile_set[1] < num_of_tilesets && tile_num[1] >= 0 && tile_num[1] < 100)) {
-				tile_set[1] = 0;
-				tile_num[1] = 0;
-			} else {
-				tile_num[1] = tile_info[tile_set[1]].tile[tile_num[1]].current_tile;
-			}
-		  
-			tile_set[2] = (map->layer2+ (i+x) +( (j+y) * map->w))->tile_set;
-			tile_num[2] = (map->layer2+ (i+x) +( (j+y) * map->w))->tile_num;
-			if(!(tile_set[2] >= 0 && tile_set[2] < num_of_tilesets && tile_num[2] >= 0 && tile_num[2] < 100)) {
-				tile_set[2] = 0;
-				tile_num[2] = 0;
-			} else {
-				tile_num[2] = tile_info[tile_set[2]].tile[tile_num[2]].current_tile;
-			}
-		  
-		  	tile_set[3] = (map->layer3+ (i+x) +( (j+y) * map->w))->tile_set;
-			tile_num[3] = (map->layer3+ (i+x) +( (j+y) * map->w))->tile_num;
-			if(!(tile_set[3] >= 0 && tile_set[3] < num_of_tilesets && tile_num[3] >= 0 && tile_num[3] < 100)) {
-				tile_set[3] = 0;
-				tile_num[3] = 0;
-			} else {
-				tile_num[3] = tile_info[tile_set[3]].tile[tile_num[3]].current_tile;
-			}
-			
-
-			
-			set_trans_blender(0,0,0,128);
-			
-			//draw_rle_sprite(virt, tile_data[ tile_set[layer] ][ tile_num[layer] ].dat, x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
-					
-			switch(layer) //What layer should be drawn...
+			switch(get_tile_layer_cell(layer, solid, i+x, j+y, &tile_set, &tile_num))
 			{
-			case 1://Check if there any solid tiles above if not draw the tile
-				if(tile_info[tile_set[1]].tile[tile_num[1]].solid==solid)
-					if( tile_info[tile_set[2]].tile[tile_num[2]].masked || tile_info[tile_set[2]].tile[tile_num[2]].trans ||
-						tile_info[tile_set[3]].tile[tile_num[3]].masked || tile_info[tile_set[3]].tile[tile_num[3]].trans)
-						{
-							draw_rle_sprite(virt, tile_data[ tile_set[layer] ][ tile_num[layer] ].dat, x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
-						}
-				break;
-
-			
-			case 2://Check if there any solid tiles above if not draw the tile
-				if(tile_info[tile_set[2]].tile[tile_num[2]].solid==solid)
-					if( tile_info[tile_set[3]].tile[tile_num[3]].masked || tile_info[tile_set[3]].tile[tile_num[3]].trans)
-					{
-						if(tile_set[layer]!=0 || tile_num[layer]!=0)//if it is balnk don't draw it	
-							if(tile_info[tile_set[layer]].tile[tile_num[layer]].trans)//shall trans or normal drawing bee used..
-								draw_trans_rle_sprite(virt, tile_data[ tile_set[layer] ][ tile_num[layer] ].dat, x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
-							else
-								draw_rle_sprite(virt, tile_data[ tile_set[layer] ][ tile_num[layer] ].dat, x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
-					}
+			case TILE_DRAW_NORMAL:
+				dl_draw_tile(virt, tile_set, tile_num, x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
 				break;
 
-			
-			case 3:
-				if(tile_info[tile_set[3]].tile[tile_num[3]].solid==solid)  
-					if(tile_set[layer]!=0 || tile_num[layer]!=0)//if it is balnk don't draw it	
-						if(tile_info[tile_set[layer]].tile[tile_num[layer]].trans)//shall trans or normal drawing bee used..
-							draw_trans_rle_sprite(virt, tile_data[ tile_set[layer] ][ tile_num[layer] ].dat, x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
-						else
-							draw_rle_sprite(virt, tile_data[ tile_set[layer] ][ tile_num[layer] ].dat, x1+(i*TILE_SIZE), y1+(j*TILE_SIZE));
-								
+			case TILE_DRAW_TRANS:
+				dl_draw_blend_rle_sprite(virt, tile_data[ tile_set ][ tile_num ].dat, x1+(i*TILE_SIZE), y1+(j*TILE_SIZE), TILE_TRANS_ALPHA);
 				break;
-
-
-
 			}
-
-		 
-		       
-	 		 
 		  }
 	  }
 	  
@@ -24,12 +24,39 @@ typedef struct
 }TILESET_INFO;
 
 
+typedef struct
+{
+	int tile_set;
+	int tile_num;
+}TILE_ANIM;
+
+
+typedef struct
+{
+	int speed; //updates between the frames
+	int first; //the first of the tiles in the animated tile list
+	int num;
+	int rounds; //turns of the wheel left before it is due
+	int next; //the next group due at the same time, -1 if none
+}TILE_ANIM_GROUP;
+
+#define TILE_WHEEL_SIZE 64 //the updates the tile animation wheel looks ahead
+
+
+
+//what get_tile_layer_cell says about a cell
+#define TILE_DRAW_NONE 0
+#define TILE_DRAW_NORMAL 1
+#define TILE_DRAW_TRANS 2
+
+#define TILE_TRANS_ALPHA 128 //how much of a trans tile is seen
 
 //the functions
 //int load_tiles(void);
 int tile_is_solid(int x, int y);
 
 void update_tiles(void);
+int get_tile_layer_cell(int layer, int solid, int x, int y, int *set, int *num);
 
 #define MAX_TILES 100
 
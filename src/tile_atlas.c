@@ -0,0 +1,142 @@
+////////////////////////////////////////////////////
+// This file contains the tile atlas. When the tiles
+// are loaded every tile set is also drawn into one
+// bitmap, a tile after the other, and the tiles with
+// no masked pixels are marked. Those are drawn as
+// rows copied straight from the atlas, the others
+// are drawn as rle sprites like before.
+///////////////////////////////////////////////////
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <allegro.h>
+
+#include "fiend.h"
+#include "tile_atlas.h"
+#include "logger.h"
+
+
+int tile_atlas_is_on=1;
+
+static BITMAP *atlas[MAX_TILES];//TILE_SIZE wide, the tiles below each other
+static unsigned char *opaque[MAX_TILES];//for each tile in a set
+
+
+
+//draw the tile into its place in the atlas and see if it covers it all
+static int add_atlas_tile(BITMAP *dest, RLE_SPRITE *pic, int num)
+{
+	int x,y;
+	int mask_color = bitmap_mask_color(dest);
+
+	if(pic->w!=TILE_SIZE || pic->h!=TILE_SIZE || pic->color_depth!=bitmap_color_depth(dest))
+		return 0;
+
+	draw_rle_sprite(dest, pic, 0, num*TILE_SIZE);
+
+	for(y=num*TILE_SIZE;y<(num+1)*TILE_SIZE;y++)
+		for(x=0;x<TILE_SIZE;x++)
+			if(getpixel(dest, x, y)==mask_color)
+				return 0;
+
+	return 1;
+}
+
+
+//make the atlas of every loaded tile set. returns 0 if out of memory.
+int make_tile_atlas(void)
+{
+	int i,j;
+	int num_of_opaque=0;
+	int num_of_tiles=0;
+	RLE_ARRAY *temp;//the number of tiles is kept in the first
+
+	for(i=0;i<num_of_tilesets;i++)
+	{
+		temp = tile_data[i];
+
+		atlas[i] = create_bitmap_ex(temp[0].dat->color_depth, TILE_SIZE, temp[0].num*TILE_SIZE);
+		opaque[i] = calloc(1, temp[0].num);
+		if(atlas[i]==NULL || opaque[i]==NULL)
+		{
+			release_tile_atlas();
+			return 0;
+		}
+
+		clear_to_color(atlas[i], bitmap_mask_color(atlas[i]));
+
+		for(j=0;j<temp[0].num;j++)
+		{
+			opaque[i][j] = add_atlas_tile(atlas[i], temp[j].dat, j);
+			num_of_opaque += opaque[i][j];
+		}
+		num_of_tiles += temp[0].num;
+	}
+
+	log_info("Tile atlas: %d of %d tiles are opaque", num_of_opaque, num_of_tiles);
+
+	return 1;
+}
+
+
+void release_tile_atlas(void)
+{
+	int i;
+
+	for(i=0;i<MAX_TILES;i++)
+	{
+		if(atlas[i])
+			destroy_bitmap(atlas[i]);
+		free(opaque[i]);
+
+		atlas[i]=NULL;
+		opaque[i]=NULL;
+	}
+}
+
+
+
+int tile_is_opaque(int tile_set, int tile_num)
+{
+	if(tile_set<0 || tile_set>=num_of_tilesets || opaque[tile_set]==NULL)
+		return 0;
+	if(tile_num<0 || tile_num>=tile_data[tile_set][0].num)
+		return 0;
+
+	return opaque[tile_set][tile_num];
+}
+
+
+//draw a tile, opaque tiles are copied a row at a time from the atlas
+void draw_tile(BITMAP *dest, int tile_set, int tile_num, int x, int y)
+{
+	BITMAP *src;
+	int x1,y1,x2,y2;
+	int src_y;
+	int bpp;
+	int j;
+
+	if(!tile_atlas_is_on || !tile_is_opaque(tile_set, tile_num) || !is_memory_bitmap(dest) ||
+	   bitmap_color_depth(dest)!=bitmap_color_depth(atlas[tile_set]))
+	{
+		draw_rle_sprite(dest, tile_data[tile_set][tile_num].dat, x, y);
+		return;
+	}
+
+	src = atlas[tile_set];
+
+	x1 = MAX(x, dest->cl);
+	y1 = MAX(y, dest->ct);
+	x2 = MIN(x+TILE_SIZE, dest->cr);
+	y2 = MIN(y+TILE_SIZE, dest->cb);
+	if(x1>=x2 || y1>=y2)
+		return;
+
+	bpp = BYTES_PER_PIXEL(bitmap_color_depth(dest));
+	src_y = tile_num*TILE_SIZE - y;
+
+	for(j=y1;j<y2;j++)
+		memcpy(dest->line[j] + x1*bpp, src->line[src_y+j] + (x1-x)*bpp, (x2-x1)*bpp);
+}
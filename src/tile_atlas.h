@@ -0,0 +1,16 @@
+#include <allegro.h>
+
+
+#ifndef TILE_ATLAS_H
+#define TILE_ATLAS_H
+
+
+extern int tile_atlas_is_on;
+
+int make_tile_atlas(void);
+void release_tile_atlas(void);
+
+int tile_is_opaque(int tile_set, int tile_num);
+void draw_tile(BITMAP *dest, int tile_set, int tile_num, int x, int y);
+
+#endif
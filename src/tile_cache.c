@@ -0,0 +1,361 @@
+////////////////////////////////////////////////////
+// This file contains the tile layer cache. The map is
+// split into chunks of tiles and every layer pass of a
+// chunk is drawn once into a masked RLE sprite, so that
+// draw_tile_layer only has to blit a few chunks.
+// Chunks are rebuilt when an animated tile in them
+// changes frame.
+///////////////////////////////////////////////////
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <allegro.h>
+
+#include "fiend.h"
+#include "tile_cache.h"
+#include "tile_plan.h"
+#include "tile_atlas.h"
+#include "draw_list.h"
+#include "logger.h"
+
+
+#define CHUNK_PIXELS (TILE_SIZE*TILE_CACHE_CHUNK_SIZE)
+
+
+int tile_cache_is_on=1;
+int tile_cache_budget=16384;//max size of the prerendered chunks in kb
+
+static TILE_CACHE_CHUNK *chunk=NULL;
+static int chunks_w=0;
+static int chunks_h=0;
+
+//the size of the map the chunks was made for
+static int chunk_map_w=0;
+static int chunk_map_h=0;
+
+static BITMAP *chunk_buffer=NULL;
+
+static int total_size=0;
+static unsigned int use_count=0;
+
+
+//divide that rounds down for negative numbers too
+static int floor_div(int a, int b)
+{
+	if(a<0)
+		return -((-a+b-1)/b);
+	else
+		return a/b;
+}
+
+
+
+//free the pics of a chunk so it is rebuilt the next time it is drawn
+static void release_chunk(TILE_CACHE_CHUNK *temp)
+{
+	int i;
+
+	for(i=0;i<TILE_CACHE_PASS_NUM;i++)
+	{
+		if(temp->pic[i])
+			dl_destroy_rle_sprite(temp->pic[i]);
+		if(temp->trans[i])
+			free(temp->trans[i]);
+
+		temp->pic[i] = NULL;
+		temp->trans[i] = NULL;
+		temp->num_of_trans[i] = 0;
+		temp->built[i] = 0;
+	}
+
+	total_size -= temp->size;
+	temp->size = 0;
+}
+
+
+//throw away the least recently used chunk (not the one given)
+static int release_oldest_chunk(TILE_CACHE_CHUNK *keep)
+{
+	int i;
+	TILE_CACHE_CHUNK *oldest=NULL;
+
+	for(i=0;i<chunks_w*chunks_h;i++)
+		if(&chunk[i]!=keep && chunk[i].size>0)
+			if(oldest==NULL || chunk[i].last_used < oldest->last_used)
+				oldest = &chunk[i];
+
+	if(oldest==NULL)
+		return 0;
+
+	release_chunk(oldest);
+
+	return 1;
+}
+
+
+//make a list of the animated tiles in a chunk, if one of them changes
+//the chunk must be rebuilt.
+static void find_chunk_anims(TILE_CACHE_CHUNK *temp)
+{
+	int i,j,k,l;
+	int key;
+	TILE_DATA *layer_data[3];
+	TILE_DATA *cell;
+
+	layer_data[0] = map->layer1;
+	layer_data[1] = map->layer2;
+	layer_data[2] = map->layer3;
+
+	if(temp->anim)
+		free(temp->anim);
+	temp->anim = NULL;
+	temp->num_of_anims=0;
+
+	for(i=temp->x;i<temp->x+temp->w;i++)
+		for(j=temp->y;j<temp->y+temp->h;j++)
+			for(k=0;k<3;k++)
+			{
+				cell = layer_data[k] + i + j*map->w;
+
+				if(cell->tile_set < 0 || cell->tile_set >= num_of_tilesets || cell->tile_num < 0 || cell->tile_num >= MAX_TILES)
+					continue;
+				if(tile_info[cell->tile_set].tile[cell->tile_num].next_tile < 0)
+					continue;
+
+				key = cell->tile_set*MAX_TILES + cell->tile_num;
+
+				for(l=0;l<temp->num_of_anims;l++)
+					if(temp->anim[l]==key)break;
+
+				if(l==temp->num_of_anims)
+				{
+					temp->anim = realloc(temp->anim, sizeof(int)*(temp->num_of_anims+1));
+					temp->anim[temp->num_of_anims] = key;
+					temp->num_of_anims++;
+				}
+			}
+}
+
+
+//draw one layer pass of a chunk into a sprite
+static void build_chunk_pass(TILE_CACHE_CHUNK *temp, int pass)
+{
+	int i,j;
+	int layer = pass/3+1;
+	int solid = pass%3;
+	int tile_set, tile_num;
+	int num_of_normal=0;
+	int size=0;
+	BITMAP *buffer;
+	TILE_CACHE_CELL trans[TILE_CACHE_CHUNK_SIZE*TILE_CACHE_CHUNK_SIZE];
+
+	buffer = create_sub_bitmap(chunk_buffer, 0, 0, temp->w*TILE_SIZE, temp->h*TILE_SIZE);
+	clear_to_color(buffer, bitmap_mask_color(buffer));
+
+	temp->num_of_trans[pass]=0;
+
+	for(i=0;i<temp->w;i++)
+		for(j=0;j<temp->h;j++)
+		{
+			switch(tile_plan_get_cell(layer, solid, temp->x+i, temp->y+j, &tile_set, &tile_num))
+			{
+			case TILE_DRAW_NORMAL:
+				draw_tile(buffer, tile_set, tile_num, i*TILE_SIZE, j*TILE_SIZE);
+				num_of_normal++;
+				break;
+
+			case TILE_DRAW_TRANS://these must be blended with what is under them
+				trans[temp->num_of_trans[pass]].x = temp->x+i;
+				trans[temp->num_of_trans[pass]].y = temp->y+j;
+				trans[temp->num_of_trans[pass]].set = tile_set;
+				trans[temp->num_of_trans[pass]].num = tile_num;
+				temp->num_of_trans[pass]++;
+				break;
+			}
+		}
+
+	if(num_of_normal>0)
+	{
+		temp->pic[pass] = dl_get_rle_sprite(buffer);
+		size += temp->pic[pass]->size + sizeof(RLE_SPRITE);
+	}
+
+	if(temp->num_of_trans[pass]>0)
+	{
+		temp->trans[pass] = malloc(sizeof(TILE_CACHE_CELL)*temp->num_of_trans[pass]);
+		memcpy(temp->trans[pass], trans, sizeof(TILE_CACHE_CELL)*temp->num_of_trans[pass]);
+		size += sizeof(TILE_CACHE_CELL)*temp->num_of_trans[pass];
+	}
+
+	temp->size += size;
+	total_size += size;
+	temp->built[pass]=1;
+
+	destroy_bitmap(buffer);
+}
+
+
+
+//free all chunks
+void tile_cache_release(void)
+{
+	int i;
+
+	if(chunk)
+	{
+		for(i=0;i<chunks_w*chunks_h;i++)
+		{
+			release_chunk(&chunk[i]);
+			if(chunk[i].anim)
+				free(chunk[i].anim);
+		}
+		free(chunk);
+	}
+
+	if(chunk_buffer)
+		destroy_bitmap(chunk_buffer);
+
+	chunk=NULL;
+	chunk_buffer=NULL;
+	chunks_w=0;
+	chunks_h=0;
+	total_size=0;
+}
+
+
+//split the current map into chunks and prerender as many as the
+//budget allows. called when a map is loaded.
+void tile_cache_init_map(void)
+{
+	int i,j;
+	int pass;
+	TILE_CACHE_CHUNK *temp;
+
+	tile_cache_release();
+
+	chunk_map_w = map->w;
+	chunk_map_h = map->h;
+
+	chunks_w = (map->w+TILE_CACHE_CHUNK_SIZE-1)/TILE_CACHE_CHUNK_SIZE;
+	chunks_h = (map->h+TILE_CACHE_CHUNK_SIZE-1)/TILE_CACHE_CHUNK_SIZE;
+
+	chunk = calloc(sizeof(TILE_CACHE_CHUNK), chunks_w*chunks_h);
+	chunk_buffer = create_bitmap(CHUNK_PIXELS, CHUNK_PIXELS);
+
+	if(chunk==NULL || chunk_buffer==NULL)
+	{
+		log_warning("tile cache: out of memory, drawing tiles one by one");
+		tile_cache_release();
+		return;
+	}
+
+	for(i=0;i<chunks_w;i++)
+		for(j=0;j<chunks_h;j++)
+		{
+			temp = &chunk[i + j*chunks_w];
+
+			temp->x = i*TILE_CACHE_CHUNK_SIZE;
+			temp->y = j*TILE_CACHE_CHUNK_SIZE;
+			temp->w = MIN(TILE_CACHE_CHUNK_SIZE, map->w - temp->x);
+			temp->h = MIN(TILE_CACHE_CHUNK_SIZE, map->h - temp->y);
+
+			find_chunk_anims(temp);
+		}
+
+	//prerender until the budget is used up, the rest is made when needed
+	for(i=0;i<chunks_w*chunks_h && total_size < tile_cache_budget*1024;i++)
+		for(pass=0;pass<TILE_CACHE_PASS_NUM;pass++)
+			build_chunk_pass(&chunk[i], pass);
+
+	log_debug("tile cache: %dx%d chunks, %d kb prerendered", chunks_w, chunks_h, total_size/1024);
+}
+
+
+
+//draw a tile layer using the chunks. returns 0 if there are no chunks
+//for the map, then the tiles must be drawn the normal way.
+int tile_cache_draw_layer(BITMAP *dest, int layer, int solid, int xpos, int ypos)
+{
+	int i,j,k;
+	int x,y,w,h;
+	int x1,y1,x2,y2;
+	int pass;
+	TILE_CACHE_CHUNK *temp;
+	TILE_CACHE_CELL *cell;
+
+	if(chunk==NULL || map->w!=chunk_map_w || map->h!=chunk_map_h)
+		return 0;
+	if(layer<1 || layer>3 || solid<0 || solid>2)
+		return 0;
+
+	pass = (layer-1)*3 + solid;
+	use_count++;
+
+	x1 = MAX(floor_div(xpos, CHUNK_PIXELS), 0);
+	y1 = MAX(floor_div(ypos, CHUNK_PIXELS), 0);
+	x2 = MIN(floor_div(xpos+dest->w-1, CHUNK_PIXELS), chunks_w-1);
+	y2 = MIN(floor_div(ypos+dest->h-1, CHUNK_PIXELS), chunks_h-1);
+
+	for(i=x1;i<=x2;i++)
+		for(j=y1;j<=y2;j++)
+		{
+			temp = &chunk[i + j*chunks_w];
+
+			if(!temp->built[pass])
+			{
+				while(total_size > tile_cache_budget*1024)
+					if(!release_oldest_chunk(temp))break;
+
+				build_chunk_pass(temp, pass);
+			}
+			temp->last_used = use_count;
+
+			if(temp->pic[pass])
+				dl_draw_rle_sprite(dest, temp->pic[pass], temp->x*TILE_SIZE - xpos, temp->y*TILE_SIZE - ypos);
+
+			for(k=0;k<temp->num_of_trans[pass];k++)
+			{
+				cell = &temp->trans[pass][k];
+				dl_draw_blend_rle_sprite(dest, tile_data[cell->set][cell->num].dat, cell->x*TILE_SIZE - xpos, cell->y*TILE_SIZE - ypos, TILE_TRANS_ALPHA);
+			}
+		}
+
+	//if the tile is out side the map it is just a black square
+	if(layer==3)
+	{
+		x=(xpos-(xpos%TILE_SIZE))/TILE_SIZE;
+		y=(ypos-(ypos%TILE_SIZE))/TILE_SIZE;
+		w=(dest->w+TILE_SIZE-1)/TILE_SIZE;//the view in tiles, rounded up
+		h=(dest->h+TILE_SIZE-1)/TILE_SIZE;
+
+		if(x-1 < 0 || y-1 < 0 || x+w > map->w-1 || y+h > map->h-1)
+			for(i=x-1;i< x+w+1 ;i++)
+				for(j=y-1;j< y+h+1 ;j++)
+					if(i < 0 || j < 0 || j > map->h-1 || i > map->w-1)
+						dl_draw_tile(dest, 0, 1, i*TILE_SIZE - xpos, j*TILE_SIZE - ypos);
+	}
+
+	return 1;
+}
+
+
+
+//an animated tile has changed frame, rebuild the chunks that show it
+void tile_cache_tile_changed(int tile_set, int tile_num)
+{
+	int i,j;
+	int key = tile_set*MAX_TILES + tile_num;
+
+	if(chunk==NULL)
+		return;
+
+	for(i=0;i<chunks_w*chunks_h;i++)
+		for(j=0;j<chunk[i].num_of_anims;j++)
+			if(chunk[i].anim[j]==key)
+			{
+				release_chunk(&chunk[i]);
+				break;
+			}
+}
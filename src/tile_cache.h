@@ -0,0 +1,54 @@
+#include <allegro.h>
+
+
+#ifndef TILE_CACHE_H
+#define TILE_CACHE_H
+
+#define TILE_CACHE_CHUNK_SIZE 8 //chunk width and height in tiles
+
+//layer 1-3 times solid 0-2
+#define TILE_CACHE_PASS_NUM 9
+
+
+typedef struct
+{
+	short x;//map cell
+	short y;
+	short set;//what to draw
+	short num;
+}TILE_CACHE_CELL;
+
+
+typedef struct
+{
+	int x;//first map cell and size in cells
+	int y;
+	int w;
+	int h;
+
+	int built[TILE_CACHE_PASS_NUM];
+
+	RLE_SPRITE *pic[TILE_CACHE_PASS_NUM];//all normal tiles, NULL if none
+
+	int num_of_trans[TILE_CACHE_PASS_NUM];//trans tiles are drawn one by one
+	TILE_CACHE_CELL *trans[TILE_CACHE_PASS_NUM];
+
+	int num_of_anims;//animated tiles in the chunk (set*MAX_TILES+num)
+	int *anim;
+
+	int size;//bytes used by the pics
+	unsigned int last_used;
+}TILE_CACHE_CHUNK;
+
+
+extern int tile_cache_is_on;
+extern int tile_cache_budget;
+
+void tile_cache_init_map(void);
+void tile_cache_release(void);
+
+int tile_cache_draw_layer(BITMAP *dest, int layer, int solid, int xpos, int ypos);
+
+void tile_cache_tile_changed(int tile_set, int tile_num);
+
+#endif
@@ -0,0 +1,313 @@
+////////////////////////////////////////////////////
+// This file contains the tile draw plan. What
+// get_tile_layer_cell says about every cell of the
+// map is worked out when the map is loaded and kept
+// in one array per layer, so that drawing a layer is
+// a run through the arrays. The cells that show an
+// animated tile are worked out again when it changes
+// frame.
+///////////////////////////////////////////////////
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <allegro.h>
+
+#include "fiend.h"
+#include "tile_plan.h"
+#include "draw_list.h"
+#include "logger.h"
+
+
+#define PLAN_LAYERS 3
+
+
+int tile_plan_is_on=1;
+
+//for each layer and cell
+static unsigned char *plan_mode[PLAN_LAYERS];//TILE_DRAW_NONE, _NORMAL or _TRANS
+static unsigned char *plan_pass[PLAN_LAYERS];//the solid pass it is drawn in
+static short *plan_tile[PLAN_LAYERS];//set*MAX_TILES+num of the frame shown
+static RLE_SPRITE **plan_pic[PLAN_LAYERS];
+
+//the size of the map the plan was made for
+static int plan_w=0;
+static int plan_h=0;
+
+//the cells showing each animated tile, the ones of tile key are
+//from anim_first[key] to anim_first[key+1]
+static int *anim_first=NULL;
+static int *anim_cell=NULL;
+
+
+//divide that rounds down for negative numbers too
+static int floor_div(int a, int b)
+{
+	if(a<0)
+		return -((-a+b-1)/b);
+	else
+		return a/b;
+}
+
+
+static int plan_is_valid(void)
+{
+	return plan_mode[0]!=NULL && map->w==plan_w && map->h==plan_h;
+}
+
+
+//the animated tile a cell of a layer is set to, -1 if none
+static int get_anim_key(TILE_DATA *layer_data, int n)
+{
+	TILE_DATA *cell = layer_data + n;
+
+	if(cell->tile_set < 0 || cell->tile_set >= num_of_tilesets || cell->tile_num < 0 || cell->tile_num >= MAX_TILES)
+		return -1;
+	if(tile_info[cell->tile_set].tile[cell->tile_num].next_tile < 0)
+		return -1;
+
+	return cell->tile_set*MAX_TILES + cell->tile_num;
+}
+
+
+
+//work out how the layers of a cell are drawn
+static void plan_cell(int x, int y)
+{
+	int layer;
+	int n = x + y*plan_w;
+	int tile_set, tile_num;
+	int solid, mode;
+
+	for(layer=1;layer<=PLAN_LAYERS;layer++)
+	{
+		//a cell is only drawn in the pass of the solid it is
+		get_tile_layer_cell(layer, 0, x, y, &tile_set, &tile_num);
+		solid = tile_info[tile_set].tile[tile_num].solid;
+		mode = get_tile_layer_cell(layer, solid, x, y, &tile_set, &tile_num);
+
+		plan_mode[layer-1][n] = mode;
+		plan_pass[layer-1][n] = (mode==TILE_DRAW_NONE || solid<0 || solid>=TILE_PLAN_NO_PASS) ? TILE_PLAN_NO_PASS : solid;
+		plan_tile[layer-1][n] = tile_set*MAX_TILES + tile_num;
+		plan_pic[layer-1][n] = tile_data[tile_set][tile_num].dat;
+	}
+}
+
+
+//make the lists of the cells that show the animated tiles
+static int make_anim_cells(void)
+{
+	int i,k;
+	int key;
+	int num=0;
+	int *pos;
+	TILE_DATA *layer_data[PLAN_LAYERS];
+
+	layer_data[0] = map->layer1;
+	layer_data[1] = map->layer2;
+	layer_data[2] = map->layer3;
+
+	anim_first = calloc(sizeof(int), MAX_TILES*MAX_TILES+1);
+	pos = calloc(sizeof(int), MAX_TILES*MAX_TILES);
+	if(anim_first==NULL || pos==NULL)
+	{
+		free(pos);
+		return 0;
+	}
+
+	for(i=0;i<plan_w*plan_h;i++)
+		for(k=0;k<PLAN_LAYERS;k++)
+			if((key = get_anim_key(layer_data[k], i))>=0)
+			{
+				anim_first[key+1]++;
+				num++;
+			}
+
+	for(i=0;i<MAX_TILES*MAX_TILES;i++)
+	{
+		anim_first[i+1] += anim_first[i];
+		pos[i] = anim_first[i];
+	}
+
+	anim_cell = malloc(sizeof(int)*MAX(num,1));
+	if(anim_cell==NULL)
+	{
+		free(pos);
+		return 0;
+	}
+
+	for(i=0;i<plan_w*plan_h;i++)
+		for(k=0;k<PLAN_LAYERS;k++)
+			if((key = get_anim_key(layer_data[k], i))>=0)
+				anim_cell[pos[key]++] = i;
+
+	free(pos);
+
+	return 1;
+}
+
+
+
+void tile_plan_release(void)
+{
+	int i;
+
+	for(i=0;i<PLAN_LAYERS;i++)
+	{
+		free(plan_mode[i]);
+		free(plan_pass[i]);
+		free(plan_tile[i]);
+		free(plan_pic[i]);
+
+		plan_mode[i]=NULL;
+		plan_pass[i]=NULL;
+		plan_tile[i]=NULL;
+		plan_pic[i]=NULL;
+	}
+
+	free(anim_first);
+	free(anim_cell);
+	anim_first=NULL;
+	anim_cell=NULL;
+
+	plan_w=0;
+	plan_h=0;
+}
+
+
+//work out the plan of the current map. called when a map is loaded.
+void tile_plan_init_map(void)
+{
+	int i,j;
+	int size;
+	int failed=0;
+
+	tile_plan_release();
+
+	plan_w = map->w;
+	plan_h = map->h;
+	size = plan_w*plan_h;
+
+	for(i=0;i<PLAN_LAYERS;i++)
+	{
+		plan_mode[i] = malloc(size);
+		plan_pass[i] = malloc(size);
+		plan_tile[i] = malloc(sizeof(short)*size);
+		plan_pic[i] = malloc(sizeof(RLE_SPRITE*)*size);
+
+		if(plan_mode[i]==NULL || plan_pass[i]==NULL || plan_tile[i]==NULL || plan_pic[i]==NULL)
+			failed=1;
+	}
+
+	if(failed || !make_anim_cells())
+	{
+		log_warning("tile plan: out of memory, drawing tiles the slow way");
+		tile_plan_release();
+		return;
+	}
+
+	for(i=0;i<plan_w;i++)
+		for(j=0;j<plan_h;j++)
+			plan_cell(i,j);
+
+	log_debug("tile plan: %dx%d cells, %d animated", plan_w, plan_h, anim_first[MAX_TILES*MAX_TILES]);
+}
+
+
+
+//the same as get_tile_layer_cell, but from the plan when there is one
+int tile_plan_get_cell(int layer, int solid, int x, int y, int *set, int *num)
+{
+	int n;
+
+	if(!plan_is_valid() || layer<1 || layer>PLAN_LAYERS)
+		return get_tile_layer_cell(layer, solid, x, y, set, num);
+
+	n = x + y*plan_w;
+
+	*set = plan_tile[layer-1][n] / MAX_TILES;
+	*num = plan_tile[layer-1][n] % MAX_TILES;
+
+	if(plan_pass[layer-1][n]!=solid)
+		return TILE_DRAW_NONE;
+
+	return plan_mode[layer-1][n];
+}
+
+
+//draw a tile layer from the plan. returns 0 if there is no plan for the
+//map, then the tiles must be drawn the normal way.
+int tile_plan_draw_layer(BITMAP *dest, int layer, int solid, int xpos, int ypos)
+{
+	int i,j,n;
+	int x,y,w,h;
+	int x1,y1,x2,y2;
+	unsigned char *mode;
+	unsigned char *pass;
+	short *tile;
+	RLE_SPRITE **pic;
+
+	if(!tile_plan_is_on || !plan_is_valid())
+		return 0;
+	if(layer<1 || layer>PLAN_LAYERS)
+		return 0;
+
+	mode = plan_mode[layer-1];
+	pass = plan_pass[layer-1];
+	tile = plan_tile[layer-1];
+	pic = plan_pic[layer-1];
+
+	x1 = MAX(floor_div(xpos, TILE_SIZE), 0);
+	y1 = MAX(floor_div(ypos, TILE_SIZE), 0);
+	x2 = MIN(floor_div(xpos+dest->w-1, TILE_SIZE), plan_w-1);
+	y2 = MIN(floor_div(ypos+dest->h-1, TILE_SIZE), plan_h-1);
+
+	for(j=y1;j<=y2;j++)
+	{
+		n = x1 + j*plan_w;
+
+		for(i=x1;i<=x2;i++,n++)
+		{
+			if(pass[n]!=solid)
+				continue;
+
+			if(mode[n]==TILE_DRAW_TRANS)
+				dl_draw_blend_rle_sprite(dest, pic[n], i*TILE_SIZE - xpos, j*TILE_SIZE - ypos, TILE_TRANS_ALPHA);
+			else
+				dl_draw_tile(dest, tile[n] / MAX_TILES, tile[n] % MAX_TILES, i*TILE_SIZE - xpos, j*TILE_SIZE - ypos);
+		}
+	}
+
+	//if the tile is out side the map it is just a black square
+	if(layer==3)
+	{
+		x=(xpos-(xpos%TILE_SIZE))/TILE_SIZE;
+		y=(ypos-(ypos%TILE_SIZE))/TILE_SIZE;
+		w=(dest->w+TILE_SIZE-1)/TILE_SIZE;//the view in tiles, rounded up
+		h=(dest->h+TILE_SIZE-1)/TILE_SIZE;
+
+		if(x-1 < 0 || y-1 < 0 || x+w > map->w-1 || y+h > map->h-1)
+			for(i=x-1;i< x+w+1 ;i++)
+				for(j=y-1;j< y+h+1 ;j++)
+					if(i < 0 || j < 0 || j > map->h-1 || i > map->w-1)
+						dl_draw_tile(dest, 0, 1, i*TILE_SIZE - xpos, j*TILE_SIZE - ypos);
+	}
+
+	return 1;
+}
+
+
+
+//an animated tile has changed frame, work out the cells that show it again
+void tile_plan_tile_changed(int tile_set, int tile_num)
+{
+	int i;
+	int key = tile_set*MAX_TILES + tile_num;
+
+	if(anim_first==NULL || !plan_is_valid())
+		return;
+
+	for(i=anim_first[key];i<anim_first[key+1];i++)
+		plan_cell(anim_cell[i]%plan_w, anim_cell[i]/plan_w);
+}
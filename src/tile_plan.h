@@ -0,0 +1,20 @@
+#include <allegro.h>
+
+
+#ifndef TILE_PLAN_H
+#define TILE_PLAN_H
+
+#define TILE_PLAN_NO_PASS 255 //the cell is not drawn in any pass of a layer
+
+
+extern int tile_plan_is_on;
+
+void tile_plan_init_map(void);
+void tile_plan_release(void);
+
+int tile_plan_get_cell(int layer, int solid, int x, int y, int *set, int *num);
+int tile_plan_draw_layer(BITMAP *dest, int layer, int solid, int xpos, int ypos);
+
+void tile_plan_tile_changed(int tile_set, int tile_num);
+
+#endif